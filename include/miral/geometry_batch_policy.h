@@ -0,0 +1,79 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_GEOMETRY_BATCH_POLICY_H
+#define MIRAL_GEOMETRY_BATCH_POLICY_H
+
+#include "miral/version.h"
+#include "miral/window.h"
+
+#include <mir/geometry/point.h>
+#include <mir/geometry/size.h>
+#include <mir/optional_value.h>
+
+#include <vector>
+
+namespace miral
+{
+/// A change to the geometry of a window
+struct GeometryChange
+{
+    Window window;
+    mir::optional_value<mir::geometry::Point> top_left; ///< set if the window is moving
+    mir::optional_value<mir::geometry::Size> size;      ///< set if the window is resizing
+};
+
+/**
+ *  Advise changes to window geometry in bulk.
+ *
+ *  \note This interface is intended to be implemented by a WindowManagementPolicy
+ *  implementation, we can't add these functions directly to that interface without
+ *  breaking ABI (the vtab could be incompatible).
+ *  When initializing the window manager this interface will be detected by
+ *  dynamic_cast and registered accordingly.
+ */
+class GeometryBatchPolicy
+{
+public:
+/** @name notification of WM events that the policy may need to track.
+ * These calls happen "under lock" and are wrapped by the usual
+ * WindowManagementPolicy::advise_begin(), advise_end() calls.
+ * They should not call WindowManagerTools::invoke_under_lock()
+ *  @{ */
+
+    /** Notification that windows are being moved and/or resized.
+     *  This replaces WindowManagementPolicy::advise_move_to() and advise_resize(): the
+     *  changes made while the model is locked are advised together, once per window,
+     *  before they reach the windows (which still report their old geometry).
+     *
+     * @param changes   the changes
+     */
+    virtual void advise_geometry_batch(std::vector<GeometryChange> const& changes);
+
+/** @} */
+
+    virtual ~GeometryBatchPolicy() = default;
+    GeometryBatchPolicy() = default;
+    GeometryBatchPolicy(GeometryBatchPolicy const&) = delete;
+    GeometryBatchPolicy& operator=(GeometryBatchPolicy const&) = delete;
+};
+#if MIRAL_VERSION >= MIR_VERSION_NUMBER(2, 0, 0)
+#error "We've presumably broken ABI - please roll this interface into WindowManagementPolicy"
+#endif
+}
+#endif //MIRAL_GEOMETRY_BATCH_POLICY_H
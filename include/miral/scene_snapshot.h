@@ -0,0 +1,128 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_SCENE_SNAPSHOT_H
+#define MIRAL_SCENE_SNAPSHOT_H
+
+#include "miral/window.h"
+
+#include <mir_toolkit/common.h>
+#include <mir/geometry/point.h>
+#include <mir/geometry/size.h>
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace miral
+{
+/// An immutable record of a window's state at the time a SceneSnapshot was published.
+struct WindowSnapshot
+{
+    Window window;
+    Window parent;
+    std::string name;
+    MirWindowType type;
+    MirWindowState state;
+    mir::geometry::Point top_left;
+    mir::geometry::Size size;
+
+    /// The version of the SceneSnapshot in which this record last changed
+    uint64_t version;
+};
+
+/// The window records of a SceneSnapshot.
+/// The records are held in fixed size chunks that successive snapshots share: publishing a
+/// snapshot copies only the chunks holding records that changed.
+class WindowSnapshots
+{
+public:
+    using value_type = std::shared_ptr<WindowSnapshot const>;
+
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = WindowSnapshots::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = value_type const*;
+        using reference = value_type const&;
+
+        const_iterator(WindowSnapshots const* owner, std::size_t position) : owner{owner}, position{position} {}
+
+        auto operator*() const -> reference { return (*owner)[position]; }
+        auto operator->() const -> pointer { return &(*owner)[position]; }
+        auto operator++() -> const_iterator& { ++position; return *this; }
+        auto operator++(int) -> const_iterator { auto const result = *this; ++position; return result; }
+
+        bool operator==(const_iterator const& rhs) const { return position == rhs.position; }
+        bool operator!=(const_iterator const& rhs) const { return position != rhs.position; }
+
+    private:
+        WindowSnapshots const* owner;
+        std::size_t position;
+    };
+
+    auto size() const -> std::size_t { return count; }
+    auto empty() const -> bool { return count == 0; }
+
+    auto operator[](std::size_t position) const -> value_type const&
+        { return (*chunks[position/chunk_size])[position%chunk_size]; }
+
+    auto begin() const -> const_iterator { return {this, 0}; }
+    auto end() const -> const_iterator { return {this, count}; }
+
+private:
+    friend class SceneSnapshotPublisher;
+
+    static std::size_t const chunk_size = 64;
+    using Chunk = std::vector<value_type>;
+
+    std::vector<std::shared_ptr<Chunk>> chunks;
+    std::size_t count{0};
+};
+
+/// An immutable record of an application at the time a SceneSnapshot was published.
+struct ApplicationSnapshot
+{
+    std::weak_ptr<mir::scene::Session> application;
+    pid_t pid;
+    std::string name;
+};
+
+/// An immutable, versioned copy of the window management model.
+/// Snapshots are published by the window manager at the end of each transaction that changes
+/// the model and may be read from any thread without locking (see WindowManagerTools::scene_snapshot()).
+/// Records for windows that did not change are shared with the previous snapshot (see WindowSnapshots).
+/// \note geometry changes made directly through Window::move_to() or Window::resize() (rather than
+/// via WindowManagerTools) are reflected the next time the window manager updates the window.
+struct SceneSnapshot
+{
+    uint64_t version;
+    Window active_window;
+    WindowSnapshots windows;
+    std::shared_ptr<std::vector<ApplicationSnapshot> const> applications;
+};
+}
+
+#endif //MIRAL_SCENE_SNAPSHOT_H
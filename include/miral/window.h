@@ -60,10 +60,14 @@ private:
     struct Self;
     std::shared_ptr <Self> self;
 
+    // For the miral internals (see window_self.h)
+    friend auto window_self(Window const& window) -> std::shared_ptr<Self> const&;
+
     friend bool operator==(Window const& lhs, Window const& rhs);
     friend bool operator==(std::shared_ptr<mir::scene::Surface> const& lhs, Window const& rhs);
     friend bool operator==(Window const& lhs, std::shared_ptr<mir::scene::Surface> const& rhs);
     friend bool operator<(Window const& lhs, Window const& rhs);
+    friend struct std::hash<Window>;
 };
 
 bool operator==(Window const& lhs, Window const& rhs);
@@ -79,4 +83,16 @@ inline bool operator<=(Window const& lhs, Window const& rhs) { return !(lhs > rh
 inline bool operator>=(Window const& lhs, Window const& rhs) { return !(lhs < rhs); }
 }
 
+namespace std
+{
+template<>
+struct hash<miral::Window>
+{
+    auto operator()(miral::Window const& window) const -> size_t
+    {
+        return hash<shared_ptr<miral::Window::Self>>{}(window.self);
+    }
+};
+}
+
 #endif //MIRAL_WINDOW_H
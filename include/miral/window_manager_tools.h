@@ -23,9 +23,12 @@
 #include "window_info.h"
 
 #include <mir/geometry/displacement.h>
+#include <mir/geometry/rectangle.h>
 
+#include <chrono>
 #include <functional>
 #include <memory>
+#include <vector>
 
 namespace mir
 {
@@ -38,6 +41,7 @@ class Window;
 struct WindowInfo;
 struct ApplicationInfo;
 class WindowSpecification;
+struct SceneSnapshot;
 
 /**
  * Workspace is intentionally opaque in the miral API. Its only purpose is to
@@ -132,6 +136,19 @@ public:
     /// \note ask_client_to_close() is the polite way
     void force_close(Window const& window);
 
+    /** Ask the client to close the window, and close it by force if it hasn't
+     *  done so within timeout.
+     *
+     * @param window    the window
+     * @param timeout   (optional) how long the client has to close the window
+     * @param on_closed (optional) called when the window has gone, with forced == true
+     *                  if it had to be closed by force
+     */
+    void close_window(
+        Window const& window,
+        std::chrono::milliseconds timeout = std::chrono::seconds{5},
+        std::function<void(bool forced)> const& on_closed = {});
+
     /// retrieve the active window
     auto active_window() const -> Window;
 
@@ -160,6 +177,22 @@ public:
     /// Find the topmost window at the cursor
     auto window_at(mir::geometry::Point cursor) const -> Window;
 
+    /** Find the windows whose extent contains a point.
+     *  The windows are in no particular order and may include windows that are not visible.
+     *  \note answered from an index of the window extents. Changes made through these
+     *  tools are indexed as they are made; windows moved or resized directly through
+     *  Window are indexed before the next query under the window management lock and
+     *  when a transaction commits (so a query under a shared lock sees them once a
+     *  transaction has committed since they were made).
+     */
+    auto windows_at(mir::geometry::Point point) const -> std::vector<Window>;
+
+    /** Find the windows whose extent overlaps an area.
+     *  The windows are in no particular order and may include windows that are not visible.
+     *  \note answered from the same index as windows_at()
+     */
+    auto windows_in(mir::geometry::Rectangle const& area) const -> std::vector<Window>;
+
     /// Find the active display area
     auto active_display() -> mir::geometry::Rectangle const;
 
@@ -234,6 +267,24 @@ public:
      */
     void invoke_under_lock(std::function<void()> const& callback);
 
+    /** Multi-thread support for readers
+     *  Allows threads that don't hold a lock on the model to acquire a shared lock and call the
+     *  const "Query Model" member functions (e.g. active_window(), count_applications(), window_at(),
+     *  for_each_window_in_workspace()). Readers do not wait for one another, and the
+     *  WindowManagementPolicy is not notified (there is no advise_begin()/advise_end()).
+     *  The callback MUST NOT update the model.
+     *  This should NOT be used by a thread that has called the WindowManagementPolicy methods (and
+     *  already holds the lock).
+     */
+    void invoke_under_shared_lock(std::function<void()> const& callback);
+
+    /** Multi-thread support for observers
+     *  The most recently published snapshot of windows, applications and focus. A new snapshot
+     *  is published each time the model changes; this may be called from any thread without
+     *  acquiring a lock.
+     */
+    auto scene_snapshot() const -> std::shared_ptr<SceneSnapshot const>;
+
 private:
     WindowManagerToolsImplementation* tools;
 };
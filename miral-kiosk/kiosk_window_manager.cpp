@@ -71,7 +71,7 @@ bool KioskWindowManagerPolicy::handle_keyboard_event(MirKeyboardEvent const* eve
         switch (modifiers & modifier_mask)
         {
         case mir_input_event_modifier_alt:
-            tools.ask_client_to_close(tools.active_window());;
+            tools.close_window(tools.active_window());
             return true;
 
         default:
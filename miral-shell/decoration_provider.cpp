@@ -17,21 +17,21 @@
  */
 
 #include "decoration_provider.h"
-#include "titlebar_config.h"
+#include "pixel_kernels.h"
+#include "printer.h"
 
 #include <mir/client/display_config.h>
 #include <mir/client/window_spec.h>
 
 #include <mir_toolkit/mir_buffer_stream.h>
 
-#include <ft2build.h>
-#include FT_FREETYPE_H
-
-#include <locale>
-#include <codecvt>
+#include <memory>
+#include <chrono>
 #include <string>
+#include <cstdint>
 #include <cstring>
 #include <sstream>
+#include <vector>
 
 #include <iostream>
 
@@ -39,227 +39,9 @@ namespace
 {
 int const title_bar_height = 12;
 char const* const wallpaper_name = "wallpaper";
+auto const swap_timeout = std::chrono::milliseconds{100};
 
 void null_window_callback(MirWindow*, void*) {}
-
-struct preferred_codecvt : std::codecvt_byname<wchar_t, char, std::mbstate_t>
-{
-    preferred_codecvt() : std::codecvt_byname<wchar_t, char, std::mbstate_t>("") {}
-    ~preferred_codecvt() = default;
-};
-
-struct Printer
-{
-    Printer();
-    ~Printer();
-    Printer(Printer const&) = delete;
-    Printer& operator=(Printer const&) = delete;
-
-    void print(MirGraphicsRegion const& region, std::string const& title, int const intensity);
-    void printhelp(MirGraphicsRegion const& region);
-
-private:
-    std::wstring_convert<preferred_codecvt> converter;
-
-    bool working = false;
-    FT_Library lib;
-    FT_Face face;
-};
-
-void paint_surface(MirWindow* surface, std::string const& title, int const intensity)
-{
-    MirBufferStream* buffer_stream = mir_window_get_buffer_stream(surface);
-
-    // TODO sometimes buffer_stream is nullptr - find out why (and fix).
-    // (Only observed when creating a lot of clients at once)
-    if (!buffer_stream)
-        return;
-
-    MirGraphicsRegion region;
-    mir_buffer_stream_get_graphics_region(buffer_stream, &region);
-
-    char* row = region.vaddr;
-
-    for (int j = 0; j != region.height; ++j)
-    {
-        memset(row, intensity, 4*region.width);
-        row += region.stride;
-    }
-
-    static Printer printer;
-    printer.print(region, title, intensity);
-
-    mir_buffer_stream_swap_buffers_sync(buffer_stream);
-}
-
-Printer::Printer()
-{
-    if (FT_Init_FreeType(&lib))
-        return;
-
-    if (FT_New_Face(lib, titlebar::font_file().c_str(), 0, &face))
-    {
-        std::cerr << "WARNING: failed to load titlebar font: \"" <<  titlebar::font_file() << "\"\n";
-        FT_Done_FreeType(lib);
-        return;
-    }
-
-    FT_Set_Pixel_Sizes(face, 0, 10);
-    working = true;
-}
-
-Printer::~Printer()
-{
-    if (working)
-    {
-        FT_Done_Face(face);
-        FT_Done_FreeType(lib);
-    }
-}
-
-void Printer::print(MirGraphicsRegion const& region, std::string const& title_, int const intensity)
-try
-{
-    if (!working)
-        return;
-
-    auto title = converter.from_bytes(title_);
-
-    int base_x = 2;
-    int base_y = region.height-2;
-
-    for (auto const& ch : title)
-    {
-        FT_Load_Glyph(face, FT_Get_Char_Index(face, ch), FT_LOAD_DEFAULT);
-        auto const glyph = face->glyph;
-        FT_Render_Glyph(glyph, FT_RENDER_MODE_NORMAL);
-
-        auto const& bitmap = glyph->bitmap;
-        auto const x = base_x + glyph->bitmap_left;
-
-        if (static_cast<int>(x + bitmap.width) <= region.width)
-        {
-            unsigned char* src = bitmap.buffer;
-
-            auto const y = base_y - glyph->bitmap_top;
-            char* dest = region.vaddr + y*region.stride + 4*x;
-
-            for (auto row = 0u; row != std::min(bitmap.rows, glyph->bitmap_top+2u); ++row)
-            {
-                for (auto col = 0u; col != bitmap.width; ++col)
-                    memset(dest+ 4*col, (intensity*(0xff^src[col]))/0xff, 4);
-
-                src += bitmap.pitch;
-                dest += region.stride;
-            }
-        }
-
-        base_x += glyph->advance.x >> 6;
-        base_y += glyph->advance.y >> 6;
-    }
-}
-catch (...)
-{
-    std::cerr << "WARNING: failed render title: \"" <<  title_ << "\"\n";
-}
-
-void Printer::printhelp(MirGraphicsRegion const& region)
-{
-    if (!working)
-        return;
-
-    static char const* const helptext[] =
-        {
-            "Welcome to miral-shell",
-            "",
-            "Keyboard shortcuts:",
-            "",
-            "  o Switch apps: Alt-Tab, tap or click on the corresponding window",
-            "  o Next (previous) app window: Alt-` (Alt-Shift-`)",
-            "",
-            "  o Move window: Alt-leftmousebutton drag (three finger drag)",
-            "  o Resize window: Alt-middle_button drag (three finger pinch)",
-            "",
-            "  o Maximize/restore current window (to display size). : Alt-F11",
-            "  o Maximize/restore current window (to display height): Shift-F11",
-            "  o Maximize/restore current window (to display width) : Ctrl-F11",
-            "",
-            "  o Switch workspace: Meta-Alt-[F1|F2|F3|F4]",
-            "  o Switch workspace taking active window: Meta-Ctrl-[F1|F2|F3|F4]",
-            "",
-            "  o To exit: Ctrl-Alt-BkSp",
-        };
-
-    int help_width = 0;
-    unsigned int help_height = 0;
-    unsigned int line_height = 0;
-
-    for (auto const* rawline : helptext)
-    {
-        int line_width = 0;
-
-        auto const line = converter.from_bytes(rawline);
-
-        auto const fwidth = std::min(region.width / 60, 20);
-
-        FT_Set_Pixel_Sizes(face, fwidth, 0);
-
-        for (auto const& ch : line)
-        {
-            FT_Load_Glyph(face, FT_Get_Char_Index(face, ch), FT_LOAD_DEFAULT);
-            auto const glyph = face->glyph;
-            FT_Render_Glyph(glyph, FT_RENDER_MODE_NORMAL);
-
-            line_width += glyph->advance.x >> 6;
-            line_height = std::max(line_height, glyph->bitmap.rows + glyph->bitmap.rows/2);
-        }
-
-        if (help_width < line_width) help_width = line_width;
-        help_height += line_height;
-    }
-
-    int base_y = (region.height - help_height)/2;
-
-    for (auto const* rawline : helptext)
-    {
-        int base_x = (region.width - help_width)/2;
-
-        auto const line = converter.from_bytes(rawline);
-
-        for (auto const& ch : line)
-        {
-            FT_Load_Glyph(face, FT_Get_Char_Index(face, ch), FT_LOAD_DEFAULT);
-            auto const glyph = face->glyph;
-            FT_Render_Glyph(glyph, FT_RENDER_MODE_NORMAL);
-
-            auto const& bitmap = glyph->bitmap;
-            auto const x = base_x + glyph->bitmap_left;
-
-            if (static_cast<int>(x + bitmap.width) <= region.width)
-            {
-                unsigned char* src = bitmap.buffer;
-
-                auto const y = base_y - glyph->bitmap_top;
-                char* dest = region.vaddr + y * region.stride + 4 * x;
-
-                for (auto row = 0u; row != bitmap.rows; ++row)
-                {
-                    for (auto col = 0u; col != 4 * bitmap.width; ++col)
-                        dest[col] |= src[col / 4]/2;
-
-                    src += bitmap.pitch;
-                    dest += region.stride;
-
-                    if (dest > region.vaddr + region.height * region.stride)
-                        break;
-                }
-            }
-
-            base_x += glyph->advance.x >> 6;
-        }
-        base_y += line_height;
-    }
-}
 }
 
 using namespace mir::client;
@@ -274,6 +56,11 @@ DecorationProvider::~DecorationProvider()
 {
 }
 
+auto DecorationProvider::titlebar_repaints() const -> TitlebarRepaints const&
+{
+    return repaints;
+}
+
 void DecorationProvider::stop()
 {
     enqueue_work([this]
@@ -302,17 +89,10 @@ namespace
 {
 void render_pattern(MirGraphicsRegion* region, uint8_t const pattern[])
 {
-    char* row = region->vaddr;
-
-    for (int j = 0; j < region->height; j++)
-    {
-        uint32_t* pixel = (uint32_t*)row;
+    pixel::Colour colour;
+    memcpy(&colour, pattern, sizeof colour);
 
-        for (int i = 0; i < region->width; i++)
-            memcpy(pixel + i, pattern, sizeof pixel[i]);
-
-        row += region->stride;
-    }
+    pixel::fill(region->vaddr, region->stride, region->width, region->height, colour);
 
     static Printer printer;
     printer.printhelp(*region);
@@ -390,24 +170,127 @@ void DecorationProvider::paint_titlebar_for(miral::WindowInfo const& info, int i
 
         if (auto surface = data->titlebar.load())
         {
-            enqueue_work([this, surface, title, intensity]{ paint_surface(surface, title, intensity); });
+            request_repaint(data, surface, title, intensity);
         }
         else
         {
-            data->on_create = [this, title, intensity](MirWindow* surface)
-                { enqueue_work([this, surface, title, intensity]{ paint_surface(surface, title, intensity); }); };
+            data->on_create = [this, data, title, intensity](MirWindow* surface)
+                { request_repaint(data, surface, title, intensity); };
         }
     }
 }
 
+void DecorationProvider::request_repaint(Data* data, MirWindow* surface, std::string const& title, int intensity)
+{
+    {
+        std::lock_guard<decltype(data->paint_mutex)> lock{data->paint_mutex};
+        data->wanted.title = title;
+        data->wanted.intensity = intensity;
+    }
+
+    repaints.requested();
+    schedule_paint(data, surface);
+}
+
+void DecorationProvider::schedule_paint(Data* data, MirWindow* surface)
+{
+    // Any paint of this titlebar still queued is superseded: this one paints whatever
+    // is wanted when it runs (and nothing at all if that is already in the buffer)
+    enqueue_superseding_work(surface, [this, data, surface]
+        {
+            {
+                auto const& state = data->swap_state;
+                std::lock_guard<decltype(state->mutex)> lock{state->mutex};
+
+                // The titlebar is (about to be) released, so there's nothing to paint
+                if (state->releasing)
+                    return;
+
+                if (state->in_flight)
+                {
+                    state->paint_after = true;
+                    return;
+                }
+            }
+
+            TitlebarAppearance wanted;
+            {
+                std::lock_guard<decltype(data->paint_mutex)> lock{data->paint_mutex};
+                wanted = data->wanted;
+            }
+
+            paint_surface(data, surface, wanted);
+        });
+}
+
+void DecorationProvider::paint_surface(Data* data, MirWindow* surface, TitlebarAppearance const& wanted)
+{
+    MirBufferStream* buffer_stream = mir_window_get_buffer_stream(surface);
+
+    // TODO sometimes buffer_stream is nullptr - find out why (and fix).
+    // (Only observed when creating a lot of clients at once)
+    if (!buffer_stream)
+        return;
+
+    MirGraphicsRegion region;
+    mir_buffer_stream_get_graphics_region(buffer_stream, &region);
+
+    TitlebarAppearance const target{wanted.title, wanted.intensity, region.width, region.height};
+
+    // The buffer hasn't been swapped since painting this, so nothing visible would change
+    if (!repaints.needed(data->painted, target))
+        return;
+
+    pixel::fill(region.vaddr, region.stride, region.width, region.height, 0x01010101u*(target.intensity & 0xff));
+
+    // Titlebars are painted on several threads and a Printer (and its caches) isn't shared
+    static thread_local Printer printer;
+    printer.print(region, target.title);
+
+    auto const& state = data->swap_state;
+    {
+        std::lock_guard<decltype(state->mutex)> lock{state->mutex};
+        state->in_flight = true;
+    }
+
+    // Don't wait for the compositor: the worker moves on to other titlebars
+    mir_buffer_stream_swap_buffers(buffer_stream, &swapped, new Swap{this, data, surface, state});
+}
+
+void DecorationProvider::swapped(MirBufferStream*, void* context)
+{
+    std::unique_ptr<Swap> const swap{static_cast<Swap*>(context)};
+    auto const& state = swap->state;
+
+    std::lock_guard<decltype(state->mutex)> lock{state->mutex};
+    state->in_flight = false;
+
+    // Once releasing starts neither the titlebar nor its Data may be used
+    if (state->paint_after && !state->releasing)
+        swap->provider->schedule_paint(swap->data, swap->surface);
+
+    state->paint_after = false;
+    state->done.notify_all();
+}
+
 void DecorationProvider::destroy_titlebar_for(miral::Window const& window)
 {
     if (auto data = find_titlebar_data(window))
     {
         if (auto surface = data->titlebar.exchange(nullptr))
         {
-            enqueue_work([surface]
+            // Before the release is queued, so no paint can be scheduled behind it
+            data->start_releasing();
+
+            // Keyed by the titlebar so that it follows any paint already queued. Give an
+            // outstanding swap a chance to complete, but don't hold up the worker for long.
+            enqueue_work(surface, [state=data->swap_state, surface]
                  {
+                     {
+                         std::unique_lock<decltype(state->mutex)> lock{state->mutex};
+                         state->done.wait_for(lock, swap_timeout, [&state] { return !state->in_flight; });
+                     }
+
                      mir_window_release(surface, &null_window_callback, nullptr);
                  });
         }
@@ -434,18 +317,26 @@ void DecorationProvider::destroy_titlebar_for(miral::Window const& window)
     }
 }
 
-void DecorationProvider::resize_titlebar_for(miral::WindowInfo const& window_info, Size const& size)
+void DecorationProvider::resize_titlebars_for(std::vector<miral::GeometryChange> const& changes)
 {
-    auto const window = window_info.window();
-
-    if (window.size().width == size.width)
-        return;
+    std::lock_guard<decltype(mutex)> lock{mutex};
 
-    if (auto titlebar_window = find_titlebar_window(window))
+    for (auto const& change : changes)
     {
-        titlebar_window.resize({size.width, title_bar_height});
+        if (!change.size.is_set() || change.window.size().width == change.size.value().width)
+            continue;
 
-        repaint_titlebar_for(window_info);
+        auto const find = window_to_titlebar.find(change.window);
+
+        if (find == window_to_titlebar.end())
+            continue;
+
+        auto& data = find->second;
+        data.window.resize({change.size.value().width, title_bar_height});
+
+        // The resized titlebars are independent, so they can be repainted in parallel
+        if (auto const surface = data.titlebar.load())
+            request_repaint(&data, surface, tools.info_for(change.window).name(), data.intensity.load());
     }
 }
 
@@ -513,14 +404,23 @@ void DecorationProvider::repaint_titlebar_for(miral::WindowInfo const& window_in
 
         if (auto surface = data->titlebar.load())
         {
-            enqueue_work([this, surface, title, intensity=data->intensity.load()]
-                             { paint_surface(surface, title, intensity); });
+            request_repaint(data, surface, title, data->intensity.load());
         }
     }
 }
 
+void DecorationProvider::Data::start_releasing()
+{
+    std::lock_guard<decltype(swap_state->mutex)> lock{swap_state->mutex};
+    swap_state->releasing = true;
+}
+
 DecorationProvider::Data::~Data()
 {
+    // Don't wait for an outstanding swap: during shutdown the server may never complete
+    // it. (Its callback only uses swap_state, which it shares.)
+    start_releasing();
+
     if (auto surface = titlebar.exchange(nullptr))
         mir_window_release(surface, &null_window_callback, nullptr);
 }
@@ -558,40 +458,3 @@ bool DecorationProvider::is_titlebar(miral::WindowInfo const& window_info) const
 {
     return window_info.window().application() == session() && window_info.name() != wallpaper_name;
 }
-
-Worker::~Worker()
-{
-}
-
-void Worker::do_work()
-{
-    while (!work_done)
-    {
-        WorkQueue::value_type work;
-        {
-            std::unique_lock<decltype(work_mutex)> lock{work_mutex};
-            work_cv.wait(lock, [this] { return !work_queue.empty(); });
-            work = work_queue.front();
-            work_queue.pop();
-        }
-
-        work();
-    }
-}
-
-void Worker::enqueue_work(std::function<void()> const& functor)
-{
-    std::lock_guard<decltype(work_mutex)> lock{work_mutex};
-    work_queue.push(functor);
-    work_cv.notify_one();
-}
-
-void Worker::start_work()
-{
-    do_work();
-}
-
-void Worker::stop_work()
-{
-    enqueue_work([this] { work_done = true; });
-}
@@ -20,6 +20,10 @@
 #define MIRAL_SHELL_DECORATION_PROVIDER_H
 
 
+#include "titlebar_repaints.h"
+#include "worker.h"
+
+#include <miral/geometry_batch_policy.h>
 #include <miral/window_manager_tools.h>
 
 #include <mir/client/connection.h>
@@ -30,29 +34,10 @@
 
 #include <atomic>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <condition_variable>
-#include <queue>
-
-class Worker
-{
-public:
-    ~Worker();
-
-    void start_work();
-    void enqueue_work(std::function<void()> const& functor);
-    void stop_work();
-
-private:
-    using WorkQueue = std::queue<std::function<void()>>;
-
-    std::mutex mutable work_mutex;
-    std::condition_variable work_cv;
-    WorkQueue work_queue;
-    bool work_done = false;
-
-    void do_work();
-};
+#include <string>
 
 class DecorationProvider : Worker
 {
@@ -69,7 +54,7 @@ public:
     void place_new_decoration(miral::WindowSpecification& window_spec);
     void paint_titlebar_for(miral::WindowInfo const& window, int intensity);
     void destroy_titlebar_for(miral::Window const& window);
-    void resize_titlebar_for(miral::WindowInfo const& window_info, mir::geometry::Size const& size);
+    void resize_titlebars_for(std::vector<miral::GeometryChange> const& changes);
     void advise_new_titlebar(miral::WindowInfo const& window_info);
     void advise_state_change(miral::WindowInfo const& window_info, MirWindowState state);
 
@@ -78,7 +63,22 @@ public:
     bool is_decoration(miral::Window const& window) const;
     bool is_titlebar(miral::WindowInfo const& window_info) const;
 
+    /// The titlebar repaints requested and performed (for tests and diagnostics)
+    auto titlebar_repaints() const -> TitlebarRepaints const&;
+
 private:
+    // Buffers are swapped asynchronously, with at most one swap in flight per titlebar:
+    // a paint that comes up meanwhile is deferred until the swap completes. This is
+    // shared with the swap callback, which may come after the titlebar is released.
+    struct SwapState
+    {
+        std::mutex mutex;
+        std::condition_variable done;
+        bool in_flight = false;
+        bool paint_after = false;
+        bool releasing = false;
+    };
+
     struct Data
     {
         std::atomic<MirWindow*> titlebar{nullptr};
@@ -86,9 +86,27 @@ private:
         std::function<void(MirWindow* surface)> on_create{[](MirWindow*){}};
         miral::Window window;
 
+        // The appearance most recently asked for, and that in the titlebar's buffer
+        // (painted is only used by paint work, which is serialized per titlebar)
+        std::mutex mutable paint_mutex;
+        TitlebarAppearance wanted{{}, 0xff, 0, 0};
+        TitlebarAppearance painted{{}, -1, 0, 0};
+
+        std::shared_ptr<SwapState> const swap_state{std::make_shared<SwapState>()};
+
+        void start_releasing();
         ~Data();
     };
 
+    // The context of an in-flight swap
+    struct Swap
+    {
+        DecorationProvider* provider;
+        Data* data;
+        MirWindow* surface;
+        std::shared_ptr<SwapState> state;
+    };
+
     using SurfaceMap = std::map<std::weak_ptr<mir::scene::Surface>, Data, std::owner_less<std::weak_ptr<mir::scene::Surface>>>;
     using TitleMap = std::map<std::string, std::weak_ptr<mir::scene::Surface>>;
 
@@ -101,7 +119,13 @@ private:
     SurfaceMap window_to_titlebar;
     TitleMap windows_awaiting_titlebar;
 
+    TitlebarRepaints repaints;
+
     static void insert(MirWindow* surface, Data* data);
+    static void swapped(MirBufferStream* buffer_stream, void* context);
+    void paint_surface(Data* data, MirWindow* surface, TitlebarAppearance const& wanted);
+    void request_repaint(Data* data, MirWindow* surface, std::string const& title, int intensity);
+    void schedule_paint(Data* data, MirWindow* surface);
     Data* find_titlebar_data(miral::Window const& window);
     miral::Window find_titlebar_window(miral::Window const& window) const;
     void repaint_titlebar_for(miral::WindowInfo const& window_info);
@@ -0,0 +1,221 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "pixel_kernels.h"
+
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace
+{
+using pixel::Colour;
+
+// x/255 (rounded down) for x in [0, 255*255], without a divide
+inline auto div255(unsigned x) -> unsigned
+{
+    return (x + 1 + (x >> 8)) >> 8;
+}
+
+void fill_row_scalar(Colour* dest, int width, Colour colour)
+{
+    for (auto i = 0; i != width; ++i)
+        dest[i] = colour;
+}
+
+void blend_row_scalar(unsigned char* dest, unsigned char const* coverage, int width, Colour ink)
+{
+    unsigned char ink_channel[4];
+    memcpy(ink_channel, &ink, sizeof ink_channel);
+
+    for (auto i = 0; i != width; ++i, dest += 4)
+    {
+        unsigned const c = coverage[i];
+
+        for (auto channel = 0; channel != 4; ++channel)
+            dest[channel] = div255(dest[channel]*(255-c) + ink_channel[channel]*c);
+    }
+}
+
+#if defined(__SSE2__)
+void blend_row_sse2(unsigned char* dest, unsigned char const* coverage, int width, Colour ink)
+{
+    auto const zero = _mm_setzero_si128();
+    auto const max = _mm_set1_epi16(255);
+    auto const one = _mm_set1_epi16(1);
+    auto const ink16 = _mm_unpacklo_epi8(_mm_set1_epi32(ink), zero);
+
+    // Two pixels with 16 bits per channel
+    auto const blend = [=](__m128i pixels, __m128i cover)
+        {
+            auto x = _mm_add_epi16(
+                _mm_mullo_epi16(pixels, _mm_sub_epi16(max, cover)),
+                _mm_mullo_epi16(ink16, cover));
+
+            return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(x, one), _mm_srli_epi16(x, 8)), 8);
+        };
+
+    auto i = 0;
+    for (; i + 4 <= width; i += 4)
+    {
+        std::int32_t cover4;
+        memcpy(&cover4, coverage + i, sizeof cover4);
+
+        // Repeat each coverage byte for the four channels of its pixel
+        auto cover = _mm_cvtsi32_si128(cover4);
+        cover = _mm_unpacklo_epi8(cover, cover);
+        cover = _mm_unpacklo_epi16(cover, cover);
+
+        auto const pixels = _mm_loadu_si128(reinterpret_cast<__m128i const*>(dest + 4*i));
+
+        auto const lo = blend(_mm_unpacklo_epi8(pixels, zero), _mm_unpacklo_epi8(cover, zero));
+        auto const hi = blend(_mm_unpackhi_epi8(pixels, zero), _mm_unpackhi_epi8(cover, zero));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 4*i), _mm_packus_epi16(lo, hi));
+    }
+
+    blend_row_scalar(dest + 4*i, coverage + i, width - i, ink);
+}
+
+// AVX2 isn't part of the x86-64 baseline, so it is selected at runtime
+__attribute__((target("avx2")))
+void blend_row_avx2(unsigned char* dest, unsigned char const* coverage, int width, Colour ink)
+{
+    auto const zero = _mm256_setzero_si256();
+    auto const max = _mm256_set1_epi16(255);
+    auto const one = _mm256_set1_epi16(1);
+    auto const ink16 = _mm256_unpacklo_epi8(_mm256_set1_epi32(ink), zero);
+
+    auto i = 0;
+    for (; i + 8 <= width; i += 8)
+    {
+        // Repeat each coverage byte for the four channels of its pixel
+        auto cover8 = _mm_loadl_epi64(reinterpret_cast<__m128i const*>(coverage + i));
+        cover8 = _mm_unpacklo_epi8(cover8, cover8);
+        auto const cover = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_unpacklo_epi16(cover8, cover8)), _mm_unpackhi_epi16(cover8, cover8), 1);
+
+        auto const pixels = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(dest + 4*i));
+
+        // (The unpacks and pack work within each 128-bit lane, so the pixel order is kept)
+        __m256i result[2];
+        for (auto half = 0; half != 2; ++half)
+        {
+            auto const p = half ? _mm256_unpackhi_epi8(pixels, zero) : _mm256_unpacklo_epi8(pixels, zero);
+            auto const c = half ? _mm256_unpackhi_epi8(cover, zero) : _mm256_unpacklo_epi8(cover, zero);
+
+            auto const x = _mm256_add_epi16(
+                _mm256_mullo_epi16(p, _mm256_sub_epi16(max, c)),
+                _mm256_mullo_epi16(ink16, c));
+
+            result[half] = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(x, one), _mm256_srli_epi16(x, 8)), 8);
+        }
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + 4*i), _mm256_packus_epi16(result[0], result[1]));
+    }
+
+    blend_row_sse2(dest + 4*i, coverage + i, width - i, ink);
+}
+
+auto have_avx2() -> bool
+{
+    static bool const result = []
+        {
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") != 0;
+        }();
+
+    return result;
+}
+
+void blend_row(unsigned char* dest, unsigned char const* coverage, int width, Colour ink)
+{
+    if (have_avx2())
+        blend_row_avx2(dest, coverage, width, ink);
+    else
+        blend_row_sse2(dest, coverage, width, ink);
+}
+#elif defined(__ARM_NEON)
+void blend_row(unsigned char* dest, unsigned char const* coverage, int width, Colour ink)
+{
+    auto const ink8 = vreinterpret_u8_u32(vdup_n_u32(ink));
+    auto const one = vdupq_n_u16(1);
+
+    auto i = 0;
+    for (; i + 2 <= width; i += 2)
+    {
+        // Repeat each coverage byte for the four channels of its pixel
+        auto const cover = vreinterpret_u8_u32(
+            vset_lane_u32(coverage[i+1]*0x01010101u, vdup_n_u32(coverage[i]*0x01010101u), 1));
+
+        auto const pixels = vld1_u8(dest + 4*i);
+
+        auto x = vmull_u8(pixels, vmvn_u8(cover));
+        x = vmlal_u8(x, ink8, cover);
+        x = vaddq_u16(x, vsraq_n_u16(one, x, 8));
+
+        vst1_u8(dest + 4*i, vshrn_n_u16(x, 8));
+    }
+
+    blend_row_scalar(dest + 4*i, coverage + i, width - i, ink);
+}
+#else
+void blend_row(unsigned char* dest, unsigned char const* coverage, int width, Colour ink)
+{
+    blend_row_scalar(dest, coverage, width, ink);
+}
+#endif
+}
+
+void pixel::fill(char* dest, int stride, int width, int height, Colour colour)
+{
+    // When all four bytes match (e.g. the grey of a titlebar) the C library's memset() is hard to beat
+    if (colour == 0x01010101u*(colour & 0xff))
+    {
+        for (auto row = 0; row != height; ++row, dest += stride)
+            memset(dest, colour & 0xff, 4*width);
+        return;
+    }
+
+    for (auto row = 0; row != height; ++row, dest += stride)
+        fill_row_scalar(reinterpret_cast<Colour*>(dest), width, colour);
+}
+
+void pixel::blend_coverage(
+    char* dest, int stride,
+    unsigned char const* coverage, int coverage_stride,
+    int width, int height,
+    Colour ink)
+{
+    for (auto row = 0; row != height; ++row, dest += stride, coverage += coverage_stride)
+        blend_row(reinterpret_cast<unsigned char*>(dest), coverage, width, ink);
+}
+
+void pixel::scalar::blend_coverage(
+    char* dest, int stride,
+    unsigned char const* coverage, int coverage_stride,
+    int width, int height,
+    Colour ink)
+{
+    for (auto row = 0; row != height; ++row, dest += stride, coverage += coverage_stride)
+        blend_row_scalar(reinterpret_cast<unsigned char*>(dest), coverage, width, ink);
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_SHELL_PIXEL_KERNELS_H
+#define MIRAL_SHELL_PIXEL_KERNELS_H
+
+#include <cstdint>
+
+/// Kernels for painting decorations into mir_pixel_format_xrgb_8888 buffers.
+/// Blending is vectorized with SSE2 (or AVX2) or NEON where the target has them.
+/// The scalar version is used for the remainder of each row and is exposed for
+/// testing.
+namespace pixel
+{
+using Colour = std::uint32_t;   // 0xXXRRGGBB
+
+/// Set width pixels of each of height rows (stride bytes apart) to colour
+void fill(char* dest, int stride, int width, int height, Colour colour);
+
+/// Blend ink over the pixels in proportion to the 8-bit coverage (e.g. of a glyph).
+/// Each channel becomes (pixel*(255-coverage) + ink*coverage)/255.
+void blend_coverage(
+    char* dest, int stride,
+    unsigned char const* coverage, int coverage_stride,
+    int width, int height,
+    Colour ink);
+
+namespace scalar
+{
+void blend_coverage(
+    char* dest, int stride,
+    unsigned char const* coverage, int coverage_stride,
+    int width, int height,
+    Colour ink);
+}
+}
+
+#endif //MIRAL_SHELL_PIXEL_KERNELS_H
@@ -0,0 +1,283 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "printer.h"
+#include "titlebar_config.h"
+#include "pixel_kernels.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+pixel::Colour const text_colour = 0x00000000;
+}
+
+Printer::Printer(std::size_t max_atlas_bytes, std::size_t max_shaped_titles) :
+    max_atlas_bytes{max_atlas_bytes},
+    max_shaped_titles{max_shaped_titles}
+{
+    if (FT_Init_FreeType(&lib))
+        return;
+
+    if (FT_New_Face(lib, titlebar::font_file().c_str(), 0, &face))
+    {
+        std::cerr << "WARNING: failed to load titlebar font: \"" <<  titlebar::font_file() << "\"\n";
+        FT_Done_FreeType(lib);
+        return;
+    }
+
+    FT_Set_Pixel_Sizes(face, 0, 10);
+    face_pixel_height = 10;
+    working = true;
+}
+
+Printer::~Printer()
+{
+    if (working)
+    {
+        FT_Done_Face(face);
+        FT_Done_FreeType(lib);
+    }
+}
+
+auto Printer::glyph_for(wchar_t ch, unsigned pixel_width, unsigned pixel_height) -> Glyph const&
+{
+    auto const key = (std::uint64_t(ch) << 32) | (std::uint64_t(pixel_width) << 16) | pixel_height;
+
+    auto const cached = glyphs.find(key);
+    if (cached != glyphs.end())
+        return cached->second;
+
+    if (face_pixel_width != pixel_width || face_pixel_height != pixel_height)
+    {
+        FT_Set_Pixel_Sizes(face, pixel_width, pixel_height);
+        face_pixel_width = pixel_width;
+        face_pixel_height = pixel_height;
+    }
+
+    FT_Load_Glyph(face, FT_Get_Char_Index(face, ch), FT_LOAD_DEFAULT);
+    auto const glyph = face->glyph;
+    FT_Render_Glyph(glyph, FT_RENDER_MODE_NORMAL);
+
+    auto const& bitmap = glyph->bitmap;
+
+    Glyph const result{
+        atlas.size(),
+        bitmap.width,
+        bitmap.rows,
+        glyph->bitmap_left,
+        glyph->bitmap_top,
+        int(glyph->advance.x >> 6),
+        int(glyph->advance.y >> 6)};
+
+    unsigned char const* src = bitmap.buffer;
+
+    for (auto row = 0u; row != bitmap.rows; ++row)
+    {
+        atlas.insert(atlas.end(), src, src + bitmap.width);
+        src += bitmap.pitch;
+    }
+
+    return glyphs.emplace(key, result).first->second;
+}
+
+auto Printer::shape(std::string const& title) -> ShapedTitle const&
+{
+    auto const cached = shaped_titles.find(title);
+    if (cached != shaped_titles.end())
+        return cached->second;
+
+    ShapedTitle shaped;
+
+    int x = 0;
+    int y = 0;
+
+    for (auto const& ch : converter.from_bytes(title))
+    {
+        auto const& glyph = glyph_for(ch, 0, 10);
+        shaped.push_back(PlacedGlyph{x, y, &glyph});
+
+        x += glyph.advance_x;
+        y += glyph.advance_y;
+    }
+
+    return shaped_titles.emplace(title, std::move(shaped)).first->second;
+}
+
+void Printer::trim_caches()
+{
+    // Titles can change often (e.g. a terminal showing the current command) so
+    // don't let the caches grow without bound
+    if (atlas.size() > max_atlas_bytes)
+    {
+        shaped_titles.clear();
+        glyphs.clear();
+        atlas.clear();
+    }
+    else if (shaped_titles.size() > max_shaped_titles)
+    {
+        shaped_titles.clear();
+    }
+}
+
+void Printer::print(MirGraphicsRegion const& region, std::string const& title_)
+try
+{
+    if (!working)
+        return;
+
+    trim_caches();
+
+    int const base_x = 2;
+    int const base_y = region.height-2;
+
+    for (auto const& placed : shape(title_))
+    {
+        auto const& glyph = *placed.glyph;
+        auto const x = base_x + placed.x + glyph.left;
+
+        if (static_cast<int>(x + glyph.width) <= region.width)
+        {
+            auto const y = base_y + placed.y - glyph.top;
+            auto const rows = std::min(glyph.rows, glyph.top+2u);
+
+            pixel::blend_coverage(
+                region.vaddr + y*region.stride + 4*x, region.stride,
+                atlas.data() + glyph.offset, glyph.width,
+                glyph.width, rows,
+                text_colour);
+        }
+    }
+}
+catch (...)
+{
+    std::cerr << "WARNING: failed render title: \"" <<  title_ << "\"\n";
+}
+
+void Printer::printhelp(MirGraphicsRegion const& region)
+{
+    if (!working)
+        return;
+
+    static char const* const helptext[] =
+        {
+            "Welcome to miral-shell",
+            "",
+            "Keyboard shortcuts:",
+            "",
+            "  o Switch apps: Alt-Tab, tap or click on the corresponding window",
+            "  o Next (previous) app window: Alt-` (Alt-Shift-`)",
+            "",
+            "  o Move window: Alt-leftmousebutton drag (three finger drag)",
+            "  o Resize window: Alt-middle_button drag (three finger pinch)",
+            "",
+            "  o Maximize/restore current window (to display size). : Alt-F11",
+            "  o Maximize/restore current window (to display height): Shift-F11",
+            "  o Maximize/restore current window (to display width) : Ctrl-F11",
+            "",
+            "  o Switch workspace: Meta-Alt-[F1|F2|F3|F4]",
+            "  o Switch workspace taking active window: Meta-Ctrl-[F1|F2|F3|F4]",
+            "",
+            "  o To exit: Ctrl-Alt-BkSp",
+        };
+
+    trim_caches();
+
+    unsigned const fwidth = std::min(region.width / 60, 20);
+
+    int help_width = 0;
+    unsigned int help_height = 0;
+    unsigned int line_height = 0;
+
+    for (auto const* rawline : helptext)
+    {
+        int line_width = 0;
+
+        auto const line = converter.from_bytes(rawline);
+
+        for (auto const& ch : line)
+        {
+            auto const& glyph = glyph_for(ch, fwidth, 0);
+
+            line_width += glyph.advance_x;
+            line_height = std::max(line_height, glyph.rows + glyph.rows/2);
+        }
+
+        if (help_width < line_width) help_width = line_width;
+        help_height += line_height;
+    }
+
+    int base_y = (region.height - help_height)/2;
+
+    for (auto const* rawline : helptext)
+    {
+        int base_x = (region.width - help_width)/2;
+
+        auto const line = converter.from_bytes(rawline);
+
+        for (auto const& ch : line)
+        {
+            auto const& glyph = glyph_for(ch, fwidth, 0);
+            auto const x = base_x + glyph.left;
+
+            if (static_cast<int>(x + glyph.width) <= region.width)
+            {
+                unsigned char const* src = atlas.data() + glyph.offset;
+
+                auto const y = base_y - glyph.top;
+                char* dest = region.vaddr + y * region.stride + 4 * x;
+
+                for (auto row = 0u; row != glyph.rows; ++row)
+                {
+                    for (auto col = 0u; col != 4 * glyph.width; ++col)
+                        dest[col] |= src[col / 4]/2;
+
+                    src += glyph.width;
+                    dest += region.stride;
+
+                    if (dest > region.vaddr + region.height * region.stride)
+                        break;
+                }
+            }
+
+            base_x += glyph.advance_x;
+        }
+        base_y += line_height;
+    }
+}
+
+auto Printer::has_font() const -> bool
+{
+    return working;
+}
+
+auto Printer::cached_glyphs() const -> std::size_t
+{
+    return glyphs.size();
+}
+
+auto Printer::cached_titles() const -> std::size_t
+{
+    return shaped_titles.size();
+}
+
+auto Printer::atlas_bytes() const -> std::size_t
+{
+    return atlas.size();
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_SHELL_PRINTER_H
+#define MIRAL_SHELL_PRINTER_H
+
+#include <mir_toolkit/client_types.h>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include <codecvt>
+#include <cstdint>
+#include <locale>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// Renders titlebar and help text with FreeType
+class Printer
+{
+public:
+    /// The caches are cleared if the glyphs rendered exceed max_atlas_bytes,
+    /// and the shaped titles if there are more than max_shaped_titles
+    Printer(std::size_t max_atlas_bytes = 1024*1024, std::size_t max_shaped_titles = 256);
+    ~Printer();
+    Printer(Printer const&) = delete;
+    Printer& operator=(Printer const&) = delete;
+
+    void print(MirGraphicsRegion const& region, std::string const& title);
+    void printhelp(MirGraphicsRegion const& region);
+
+    /// Whether the font loaded (otherwise nothing is printed)
+    auto has_font() const -> bool;
+
+    auto cached_glyphs() const -> std::size_t;
+    auto cached_titles() const -> std::size_t;
+    auto atlas_bytes() const -> std::size_t;
+
+private:
+    // A glyph rendered into the atlas as a width x rows coverage bitmap
+    struct Glyph
+    {
+        std::size_t offset;
+        unsigned width;
+        unsigned rows;
+        int left;
+        int top;
+        int advance_x;
+        int advance_y;
+    };
+
+    // A glyph of a title, positioned relative to the start of the baseline
+    struct PlacedGlyph
+    {
+        int x;
+        int y;
+        Glyph const* glyph;
+    };
+
+    using ShapedTitle = std::vector<PlacedGlyph>;
+
+    auto glyph_for(wchar_t ch, unsigned pixel_width, unsigned pixel_height) -> Glyph const&;
+    auto shape(std::string const& title) -> ShapedTitle const&;
+    void trim_caches();
+
+    struct preferred_codecvt : std::codecvt_byname<wchar_t, char, std::mbstate_t>
+    {
+        preferred_codecvt() : std::codecvt_byname<wchar_t, char, std::mbstate_t>("") {}
+        ~preferred_codecvt() = default;
+    };
+
+    std::size_t const max_atlas_bytes;
+    std::size_t const max_shaped_titles;
+
+    std::wstring_convert<preferred_codecvt> converter;
+
+    bool working = false;
+    FT_Library lib;
+    FT_Face face;
+    unsigned face_pixel_width = 0;
+    unsigned face_pixel_height = 0;
+
+    // Rendering glyphs (and converting titles) is costly compared to copying pixels,
+    // so each is done once: glyphs are keyed by codepoint and pixel size, and titles
+    // by their text. (PlacedGlyph refers into glyphs, so the caches are trimmed together.)
+    std::vector<unsigned char> atlas;
+    std::unordered_map<std::uint64_t, Glyph> glyphs;
+    std::unordered_map<std::string, ShapedTitle> shaped_titles;
+};
+
+#endif //MIRAL_SHELL_PRINTER_H
@@ -310,7 +310,7 @@ bool TilingWindowManagerPolicy::handle_keyboard_event(MirKeyboardEvent const* ev
             return true;
 
         case mir_input_event_modifier_alt:
-            tools.ask_client_to_close(tools.active_window());;
+            tools.close_window(tools.active_window());
             return true;
 
         default:
@@ -0,0 +1,49 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "titlebar_repaints.h"
+
+bool TitlebarAppearance::operator==(TitlebarAppearance const& that) const
+{
+    return intensity == that.intensity && width == that.width && height == that.height && title == that.title;
+}
+
+void TitlebarRepaints::requested()
+{
+    ++requested_;
+}
+
+auto TitlebarRepaints::needed(TitlebarAppearance& painted, TitlebarAppearance const& wanted) -> bool
+{
+    if (painted == wanted)
+        return false;
+
+    painted = wanted;
+    ++performed_;
+    return true;
+}
+
+auto TitlebarRepaints::requested_count() const -> unsigned long
+{
+    return requested_;
+}
+
+auto TitlebarRepaints::performed_count() const -> unsigned long
+{
+    return performed_;
+}
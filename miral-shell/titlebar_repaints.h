@@ -0,0 +1,55 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_SHELL_TITLEBAR_REPAINTS_H
+#define MIRAL_SHELL_TITLEBAR_REPAINTS_H
+
+#include <atomic>
+#include <string>
+
+/// What a titlebar shows: painting the same appearance again changes nothing
+struct TitlebarAppearance
+{
+    std::string title;
+    int intensity;
+    int width;
+    int height;
+
+    bool operator==(TitlebarAppearance const& that) const;
+};
+
+/// Counts titlebar repaints asked for, and those that changed the titlebar (the rest
+/// were superseded by a later request or would have painted the same pixels again)
+class TitlebarRepaints
+{
+public:
+    void requested();
+
+    /// Whether a titlebar showing painted needs painting to show wanted. If so the
+    /// repaint is counted as performed and painted is updated to wanted.
+    auto needed(TitlebarAppearance& painted, TitlebarAppearance const& wanted) -> bool;
+
+    auto requested_count() const -> unsigned long;
+    auto performed_count() const -> unsigned long;
+
+private:
+    std::atomic<unsigned long> requested_{0};
+    std::atomic<unsigned long> performed_{0};
+};
+
+#endif //MIRAL_SHELL_TITLEBAR_REPAINTS_H
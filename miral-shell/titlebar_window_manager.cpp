@@ -344,11 +344,9 @@ void TitlebarWindowManagerPolicy::advise_state_change(WindowInfo const& window_i
     decoration_provider->advise_state_change(window_info, state);
 }
 
-void TitlebarWindowManagerPolicy::advise_resize(WindowInfo const& window_info, Size const& new_size)
+void TitlebarWindowManagerPolicy::advise_geometry_batch(std::vector<miral::GeometryChange> const& changes)
 {
-    CanonicalWindowManagerPolicy::advise_resize(window_info, new_size);
-
-    decoration_provider->resize_titlebar_for(window_info, new_size);
+    decoration_provider->resize_titlebars_for(changes);
 }
 
 void TitlebarWindowManagerPolicy::advise_delete_window(WindowInfo const& window_info)
@@ -431,7 +429,7 @@ bool TitlebarWindowManagerPolicy::handle_keyboard_event(MirKeyboardEvent const*
             return true;
 
         case mir_input_event_modifier_alt:
-            tools.ask_client_to_close(tools.active_window());;
+            tools.close_window(tools.active_window());
             return true;
 
         default:
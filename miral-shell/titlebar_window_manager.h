@@ -20,6 +20,7 @@
 #define MIRAL_SHELL_TITLEBAR_WINDOW_MANAGER_H
 
 #include <miral/canonical_window_manager.h>
+#include <miral/geometry_batch_policy.h>
 #include <miral/workspace_policy.h>
 
 #include "spinner/splash.h"
@@ -33,7 +34,8 @@ using namespace mir::geometry;
 
 class DecorationProvider;
 
-class TitlebarWindowManagerPolicy : public miral::CanonicalWindowManagerPolicy, miral::WorkspacePolicy
+class TitlebarWindowManagerPolicy : public miral::CanonicalWindowManagerPolicy, miral::WorkspacePolicy,
+    miral::GeometryBatchPolicy
 {
 public:
     TitlebarWindowManagerPolicy(
@@ -69,7 +71,7 @@ public:
     void advise_focus_lost(miral::WindowInfo const& info) override;
     void advise_focus_gained(miral::WindowInfo const& info) override;
     void advise_state_change(miral::WindowInfo const& window_info, MirWindowState state) override;
-    void advise_resize(miral::WindowInfo const& window_info, Size const& new_size) override;
+    void advise_geometry_batch(std::vector<miral::GeometryChange> const& changes) override;
     void advise_delete_window(miral::WindowInfo const& window_info) override;
 
     void handle_modify_window(miral::WindowInfo& window_info, miral::WindowSpecification const& modifications) override;
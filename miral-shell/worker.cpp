@@ -0,0 +1,149 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "worker.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+Worker::~Worker()
+{
+}
+
+auto Worker::next_runnable_work() -> WorkQueue::iterator
+{
+    // Called with work_mutex held
+    if (unkeyed_running)
+        return work_queue.end();
+
+    std::vector<Key> keys_waiting;
+
+    for (auto work = work_queue.begin(); work != work_queue.end(); ++work)
+    {
+        if (!work->key)
+        {
+            // Unkeyed work waits for everything before it, and everything after waits for it
+            if (work == work_queue.begin() && keys_running.empty())
+                return work;
+
+            break;
+        }
+
+        if (keys_running.count(work->key) ||
+            std::find(begin(keys_waiting), end(keys_waiting), work->key) != end(keys_waiting))
+        {
+            keys_waiting.push_back(work->key);
+            continue;
+        }
+
+        return work;
+    }
+
+    return work_queue.end();
+}
+
+void Worker::do_work()
+{
+    std::unique_lock<decltype(work_mutex)> lock{work_mutex};
+
+    while (!work_done)
+    {
+        auto const next = next_runnable_work();
+
+        if (next == work_queue.end())
+        {
+            work_cv.wait(lock);
+            continue;
+        }
+
+        auto const work = std::move(*next);
+        work_queue.erase(next);
+
+        if (work.key)
+            keys_running.insert(work.key);
+        else
+            unkeyed_running = true;
+
+        lock.unlock();
+        work.functor();
+        lock.lock();
+
+        if (work.key)
+            keys_running.erase(work.key);
+        else
+            unkeyed_running = false;
+
+        // Finishing this work may have made other work runnable
+        work_cv.notify_all();
+    }
+}
+
+void Worker::enqueue_work(std::function<void()> const& functor)
+{
+    enqueue_work(nullptr, functor);
+}
+
+void Worker::enqueue_work(Key key, std::function<void()> const& functor)
+{
+    std::lock_guard<decltype(work_mutex)> lock{work_mutex};
+    work_queue.push_back(Work{key, false, functor});
+    work_cv.notify_one();
+}
+
+void Worker::enqueue_superseding_work(Key key, std::function<void()> const& functor)
+{
+    std::lock_guard<decltype(work_mutex)> lock{work_mutex};
+
+    auto const latest = std::find_if(work_queue.rbegin(), work_queue.rend(),
+        [key](Work const& work) { return work.key == key; });
+
+    if (latest != work_queue.rend() && latest->superseding)
+    {
+        latest->functor = functor;
+        return;
+    }
+
+    work_queue.push_back(Work{key, true, functor});
+    work_cv.notify_one();
+}
+
+void Worker::start_work()
+{
+    // The calling thread works too
+    auto const helpers = std::min(std::max(std::thread::hardware_concurrency(), 2u), 4u) - 1;
+
+    std::vector<std::thread> threads;
+
+    for (auto i = 0u; i != helpers; ++i)
+        threads.emplace_back([this] { do_work(); });
+
+    do_work();
+
+    for (auto& thread : threads)
+        thread.join();
+}
+
+void Worker::stop_work()
+{
+    enqueue_work([this]
+        {
+            std::lock_guard<decltype(work_mutex)> lock{work_mutex};
+            work_done = true;
+        });
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_SHELL_WORKER_H
+#define MIRAL_SHELL_WORKER_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <set>
+
+/// Runs work on a small pool of threads. Work with the same key runs in the order it
+/// was enqueued, while work with different keys may run in parallel. Work without a key
+/// waits for all earlier work to finish, and all later work waits for it.
+class Worker
+{
+public:
+    using Key = void const*;
+
+    ~Worker();
+
+    void start_work();
+    void enqueue_work(std::function<void()> const& functor);
+    void enqueue_work(Key key, std::function<void()> const& functor);
+    /// Like enqueue_work(key, functor), but if the latest work for key is superseding
+    /// work that hasn't started it is replaced (e.g. a repaint that is already stale)
+    void enqueue_superseding_work(Key key, std::function<void()> const& functor);
+    void stop_work();
+
+private:
+    struct Work
+    {
+        Key key;
+        bool superseding;
+        std::function<void()> functor;
+    };
+
+    using WorkQueue = std::deque<Work>;
+
+    std::mutex mutable work_mutex;
+    std::condition_variable work_cv;
+    WorkQueue work_queue;
+    std::set<Key> keys_running;
+    bool unkeyed_running = false;
+    bool work_done = false;
+
+    auto next_runnable_work() -> WorkQueue::iterator;
+    void do_work();
+};
+
+#endif //MIRAL_SHELL_WORKER_H
@@ -17,6 +17,9 @@
  */
 
 #include "basic_window_manager.h"
+#include "latency_histogram.h"
+#include "surface_cache.h"
+#include "miral/geometry_batch_policy.h"
 #include "miral/window_manager_tools.h"
 #include "miral/workspace_policy.h"
 
@@ -26,6 +29,8 @@
 #include <mir/shell/display_layout.h>
 #include <mir/shell/persistent_surface_store.h>
 #include <mir/shell/surface_ready_observer.h>
+#include <mir/time/alarm.h>
+#include <mir/time/alarm_factory.h>
 #include <mir/version.h>
 
 #include <boost/throw_exception.hpp>
@@ -43,29 +48,61 @@ int const title_bar_height = 12;
 struct miral::BasicWindowManager::Locker
 {
     explicit Locker(miral::BasicWindowManager* self);
+    Locker(miral::BasicWindowManager* self, std::adopt_lock_t);
 
     ~Locker()
     {
+        self->commit_geometry();
         policy->advise_end();
+        self->snapshot_publisher.publish(*self);
     }
 
-    std::lock_guard<std::mutex> const lock;
+    std::unique_lock<std::shared_timed_mutex> lock;
+    BasicWindowManager* const self;
     WindowManagementPolicy* const policy;
+
+private:
+    void begin();
 };
 
 miral::BasicWindowManager::Locker::Locker(BasicWindowManager* self) :
-    lock{self->mutex},
+    lock{self->mutex, std::defer_lock},
+    self{self},
+    policy{self->policy.get()}
+{
+    if (auto const lock_wait = self->lock_wait)
+    {
+        LatencyTimer const timer{*lock_wait};
+        lock.lock();
+    }
+    else
+    {
+        lock.lock();
+    }
+
+    begin();
+}
+
+miral::BasicWindowManager::Locker::Locker(BasicWindowManager* self, std::adopt_lock_t) :
+    lock{self->mutex, std::adopt_lock},
+    self{self},
     policy{self->policy.get()}
+{
+    begin();
+}
+
+void miral::BasicWindowManager::Locker::begin()
 {
     policy->advise_begin();
-    std::vector<std::weak_ptr<Workspace>> workspaces;
+    self->geometry_batch->open();
+    std::vector<WorkspaceIndex::Slot> workspaces;
     {
         std::lock_guard<std::mutex> const lock{self->dead_workspaces->dead_workspaces_mutex};
         workspaces.swap(self->dead_workspaces->workspaces);
     }
 
-    for (auto const& workspace : workspaces)
-        self->workspaces_to_windows.left.erase(workspace);
+    for (auto const workspace : workspaces)
+        self->workspace_index.release_slot(workspace);
 }
 
 namespace
@@ -82,6 +119,12 @@ auto find_workspace_policy(std::unique_ptr<miral::WindowManagementPolicy> const&
 
     return &null_workspace_policy;
 }
+
+auto find_geometry_batch_policy(std::unique_ptr<miral::WindowManagementPolicy> const& policy)
+-> miral::GeometryBatchPolicy*
+{
+    return dynamic_cast<miral::GeometryBatchPolicy*>(policy.get());
+}
 }
 
 
@@ -94,21 +137,37 @@ miral::BasicWindowManager::BasicWindowManager(
     display_layout(display_layout),
     persistent_surface_store{persistent_surface_store},
     policy(build(WindowManagerTools{this})),
-    workspace_policy{find_workspace_policy(policy)}
+    workspace_policy{find_workspace_policy(policy)},
+    geometry_batch_policy{find_geometry_batch_policy(policy)}
+{
+}
+
+miral::BasicWindowManager::~BasicWindowManager()
 {
+    // The delivery thread uses the rest of the window manager
+    pointer_motion.stop_delivery();
+}
+
+void miral::BasicWindowManager::record_lock_waits(std::shared_ptr<LatencyHistograms> const& histograms)
+{
+    std::lock_guard<decltype(mutex)> lock{mutex};
+    latency_histograms = histograms;
+    lock_wait = histograms ? &(*histograms)["Locker"] : nullptr;
 }
 
 void miral::BasicWindowManager::add_session(std::shared_ptr<scene::Session> const& session)
 {
     Locker lock{this};
-    policy->advise_new_app(app_info[session] = ApplicationInfo(session));
+    policy->advise_new_app(app_info.emplace(session, session));
+    snapshot_publisher.applications_changed();
 }
 
 void miral::BasicWindowManager::remove_session(std::shared_ptr<scene::Session> const& session)
 {
     Locker lock{this};
-    policy->advise_delete_app(app_info[session]);
+    policy->advise_delete_app(info_for(session));
     app_info.erase(session);
+    snapshot_publisher.applications_changed();
 }
 
 auto miral::BasicWindowManager::add_surface(
@@ -125,8 +184,11 @@ auto miral::BasicWindowManager::add_surface(
     scene::SurfaceCreationParameters parameters;
     spec.update(parameters);
     auto const surface_id = build(session, parameters);
-    Window const window{session, session->surface(surface_id)};
-    auto& window_info = this->window_info.emplace(window, WindowInfo{window, spec}).first->second;
+    auto const surface = session->surface(surface_id);
+    Window const window{session, surface};
+    geometry_batch->adopt(window);
+    SurfaceCache::attach(window);
+    auto& window_info = this->window_info.emplace(surface, window, spec);
 
     if (spec.parent().is_set() && spec.parent().value().lock())
         window_info.parent(info_for(spec.parent().value()).window());
@@ -145,14 +207,21 @@ auto miral::BasicWindowManager::add_surface(
         [&](std::shared_ptr<miral::Workspace> const& workspace) { add_tree_to_workspace(window, workspace); });
 
     if (window_info.state() == mir_window_state_fullscreen)
-        fullscreen_surfaces.insert(window_info.window());
+        index_fullscreen(window_info);
+
+    spatial_index.update(window, {window.top_left(), window.size()});
 
     policy->advise_new_window(window_info);
+    snapshot_publisher.window_changed(window);
 
     std::shared_ptr<scene::Surface> const scene_surface = window_info.window();
     scene_surface->add_observer(std::make_shared<shell::SurfaceReadyObserver>(
         [this, &window_info](std::shared_ptr<scene::Session> const&, std::shared_ptr<scene::Surface> const&)
-            { Locker lock{this}; policy->handle_window_ready(window_info); },
+            {
+                Locker lock{this};
+                SurfaceCache::refresh(window_info.window());
+                policy->handle_window_ready(window_info);
+            },
         session,
         scene_surface));
 
@@ -191,21 +260,25 @@ void miral::BasicWindowManager::remove_surface(
 
 void miral::BasicWindowManager::remove_window(Application const& application, miral::WindowInfo const& info)
 {
+    Window const window{info.window()};
     bool const is_active_window{mru_active_windows.top() == info.window()};
-    auto const workspaces_containing_window = workspaces_containing(info.window());
+    auto const workspaces_containing_window = workspace_index.workspaces_containing(info.window());
 
     {
         std::vector<Window> const windows_removed{info.window()};
 
-        for (auto const& workspace : workspaces_containing_window)
-        {
-            workspace_policy->advise_removing_from_workspace(workspace, windows_removed);
-        }
+        workspace_index.for_each_workspace_in(workspaces_containing_window,
+            [&](std::shared_ptr<Workspace> const& workspace)
+            {
+                workspace_policy->advise_removing_from_workspace(workspace, windows_removed);
+            });
 
-        workspaces_to_windows.right.erase(info.window());
+        workspace_index.erase(info.window());
     }
 
     policy->advise_delete_window(info);
+    snapshot_publisher.window_removed(info.window());
+    spatial_index.erase(info.window());
 
     info_for(application).remove_window(info.window());
     mru_active_windows.erase(info.window());
@@ -221,11 +294,13 @@ void miral::BasicWindowManager::remove_window(Application const& application, mi
     {
         refocus(application, parent, workspaces_containing_window);
     }
+
+    close_deadlines.closed(window);
 }
 
 void miral::BasicWindowManager::refocus(
     miral::Application const& application, miral::Window const& parent,
-    std::vector<std::shared_ptr<Workspace>> const& workspaces_containing_window)
+    WorkspaceSet const& workspaces_containing_window)
 {
     // Try to make the parent active
     if (parent && select_active_window(parent))
@@ -243,16 +318,8 @@ void miral::BasicWindowManager::refocus(
                 // select_active_window() calls set_focus_to() which updates mru_active_windows and changes window
                 auto const w = window;
 
-                for (auto const& workspace : workspaces_containing(w))
-                {
-                    for (auto const& ww : workspaces_containing_window)
-                    {
-                        if (ww == workspace)
-                        {
-                            return !(new_focus = select_active_window(w));
-                        }
-                    }
-                }
+                if (workspace_index.shares_workspace(workspaces_containing_window, w))
+                    return !(new_focus = select_active_window(w));
 
                 return true;
             });
@@ -283,11 +350,19 @@ void miral::BasicWindowManager::refocus(
 
 void miral::BasicWindowManager::erase(miral::WindowInfo const& info)
 {
+    auto const advice = pending_advice_index.find(info.window());
+
+    if (advice != pending_advice_index.end())
+        pending_advice[advice->second] = PendingAdvice{info.window(), false, false};
+
     if (auto const parent = info.parent())
         info_for(parent).remove_child(info.window());
 
     for (auto& child : info.children())
+    {
         info_for(child).parent({});
+        snapshot_publisher.window_changed(child);
+    }
 
     window_info.erase(info.window());
 }
@@ -296,29 +371,26 @@ void miral::BasicWindowManager::add_display(geometry::Rectangle const& area)
 {
     Locker lock{this};
     displays.add(area);
-
-    for (auto window : fullscreen_surfaces)
-    {
-        if (window)
-        {
-            auto& info = info_for(window);
-            auto const rect = fullscreen_rect_for(info);
-            place_and_size(info, rect.top_left, rect.size);
-        }
-    }
+    update_fullscreen_windows_affected_by(area);
 }
 
 void miral::BasicWindowManager::remove_display(geometry::Rectangle const& area)
 {
     Locker lock{this};
     displays.remove(area);
-    for (auto window : fullscreen_surfaces)
+    update_fullscreen_windows_affected_by(area);
+}
+
+void miral::BasicWindowManager::update_fullscreen_windows_affected_by(geometry::Rectangle const& area)
+{
+    for (auto const& window : fullscreen_surfaces.affected_by(area))
     {
         if (window)
         {
             auto& info = info_for(window);
-            auto const rect = fullscreen_rect_for(info);
-            place_and_size(info, rect.top_left, rect.size);
+            auto const placement = fullscreen_placement_for(info);
+            place_and_size(info, placement.rect.top_left, placement.rect.size);
+            fullscreen_surfaces.insert(window, placement.rect, placement.displaced);
         }
     }
 }
@@ -339,7 +411,38 @@ bool miral::BasicWindowManager::handle_touch_event(MirTouchEvent const* event)
 
 bool miral::BasicWindowManager::handle_pointer_event(MirPointerEvent const* event)
 {
+    if (coalescing_pointer_motion && PointerMotionCoalescer::can_coalesce(event))
+    {
+        // If the window manager is busy don't queue up behind it: leave the motion to be
+        // merged with any that follows and delivered by the pointer_motion thread.
+        // (The policy hasn't seen it, so it isn't reported as consumed. That is only safe
+        // because motion with no button held isn't a drag the policy would consume.)
+        if (!mutex.try_lock())
+        {
+            pointer_motion.stash(event);
+            return false;
+        }
+
+        Locker lock{this, std::adopt_lock};
+
+        // Merge with anything waiting, so its relative motion and scroll aren't lost
+        if (auto const merged = pointer_motion.merge(event))
+            return dispatch_pointer_event(mir_input_event_get_pointer_event(mir_event_get_input_event(merged.get())));
+
+        return dispatch_pointer_event(event);
+    }
+
     Locker lock{this};
+
+    // Anything waiting happened before this event
+    if (coalescing_pointer_motion)
+        deliver_coalesced_motion();
+
+    return dispatch_pointer_event(event);
+}
+
+auto miral::BasicWindowManager::dispatch_pointer_event(MirPointerEvent const* event) -> bool
+{
     update_event_timestamp(event);
 
     cursor = {
@@ -349,6 +452,38 @@ bool miral::BasicWindowManager::handle_pointer_event(MirPointerEvent const* even
     return policy->handle_pointer_event(event);
 }
 
+void miral::BasicWindowManager::deliver_coalesced_motion()
+{
+    if (auto const motion = pointer_motion.take())
+        dispatch_pointer_event(mir_input_event_get_pointer_event(mir_event_get_input_event(motion.get())));
+}
+
+void miral::BasicWindowManager::coalesce_pointer_motion(bool enable)
+{
+    auto const was_coalescing = coalescing_pointer_motion.exchange(enable);
+
+    if (enable)
+    {
+        pointer_motion.start_delivery([this]
+            {
+                Locker lock{this};
+                deliver_coalesced_motion();
+            });
+    }
+    else if (was_coalescing)
+    {
+        pointer_motion.stop_delivery();
+
+        Locker lock{this};
+        deliver_coalesced_motion();
+    }
+}
+
+auto miral::BasicWindowManager::coalesced_pointer_motion() const -> std::uint64_t
+{
+    return pointer_motion.dropped();
+}
+
 void miral::BasicWindowManager::handle_raise_surface(
     std::shared_ptr<scene::Session> const& /*application*/,
     std::shared_ptr<scene::Surface> const& surface,
@@ -451,7 +586,7 @@ auto miral::BasicWindowManager::find_application(std::function<bool(ApplicationI
     {
         if (predicate(info.second))
         {
-            return Application{info.first};
+            return info.second.application();
         }
     }
 
@@ -461,13 +596,13 @@ auto miral::BasicWindowManager::find_application(std::function<bool(ApplicationI
 auto miral::BasicWindowManager::info_for(std::weak_ptr<scene::Session> const& session) const
 -> ApplicationInfo&
 {
-    return const_cast<ApplicationInfo&>(app_info.at(session));
+    return app_info.at(session);
 }
 
 auto miral::BasicWindowManager::info_for(std::weak_ptr<scene::Surface> const& surface) const
 -> WindowInfo&
 {
-    return const_cast<WindowInfo&>(window_info.at(surface));
+    return window_info.at(surface);
 }
 
 auto miral::BasicWindowManager::info_for(Window const& window) const
@@ -490,6 +625,62 @@ void miral::BasicWindowManager::force_close(Window const& window)
         remove_window(application, info_for(window));
 }
 
+void miral::BasicWindowManager::close_window(
+    Window const& window, std::chrono::milliseconds timeout, std::function<void(bool forced)> const& on_closed)
+{
+    if (!window)
+    {
+        if (on_closed) on_closed(false);
+        return;
+    }
+
+    close_deadlines.add(window, CloseDeadlines::Clock::now() + timeout, on_closed);
+    ask_client_to_close(window);
+    reschedule_close_alarm();
+}
+
+void miral::BasicWindowManager::enforce_close_deadlines_with(
+    std::shared_ptr<mir::time::AlarmFactory> const& alarm_factory)
+{
+    Locker lock{this};
+    close_alarm = alarm_factory->create_alarm([this] { expire_close_deadlines(); });
+    reschedule_close_alarm();
+}
+
+void miral::BasicWindowManager::expire_close_deadlines()
+{
+    Locker lock{this};
+
+    for (auto const& window : close_deadlines.expire(CloseDeadlines::Clock::now()))
+    {
+        force_close(window);
+
+        // In case the window had already gone without our noticing
+        close_deadlines.closed(window);
+    }
+
+    reschedule_close_alarm();
+}
+
+void miral::BasicWindowManager::reschedule_close_alarm()
+{
+    if (!close_alarm)
+        return;
+
+    auto const deadline = close_deadlines.next_deadline();
+
+    if (!deadline.is_set())
+    {
+        close_alarm->cancel();
+        return;
+    }
+
+    auto const delay = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline.value() - CloseDeadlines::Clock::now());
+
+    close_alarm->reschedule_in(std::max(delay, std::chrono::milliseconds::zero()));
+}
+
 auto miral::BasicWindowManager::active_window() const -> Window
 {
     return mru_active_windows.top();
@@ -499,7 +690,7 @@ void miral::BasicWindowManager::focus_next_application()
 {
     if (auto const prev = active_window())
     {
-        auto const workspaces_containing_window = workspaces_containing(prev);
+        auto const workspaces_containing_window = workspace_index.workspaces_containing(prev);
 
         if (!workspaces_containing_window.empty())
         {
@@ -529,28 +720,11 @@ void miral::BasicWindowManager::focus_next_application()
     select_active_window(focussed_surface ? info_for(focussed_surface).window() : Window{});
 }
 
-auto miral::BasicWindowManager::workspaces_containing(Window const& window) const
--> std::vector<std::shared_ptr<Workspace>>
-{
-    auto const iter_pair = workspaces_to_windows.right.equal_range(window);
-
-    std::vector<std::shared_ptr<Workspace>> workspaces_containing_window;
-    for (auto kv = iter_pair.first; kv != iter_pair.second; ++kv)
-    {
-        if (auto const workspace = kv->second.lock())
-        {
-            workspaces_containing_window.push_back(workspace);
-        }
-    }
-
-    return workspaces_containing_window;
-}
-
 void miral::BasicWindowManager::focus_next_within_application()
 {
     if (auto const prev = active_window())
     {
-        auto const workspaces_containing_window = workspaces_containing(prev);
+        auto const workspaces_containing_window = workspace_index.workspaces_containing(prev);
         auto const& siblings = info_for(prev.application()).windows();
         auto current = find(begin(siblings), end(siblings), prev);
 
@@ -558,32 +732,20 @@ void miral::BasicWindowManager::focus_next_within_application()
         {
             while (++current != end(siblings))
             {
-                for (auto const& workspace : workspaces_containing(*current))
+                if (workspace_index.shares_workspace(workspaces_containing_window, *current))
                 {
-                    for (auto const& ww : workspaces_containing_window)
-                    {
-                        if (ww == workspace)
-                        {
-                            if (prev != select_active_window(*current))
-                                return;
-                        }
-                    }
+                    if (prev != select_active_window(*current))
+                        return;
                 }
             }
         }
 
         for (current = begin(siblings); *current != prev; ++current)
         {
-            for (auto const& workspace : workspaces_containing(*current))
+            if (workspace_index.shares_workspace(workspaces_containing_window, *current))
             {
-                for (auto const& ww : workspaces_containing_window)
-                {
-                    if (ww == workspace)
-                    {
-                        if (prev != select_active_window(*current))
-                            return;
-                    }
-                }
+                if (prev != select_active_window(*current))
+                    return;
             }
         }
 
@@ -607,7 +769,7 @@ void miral::BasicWindowManager::focus_prev_within_application()
 {
     if (auto const prev = active_window())
     {
-        auto const workspaces_containing_window = workspaces_containing(prev);
+        auto const workspaces_containing_window = workspace_index.workspaces_containing(prev);
         auto const& siblings = info_for(prev.application()).windows();
         auto current = find(rbegin(siblings), rend(siblings), prev);
 
@@ -615,32 +777,20 @@ void miral::BasicWindowManager::focus_prev_within_application()
         {
             while (++current != rend(siblings))
             {
-                for (auto const& workspace : workspaces_containing(*current))
+                if (workspace_index.shares_workspace(workspaces_containing_window, *current))
                 {
-                    for (auto const& ww : workspaces_containing_window)
-                    {
-                        if (ww == workspace)
-                        {
-                            if (prev != select_active_window(*current))
-                                return;
-                        }
-                    }
+                    if (prev != select_active_window(*current))
+                        return;
                 }
             }
         }
 
         for (current = rbegin(siblings); *current != prev; ++current)
         {
-            for (auto const& workspace : workspaces_containing(*current))
+            if (workspace_index.shares_workspace(workspaces_containing_window, *current))
             {
-                for (auto const& ww : workspaces_containing_window)
-                {
-                    if (ww == workspace)
-                    {
-                        if (prev != select_active_window(*current))
-                            return;
-                    }
-                }
+                if (prev != select_active_window(*current))
+                    return;
             }
         }
 
@@ -663,10 +813,27 @@ void miral::BasicWindowManager::focus_prev_within_application()
 auto miral::BasicWindowManager::window_at(geometry::Point cursor) const
 -> Window
 {
+    // The scene answers this, so it needs the geometry of the current transaction
+    geometry_batch->apply_pending();
+
     auto surface_at = focus_controller->surface_at(cursor);
     return surface_at ? info_for(surface_at).window() : Window{};
 }
 
+auto miral::BasicWindowManager::windows_at(geometry::Point point) const
+-> std::vector<Window>
+{
+    index_changed_geometry();
+    return spatial_index.windows_at(point);
+}
+
+auto miral::BasicWindowManager::windows_in(geometry::Rectangle const& area) const
+-> std::vector<Window>
+{
+    index_changed_geometry();
+    return spatial_index.windows_in(area);
+}
+
 auto miral::BasicWindowManager::active_display()
 -> geometry::Rectangle const
 {
@@ -676,6 +843,8 @@ auto miral::BasicWindowManager::active_display()
     //    proportion of the area of that window.
     if (auto const surface = focus_controller->focused_surface())
     {
+        geometry_batch->apply_pending();
+
         auto const surface_rect = surface->input_bounds();
         int max_overlap_area = -1;
 
@@ -715,27 +884,48 @@ auto miral::BasicWindowManager::active_display()
     return result;
 }
 
+template<typename Visitor>
+void miral::BasicWindowManager::for_each_in_tree(WindowInfo& root, Visitor const& visit)
+{
+    if (!visit(root, 0) || root.children().empty())
+        return;
+
+    // A preorder walk without recursion: each entry is a window whose children are
+    // being visited and the index of the next child to visit.
+    std::vector<std::pair<WindowInfo*, std::size_t>> stack{{&root, 0}};
+
+    while (!stack.empty())
+    {
+        auto const& children = stack.back().first->children();
+        auto const next = stack.back().second++;
+
+        if (next == children.size())
+        {
+            stack.pop_back();
+            continue;
+        }
+
+        auto& info = info_for(children[next]);
+
+        if (visit(info, stack.size()) && !info.children().empty())
+            stack.emplace_back(&info, 0);
+    }
+}
+
 void miral::BasicWindowManager::raise_tree(Window const& root)
 {
-    auto const& info = info_for(root);
+    auto& info = info_for(root);
 
     if (auto parent = info.parent())
         raise_tree(parent);
 
     std::vector<Window> windows;
 
-    std::function<void(WindowInfo const& info)> const add_children =
-        [&,this](WindowInfo const& info)
-            {
-                for (auto const& child : info.children())
-                {
-                    windows.push_back(child);
-                    add_children(info_for(child));
-                }
-            };
-
-    windows.push_back(root);
-    add_children(info);
+    for_each_in_tree(info, [&](WindowInfo& info, unsigned)
+        {
+            windows.push_back(info.window());
+            return true;
+        });
 
     policy->advise_raise(windows);
     focus_controller->raise({begin(windows), end(windows)});
@@ -746,20 +936,41 @@ void miral::BasicWindowManager::move_tree(miral::WindowInfo& root, mir::geometry
     if (movement == mir::geometry::Displacement{})
         return;
 
-    auto const top_left = root.window().top_left() + movement;
+    move_window(root, root.window().top_left() + movement);
 
-    policy->advise_move_to(root, top_left);
-    root.window().move_to(top_left);
+    if (root.children().empty())
+        return;
 
-    for (auto const& child: root.children())
-    {
-        auto const& pos = policy->confirm_inherited_move(info_for(child), movement);
-        place_and_size(info_for(child), pos.top_left, pos.size);
-    }
+    // movements[depth] is the movement of the window last visited at that depth (i.e. the current parent)
+    std::vector<Displacement> movements{movement};
+
+    for_each_in_tree(root, [&](WindowInfo& info, unsigned depth)
+        {
+            if (depth == 0)
+                return true;
+
+            auto const& pos = policy->confirm_inherited_move(info, movements[depth-1]);
+
+            if (info.window().size() != pos.size)
+                resize_window(info, pos.size);
+
+            auto const inherited_movement = pos.top_left - info.window().top_left();
+
+            if (inherited_movement == Displacement{})
+                return false;
+
+            move_window(info, pos.top_left);
+
+            movements.resize(depth);
+            movements.push_back(inherited_movement);
+            return true;
+        });
 }
 
 void miral::BasicWindowManager::modify_window(WindowInfo& window_info, WindowSpecification const& modifications)
 {
+    snapshot_publisher.window_changed(window_info.window());
+
     WindowInfo window_info_tmp{window_info};
 
 #define COPY_IF_SET(field)\
@@ -949,12 +1160,147 @@ auto miral::BasicWindowManager::id_for_window(Window const& window) const -> std
 void miral::BasicWindowManager::place_and_size(WindowInfo& root, Point const& new_pos, Size const& new_size)
 {
     if (root.window().size() != new_size)
+        resize_window(root, new_size);
+
+    move_tree(root, new_pos - root.window().top_left());
+}
+
+void miral::BasicWindowManager::move_window(WindowInfo& info, Point top_left)
+{
+    if (geometry_batch->is_open())
     {
-        policy->advise_resize(root, new_size);
-        root.window().resize(new_size);
+        // Held (and reported by the window) until the transaction commits
+        pending_advice_for(info.window()).moved = true;
+        geometry_batch->move(info.window(), top_left);
     }
+    else
+    {
+        if (geometry_batch_policy)
+            geometry_batch_policy->advise_geometry_batch({GeometryChange{info.window(), top_left, {}}});
+        else
+            policy->advise_move_to(info, top_left);
 
-    move_tree(root, new_pos - root.window().top_left());
+        GeometryBatch::apply(info.window(), GeometryBatch::Change{{}, top_left});
+    }
+
+    snapshot_publisher.window_changed(info.window());
+    spatial_index.update(info.window(), {top_left, info.window().size()});
+}
+
+void miral::BasicWindowManager::resize_window(WindowInfo& info, Size size)
+{
+    if (geometry_batch->is_open())
+    {
+        // Held (and reported by the window) until the transaction commits
+        pending_advice_for(info.window()).resized = true;
+        geometry_batch->resize(info.window(), size);
+    }
+    else
+    {
+        if (geometry_batch_policy)
+            geometry_batch_policy->advise_geometry_batch({GeometryChange{info.window(), {}, size}});
+        else
+            policy->advise_resize(info, size);
+
+        GeometryBatch::apply(info.window(), GeometryBatch::Change{size, {}});
+    }
+
+    snapshot_publisher.window_changed(info.window());
+    spatial_index.update(info.window(), {info.window().top_left(), size});
+}
+
+auto miral::BasicWindowManager::pending_advice_for(Window const& window) -> PendingAdvice&
+{
+    auto const i = pending_advice_index.find(window);
+
+    if (i != pending_advice_index.end())
+        return pending_advice[i->second];
+
+    pending_advice_index[window] = pending_advice.size();
+    pending_advice.push_back(PendingAdvice{window, false, false});
+    return pending_advice.back();
+}
+
+void miral::BasicWindowManager::commit_geometry()
+{
+    // Advising the policy may lead to further changes, which are advised in turn
+    while (!pending_advice.empty())
+    {
+        std::vector<PendingAdvice> advice;
+        advice.swap(pending_advice);
+        pending_advice_index.clear();
+
+        if (geometry_batch_policy)
+        {
+            advise_geometry_batch(advice);
+            continue;
+        }
+
+        for (auto const& pending : advice)
+        {
+            if (!pending.resized && !pending.moved)
+                continue;
+
+            auto& info = info_for(pending.window);
+
+            // As without batching, the policy is advised while the window still has its old geometry
+            auto const change = geometry_batch->take(pending.window);
+
+            if (pending.resized && change.size.is_set())
+                policy->advise_resize(info, change.size.value());
+
+            if (pending.moved && change.top_left.is_set())
+                policy->advise_move_to(info, change.top_left.value());
+
+            GeometryBatch::apply(pending.window, change);
+        }
+    }
+
+    index_changed_geometry();
+    geometry_batch->commit();
+}
+
+void miral::BasicWindowManager::index_changed_geometry() const
+{
+    // The windows BasicWindowManager changes are indexed as it changes them, this catches
+    // those the policy (or anything else) has moved or resized directly through Window.
+    // (Under a shared lock no batch is open and the index isn't modified: they wait for the
+    // next transaction.)
+    if (!geometry_batch->is_open())
+        return;
+
+    for (auto const& window : geometry_batch->take_changed_directly())
+        spatial_index.refresh(window, {window.top_left(), window.size()});
+}
+
+void miral::BasicWindowManager::advise_geometry_batch(std::vector<PendingAdvice> const& advice)
+{
+    std::vector<GeometryChange> changes;
+    std::vector<GeometryBatch::Change> taken;
+    changes.reserve(advice.size());
+    taken.reserve(advice.size());
+
+    for (auto const& pending : advice)
+    {
+        if (!pending.resized && !pending.moved)
+            continue;
+
+        taken.push_back(geometry_batch->take(pending.window));
+
+        changes.push_back(GeometryChange{
+            pending.window,
+            pending.moved ? taken.back().top_left : mir::optional_value<Point>{},
+            pending.resized ? taken.back().size : mir::optional_value<Size>{}});
+    }
+
+    if (changes.empty())
+        return;
+
+    // As without batching, the policy is advised while the windows still have their old geometry
+    geometry_batch_policy->advise_geometry_batch(changes);
+
+    for (auto i = 0u; i != changes.size(); ++i)
+        GeometryBatch::apply(changes[i].window, taken[i]);
 }
 
 void miral::BasicWindowManager::place_and_size_for_state(
@@ -1056,6 +1402,12 @@ void miral::BasicWindowManager::place_and_size_for_state(
 }
 
 auto miral::BasicWindowManager::fullscreen_rect_for(miral::WindowInfo const& window_info) const -> Rectangle
+{
+    return fullscreen_placement_for(window_info).rect;
+}
+
+auto miral::BasicWindowManager::fullscreen_placement_for(miral::WindowInfo const& window_info) const
+-> FullscreenPlacement
 {
     auto const w = window_info.window();
     Rectangle r = {(w.top_left()), w.size()};
@@ -1064,12 +1416,21 @@ auto miral::BasicWindowManager::fullscreen_rect_for(miral::WindowInfo const& win
     {
         graphics::DisplayConfigurationOutputId id{window_info.output_id()};
         if (display_layout->place_in_output(id, r))
-            return r;
+            return {r, false};
+
+        display_layout->size_to_output(r);
+        return {r, true};
     }
 
     display_layout->size_to_output(r);
 
-    return r;
+    return {r, false};
+}
+
+void miral::BasicWindowManager::index_fullscreen(miral::WindowInfo const& window_info)
+{
+    auto const placement = fullscreen_placement_for(window_info);
+    fullscreen_surfaces.insert(window_info.window(), placement.rect, placement.displaced);
 }
 
 void miral::BasicWindowManager::set_state(miral::WindowInfo& window_info, MirWindowState value)
@@ -1083,7 +1444,7 @@ void miral::BasicWindowManager::set_state(miral::WindowInfo& window_info, MirWin
     }
     else
     {
-        fullscreen_surfaces.insert(window);
+        index_fullscreen(window_info);
     }
 
     if (window_info.state() == value)
@@ -1095,6 +1456,7 @@ void miral::BasicWindowManager::set_state(miral::WindowInfo& window_info, MirWin
                             window_info.state() == mir_window_state_minimized;
 
     policy->advise_state_change(window_info, value);
+    snapshot_publisher.window_changed(window);
 
     switch (value)
     {
@@ -1107,7 +1469,7 @@ void miral::BasicWindowManager::set_state(miral::WindowInfo& window_info, MirWin
 
             if (window == active_window() || !active_window())
             {
-                auto const workspaces_containing_window = workspaces_containing(window);
+                auto const workspaces_containing_window = workspace_index.workspaces_containing(window);
 
                 // Try to activate to recently active window of any application
                 mru_active_windows.enumerate([&](Window& candidate)
@@ -1115,16 +1477,8 @@ void miral::BasicWindowManager::set_state(miral::WindowInfo& window_info, MirWin
                         if (candidate == window)
                             return true;
                         auto const w = candidate;
-                        for (auto const& workspace : workspaces_containing(w))
-                        {
-                            for (auto const& ww : workspaces_containing_window)
-                            {
-                                if (ww == workspace)
-                                {
-                                    return !(select_active_window(w));
-                                }
-                            }
-                        }
+                        if (workspace_index.shares_workspace(workspaces_containing_window, w))
+                            return !(select_active_window(w));
 
                         return true;
                     });
@@ -1146,6 +1500,7 @@ void miral::BasicWindowManager::set_state(miral::WindowInfo& window_info, MirWin
 
         mir_surface->configure(mir_window_attrib_state, value);
         mir_surface->hide();
+        SurfaceCache::refresh(window);
 
         break;
 
@@ -1154,6 +1509,7 @@ void miral::BasicWindowManager::set_state(miral::WindowInfo& window_info, MirWin
         window_info.state(value);
         mir_surface->configure(mir_window_attrib_state, value);
         mir_surface->show();
+        SurfaceCache::refresh(window);
         if (was_hidden && none_active)
         {
             select_active_window(window);
@@ -1201,6 +1557,18 @@ void miral::BasicWindowManager::invoke_under_lock(std::function<void()> const& c
     callback();
 }
 
+auto miral::BasicWindowManager::scene_snapshot() const -> std::shared_ptr<SceneSnapshot const>
+{
+    return snapshot_publisher.snapshot();
+}
+
+void miral::BasicWindowManager::invoke_under_shared_lock(std::function<void()> const& callback)
+{
+    // Readers don't change the model, so there's no need to advise the policy or sweep dead workspaces
+    std::shared_lock<std::shared_timed_mutex> const lock{mutex};
+    callback();
+}
+
 auto miral::BasicWindowManager::select_active_window(Window const& hint) -> miral::Window
 {
     auto const prev_window = active_window();
@@ -1329,7 +1697,7 @@ auto miral::BasicWindowManager::can_activate_window_for_session(miral::Applicati
 
 auto miral::BasicWindowManager::can_activate_window_for_session_in_workspace(
     Application const& session,
-    std::vector<std::shared_ptr<Workspace>> const& workspaces) -> bool
+    WorkspaceSet const& workspaces) -> bool
 {
     miral::Window new_focus;
 
@@ -1341,14 +1709,8 @@ auto miral::BasicWindowManager::can_activate_window_for_session_in_workspace(
             if (w.application() != session)
                 return true;
 
-            for (auto const& workspace : workspaces_containing(w))
-            {
-                for (auto const& ww : workspaces)
-                {
-                    if (ww == workspace)
-                        return !(new_focus = select_active_window(w));
-                }
-            }
+            if (workspace_index.shares_workspace(workspaces, w))
+                return !(new_focus = select_active_window(w));
 
             return true;
         });
@@ -1477,329 +1839,22 @@ auto miral::BasicWindowManager::place_new_surface(ApplicationInfo const& app_inf
     return parameters;
 }
 
-namespace
-{
-auto flip_x(MirPlacementGravity rect_gravity) -> MirPlacementGravity
-{
-    switch (rect_gravity)
-    {
-    case mir_placement_gravity_northwest:
-        return mir_placement_gravity_northeast;
-
-    case mir_placement_gravity_northeast:
-        return mir_placement_gravity_northwest;
-
-    case mir_placement_gravity_west:
-        return mir_placement_gravity_east;
-
-    case mir_placement_gravity_east:
-        return mir_placement_gravity_west;
-
-    case mir_placement_gravity_southwest:
-        return mir_placement_gravity_southeast;
-
-    case mir_placement_gravity_southeast:
-        return mir_placement_gravity_southwest;
-
-    default:
-        return rect_gravity;
-    }
-}
-
-auto flip_y(MirPlacementGravity rect_gravity) -> MirPlacementGravity
-{
-    switch (rect_gravity)
-    {
-    case mir_placement_gravity_northwest:
-        return mir_placement_gravity_southwest;
-
-    case mir_placement_gravity_north:
-        return mir_placement_gravity_south;
-
-    case mir_placement_gravity_northeast:
-        return mir_placement_gravity_southeast;
-
-    case mir_placement_gravity_southwest:
-        return mir_placement_gravity_northwest;
-
-    case mir_placement_gravity_south:
-        return mir_placement_gravity_north;
-
-    case mir_placement_gravity_southeast:
-        return mir_placement_gravity_northeast;
-
-    default:
-        return rect_gravity;
-    }
-}
-
-auto flip_x(Displacement const& d) -> Displacement { return {-1*d.dx, d.dy}; }
-auto flip_y(Displacement const& d) -> Displacement { return {d.dx, -1*d.dy}; }
-
-auto antipodes(MirPlacementGravity rect_gravity) -> MirPlacementGravity
-{
-    switch (rect_gravity)
-    {
-    case mir_placement_gravity_northwest:
-        return mir_placement_gravity_southeast;
-
-    case mir_placement_gravity_north:
-        return mir_placement_gravity_south;
-
-    case mir_placement_gravity_northeast:
-        return mir_placement_gravity_southwest;
-
-    case mir_placement_gravity_west:
-        return mir_placement_gravity_east;
-
-    case mir_placement_gravity_east:
-        return mir_placement_gravity_west;
-
-    case mir_placement_gravity_southwest:
-        return mir_placement_gravity_northeast;
-
-    case mir_placement_gravity_south:
-        return mir_placement_gravity_north;
-
-    case mir_placement_gravity_southeast:
-        return mir_placement_gravity_northwest;
-
-    default:
-        return rect_gravity;
-    }
-}
-
-auto constrain_to(mir::geometry::Rectangle const& rect, Point point) -> Point
-{
-    if (point.x < rect.top_left.x)
-        point.x = rect.top_left.x;
-
-    if (point.y < rect.top_left.y)
-        point.y = rect.top_left.y;
-
-    if (point.x > rect.bottom_right().x)
-        point.x = rect.bottom_right().x;
-
-    if (point.y > rect.bottom_right().y)
-        point.y = rect.bottom_right().y;
-
-    return point;
-}
-
-auto anchor_for(Rectangle const& aux_rect, MirPlacementGravity rect_gravity) -> Point
-{
-    switch (rect_gravity)
-    {
-    case mir_placement_gravity_northwest:
-        return aux_rect.top_left;
-
-    case mir_placement_gravity_north:
-        return aux_rect.top_left + 0.5*as_displacement(aux_rect.size).dx;
-
-    case mir_placement_gravity_northeast:
-        return aux_rect.top_right();
-
-    case mir_placement_gravity_west:
-        return aux_rect.top_left + 0.5*as_displacement(aux_rect.size).dy;
-
-    case mir_placement_gravity_center:
-        return aux_rect.top_left + 0.5*as_displacement(aux_rect.size);
-
-    case mir_placement_gravity_east:
-        return aux_rect.top_right() + 0.5*as_displacement(aux_rect.size).dy;
-
-    case mir_placement_gravity_southwest:
-        return aux_rect.bottom_left();
-
-    case mir_placement_gravity_south:
-        return aux_rect.bottom_left() + 0.5*as_displacement(aux_rect.size).dx;
-
-    case mir_placement_gravity_southeast:
-        return aux_rect.bottom_right();
-
-    default:
-        BOOST_THROW_EXCEPTION(std::runtime_error("bad placement gravity"));
-    }
-}
-
-auto offset_for(Size const& size, MirPlacementGravity rect_gravity) -> Displacement
-{
-    auto const displacement = as_displacement(size);
-
-    switch (rect_gravity)
-    {
-    case mir_placement_gravity_northwest:
-        return {0, 0};
-
-    case mir_placement_gravity_north:
-        return {-0.5 * displacement.dx, 0};
-
-    case mir_placement_gravity_northeast:
-        return {-1 * displacement.dx, 0};
-
-    case mir_placement_gravity_west:
-        return {0, -0.5 * displacement.dy};
-
-    case mir_placement_gravity_center:
-        return {-0.5 * displacement.dx, -0.5 * displacement.dy};
-
-    case mir_placement_gravity_east:
-        return {-1 * displacement.dx, -0.5 * displacement.dy};
-
-    case mir_placement_gravity_southwest:
-        return {0, -1 * displacement.dy};
-
-    case mir_placement_gravity_south:
-        return {-0.5 * displacement.dx, -1 * displacement.dy};
-
-    case mir_placement_gravity_southeast:
-        return {-1 * displacement.dx, -1 * displacement.dy};
-
-    default:
-        BOOST_THROW_EXCEPTION(std::runtime_error("bad placement gravity"));
-    }
-}
-}
-
 auto miral::BasicWindowManager::place_relative(mir::geometry::Rectangle const& parent, WindowSpecification const& parameters, Size size)
 -> mir::optional_value<Rectangle>
 {
-    auto const hints = parameters.placement_hints().value();
-    auto const active_display_area = active_display();
-    auto const win_gravity = parameters.window_placement_gravity().value();
-
-    if (parameters.size().is_set())
-        size = parameters.size().value();
-
-    auto offset = parameters.aux_rect_placement_offset().is_set() ?
-                  parameters.aux_rect_placement_offset().value() : Displacement{};
-
-    Rectangle aux_rect = parameters.aux_rect().value();
-    aux_rect.top_left = aux_rect.top_left + (parent.top_left-Point{});
-
-    std::vector<MirPlacementGravity> rect_gravities{parameters.aux_rect_placement_gravity().value()};
-
-    if (hints & mir_placement_hints_antipodes)
-        rect_gravities.push_back(antipodes(parameters.aux_rect_placement_gravity().value()));
-
-    mir::optional_value<Rectangle> default_result;
-
-    for (auto const& rect_gravity : rect_gravities)
-    {
-        {
-            auto result = constrain_to(parent, anchor_for(aux_rect, rect_gravity) + offset) +
-                offset_for(size, win_gravity);
-
-            if (active_display_area.contains(Rectangle{result, size}))
-                return Rectangle{result, size};
-
-            if (!default_result.is_set())
-                default_result = Rectangle{result, size};
-        }
-
-        if (hints & mir_placement_hints_flip_x)
-        {
-            auto result = constrain_to(parent, anchor_for(aux_rect, flip_x(rect_gravity)) + flip_x(offset)) +
-                offset_for(size, flip_x(win_gravity));
-
-            if (active_display_area.contains(Rectangle{result, size}))
-                return Rectangle{result, size};
-        }
-
-        if (hints & mir_placement_hints_flip_y)
-        {
-            auto result = constrain_to(parent, anchor_for(aux_rect, flip_y(rect_gravity)) + flip_y(offset)) +
-                offset_for(size, flip_y(win_gravity));
-
-            if (active_display_area.contains(Rectangle{result, size}))
-                return Rectangle{result, size};
-        }
-
-        if (hints & mir_placement_hints_flip_x && hints & mir_placement_hints_flip_y)
-        {
-            auto result = constrain_to(parent, anchor_for(aux_rect, flip_x(flip_y(rect_gravity))) + flip_x(flip_y(offset))) +
-                offset_for(size, flip_x(flip_y(win_gravity)));
-
-            if (active_display_area.contains(Rectangle{result, size}))
-                return Rectangle{result, size};
-        }
-    }
-
-    for (auto const& rect_gravity : rect_gravities)
-    {
-        auto result = constrain_to(parent, anchor_for(aux_rect, rect_gravity) + offset) +
-            offset_for(size, win_gravity);
-
-        if (hints & mir_placement_hints_slide_x)
-        {
-            auto const left_overhang  = result.x - active_display_area.top_left.x;
-            auto const right_overhang = (result + as_displacement(size)).x - active_display_area.top_right().x;
-
-            if (left_overhang < DeltaX{0})
-                result -= left_overhang;
-            else if (right_overhang > DeltaX{0})
-                result -= right_overhang;
-        }
-
-        if (hints & mir_placement_hints_slide_y)
-        {
-            auto const top_overhang  = result.y - active_display_area.top_left.y;
-            auto const bot_overhang = (result + as_displacement(size)).y - active_display_area.bottom_left().y;
-
-            if (top_overhang < DeltaY{0})
-                result -= top_overhang;
-            else if (bot_overhang > DeltaY{0})
-                result -= bot_overhang;
-        }
-
-        if (active_display_area.contains(Rectangle{result, size}))
-            return Rectangle{result, size};
-    }
-
-    for (auto const& rect_gravity : rect_gravities)
-    {
-        auto result = constrain_to(parent, anchor_for(aux_rect, rect_gravity) + offset) +
-            offset_for(size, win_gravity);
+    PlacementSolver::Request request;
 
-        if (hints & mir_placement_hints_resize_x)
-        {
-            auto const left_overhang  = result.x - active_display_area.top_left.x;
-            auto const right_overhang = (result + as_displacement(size)).x - active_display_area.top_right().x;
-
-            if (left_overhang < DeltaX{0})
-            {
-                result -= left_overhang;
-                size = Size{size.width + left_overhang, size.height};
-            }
-
-            if (right_overhang > DeltaX{0})
-            {
-                size = Size{size.width - right_overhang, size.height};
-            }
-        }
-
-        if (hints & mir_placement_hints_resize_y)
-        {
-            auto const top_overhang  = result.y - active_display_area.top_left.y;
-            auto const bot_overhang = (result + as_displacement(size)).y - active_display_area.bottom_left().y;
+    request.parent = parent;
+    request.aux_rect = parameters.aux_rect().value();
+    request.offset = parameters.aux_rect_placement_offset().is_set() ?
+                     parameters.aux_rect_placement_offset().value() : Displacement{};
+    request.rect_gravity = parameters.aux_rect_placement_gravity().value();
+    request.window_gravity = parameters.window_placement_gravity().value();
+    request.hints = parameters.placement_hints().value();
+    request.size = parameters.size().is_set() ? parameters.size().value() : size;
+    request.display = active_display();
 
-            if (top_overhang < DeltaY{0})
-            {
-                result -= top_overhang;
-                size = Size{size.width, size.height + top_overhang};
-            }
-
-            if (bot_overhang > DeltaY{0})
-            {
-                size = Size{size.width, size.height - bot_overhang};
-            }
-        }
-
-        if (active_display_area.contains(Rectangle{result, size}))
-            return Rectangle{result, size};
-    }
-
-    return default_result;
+    return placement_solver.place(request);
 }
 
 void miral::BasicWindowManager::validate_modification_request(WindowSpecification const& modifications, WindowInfo const& window_info) const
@@ -1894,15 +1949,17 @@ void miral::BasicWindowManager::validate_modification_request(WindowSpecificatio
 class miral::Workspace
 {
 public:
-    explicit Workspace(std::shared_ptr<miral::BasicWindowManager::DeadWorkspaces> const& dead_workspaces) :
-        dead_workspaces{dead_workspaces} {}
+    Workspace(
+        std::shared_ptr<miral::BasicWindowManager::DeadWorkspaces> const& dead_workspaces,
+        miral::WorkspaceIndex::Slot slot) :
+        slot{slot}, dead_workspaces{dead_workspaces} {}
 
-    std::weak_ptr<Workspace> self;
+    miral::WorkspaceIndex::Slot const slot;
 
     ~Workspace()
     {
         std::lock_guard<std::mutex> lock {dead_workspaces->dead_workspaces_mutex};
-        dead_workspaces->workspaces.push_back(self);
+        dead_workspaces->workspaces.push_back(slot);
     }
 
 private:
@@ -1911,8 +1968,8 @@ private:
 
 auto miral::BasicWindowManager::create_workspace() -> std::shared_ptr<Workspace>
 {
-    auto const result = std::make_shared<Workspace>(dead_workspaces);
-    result->self = result;
+    auto const result = std::make_shared<Workspace>(dead_workspaces, workspace_index.allocate_slot());
+    workspace_index.attach(result->slot, result);
     return result;
 }
 
@@ -1922,7 +1979,7 @@ void miral::BasicWindowManager::add_tree_to_workspace(
     if (!window) return;
 
     auto root = window;
-    auto const* info = &info_for(root);
+    auto* info = &info_for(root);
 
     while (auto const& parent = info->parent())
     {
@@ -1930,34 +1987,14 @@ void miral::BasicWindowManager::add_tree_to_workspace(
         info = &info_for(root);
     }
 
-    std::vector<Window> windows;
-
-    std::function<void(WindowInfo const& info)> const add_children =
-        [&,this](WindowInfo const& info)
-        {
-            for (auto const& child : info.children())
-            {
-                windows.push_back(child);
-                add_children(info_for(child));
-            }
-        };
-
-    windows.push_back(root);
-    add_children(*info);
-
-    auto const iter_pair = workspaces_to_windows.left.equal_range(workspace);
-
     std::vector<Window> windows_added;
 
-    for (auto& w : windows)
-    {
-        if (!std::count_if(iter_pair.first, iter_pair.second,
-                           [&w](wwbimap_t::left_value_type const& kv) { return kv.second == w; }))
+    for_each_in_tree(*info, [&](WindowInfo& info, unsigned)
         {
-            workspaces_to_windows.left.insert(wwbimap_t::left_value_type{workspace, w});
-            windows_added.push_back(w);
-        }
-    }
+            if (workspace_index.insert(workspace->slot, info.window()))
+                windows_added.push_back(info.window());
+            return true;
+        });
 
     if (!windows_added.empty())
         workspace_policy->advise_adding_to_workspace(workspace, windows_added);
@@ -1969,7 +2006,7 @@ void miral::BasicWindowManager::remove_tree_from_workspace(
     if (!window) return;
 
     auto root = window;
-    auto const* info = &info_for(root);
+    auto* info = &info_for(root);
 
     while (auto const& parent = info->parent())
     {
@@ -1977,33 +2014,14 @@ void miral::BasicWindowManager::remove_tree_from_workspace(
         info = &info_for(root);
     }
 
-    std::vector<Window> windows;
-
-    std::function<void(WindowInfo const& info)> const add_children =
-        [&,this](WindowInfo const& info)
-        {
-            for (auto const& child : info.children())
-            {
-                windows.push_back(child);
-                add_children(info_for(child));
-            }
-        };
-
-    windows.push_back(root);
-    add_children(*info);
-
     std::vector<Window> windows_removed;
 
-    auto const iter_pair = workspaces_to_windows.left.equal_range(workspace);
-    for (auto kv = iter_pair.first; kv != iter_pair.second;)
-    {
-        auto const current = kv++;
-        if (std::count(begin(windows), end(windows), current->second))
+    for_each_in_tree(*info, [&](WindowInfo& info, unsigned)
         {
-            windows_removed.push_back(current->second);
-            workspaces_to_windows.left.erase(current);
-        }
-    }
+            if (workspace_index.erase(workspace->slot, info.window()))
+                windows_removed.push_back(info.window());
+            return true;
+        });
 
     if (!windows_removed.empty())
         workspace_policy->advise_removing_from_workspace(workspace, windows_removed);
@@ -2012,30 +2030,17 @@ void miral::BasicWindowManager::remove_tree_from_workspace(
 void miral::BasicWindowManager::move_workspace_content_to_workspace(
     std::shared_ptr<Workspace> const& to_workspace, std::shared_ptr<Workspace> const& from_workspace)
 {
-    std::vector<Window> windows_removed;
-
-    auto const iter_pair_from = workspaces_to_windows.left.equal_range(from_workspace);
-    for (auto kv = iter_pair_from.first; kv != iter_pair_from.second;)
-    {
-        auto const current = kv++;
-        windows_removed.push_back(current->second);
-        workspaces_to_windows.left.erase(current);
-    }
+    auto const windows_removed = workspace_index.clear(from_workspace->slot);
 
     if (!windows_removed.empty())
         workspace_policy->advise_removing_from_workspace(from_workspace, windows_removed);
 
     std::vector<Window> windows_added;
 
-    auto const iter_pair_to = workspaces_to_windows.left.equal_range(to_workspace);
     for (auto& w : windows_removed)
     {
-        if (!std::count_if(iter_pair_to.first, iter_pair_to.second,
-                           [&w](wwbimap_t::left_value_type const& kv) { return kv.second == w; }))
-        {
-            workspaces_to_windows.left.insert(wwbimap_t::left_value_type{to_workspace, w});
+        if (workspace_index.insert(to_workspace->slot, w))
             windows_added.push_back(w);
-        }
     }
 
     if (!windows_added.empty())
@@ -2045,18 +2050,13 @@ void miral::BasicWindowManager::move_workspace_content_to_workspace(
 void miral::BasicWindowManager::for_each_workspace_containing(
     miral::Window const& window, std::function<void(std::shared_ptr<miral::Workspace> const&)> const& callback)
 {
-    auto const iter_pair = workspaces_to_windows.right.equal_range(window);
-    for (auto kv = iter_pair.first; kv != iter_pair.second; ++kv)
-    {
-        if (auto const workspace = kv->second.lock())
-            callback(workspace);
-    }
+    auto const workspaces_containing_window = workspace_index.workspaces_containing(window);
+    workspace_index.for_each_workspace_in(workspaces_containing_window, callback);
 }
 
 void miral::BasicWindowManager::for_each_window_in_workspace(
     std::shared_ptr<miral::Workspace> const& workspace, std::function<void(miral::Window const&)> const& callback)
 {
-    auto const iter_pair = workspaces_to_windows.left.equal_range(workspace);
-    for (auto kv = iter_pair.first; kv != iter_pair.second; ++kv)
-        callback(kv->second);
+    for (auto const& window : workspace_index.windows_in(workspace->slot))
+        callback(window);
 }
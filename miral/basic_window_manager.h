@@ -25,27 +25,39 @@
 #include "miral/window_info.h"
 #include "miral/application.h"
 #include "miral/application_info.h"
+#include "close_deadlines.h"
+#include "fullscreen_index.h"
+#include "geometry_batch.h"
+#include "info_registry.h"
+#include "scene_snapshot_publisher.h"
+#include "window_spatial_index.h"
+#include "workspace_index.h"
 #include "mru_window_list.h"
+#include "placement_solver.h"
+#include "pointer_motion_coalescer.h"
 
 #include <mir/geometry/rectangles.h>
 #include <mir/shell/abstract_shell.h>
 #include <mir/shell/window_manager.h>
 #include <mir/version.h>
 
-#include <boost/bimap.hpp>
-#include <boost/bimap/multiset_of.hpp>
-
-#include <map>
+#include <set>
+#include <unordered_map>
 #include <mutex>
+#include <shared_mutex>
 
 namespace mir
 {
 namespace shell { class DisplayLayout; class PersistentSurfaceStore; }
+namespace time { class Alarm; class AlarmFactory; }
 }
 
 namespace miral
 {
+class LatencyHistogram;
+class LatencyHistograms;
 class WorkspacePolicy;
+class GeometryBatchPolicy;
 using mir::shell::SurfaceSet;
 using WindowManagementPolicyBuilder =
     std::function<std::unique_ptr<miral::WindowManagementPolicy>(miral::WindowManagerTools const& tools)>;
@@ -61,6 +73,24 @@ public:
         std::shared_ptr<mir::shell::DisplayLayout> const& display_layout,
         std::shared_ptr<mir::shell::PersistentSurfaceStore> const& persistent_surface_store,
         WindowManagementPolicyBuilder const& build);
+    ~BasicWindowManager();
+
+    /// Record the time spent waiting for the window management lock in histograms["Locker"]
+    void record_lock_waits(std::shared_ptr<LatencyHistograms> const& histograms);
+
+    /// Merge pointer motion that arrives while the window manager is busy rather than
+    /// queuing each event for the policy. (Button transitions are never merged.)
+    /// Merged motion is delivered on a thread of its own as soon as the lock is free.
+    void coalesce_pointer_motion(bool enable);
+
+    /// \return the number of motion events merged away by coalescing
+    auto coalesced_pointer_motion() const -> std::uint64_t;
+
+    /// Use an alarm from alarm_factory to enforce close_window() deadlines
+    void enforce_close_deadlines_with(std::shared_ptr<mir::time::AlarmFactory> const& alarm_factory);
+
+    /// Force closed any windows that have outstayed their close_window() deadline
+    void expire_close_deadlines();
 
     void add_session(std::shared_ptr<mir::scene::Session> const& session) override;
 
@@ -143,6 +173,11 @@ public:
 
     void force_close(Window const& window) override;
 
+    void close_window(
+        Window const& window,
+        std::chrono::milliseconds timeout,
+        std::function<void(bool forced)> const& on_closed) override;
+
     auto active_window() const -> Window override;
 
     auto select_active_window(Window const& hint) -> Window override;
@@ -158,6 +193,10 @@ public:
 
     auto window_at(mir::geometry::Point cursor) const -> Window override;
 
+    auto windows_at(mir::geometry::Point point) const -> std::vector<Window> override;
+
+    auto windows_in(mir::geometry::Rectangle const& area) const -> std::vector<Window> override;
+
     auto active_display() -> mir::geometry::Rectangle const override;
 
     void raise_tree(Window const& root) override;
@@ -170,10 +209,13 @@ public:
     void place_and_size_for_state(WindowSpecification& modifications, WindowInfo const& window_info) const override;
 
     void invoke_under_lock(std::function<void()> const& callback) override;
+    void invoke_under_shared_lock(std::function<void()> const& callback) override;
+
+    auto scene_snapshot() const -> std::shared_ptr<SceneSnapshot const> override;
 
 private:
-    using SurfaceInfoMap = std::map<std::weak_ptr<mir::scene::Surface>, WindowInfo, std::owner_less<std::weak_ptr<mir::scene::Surface>>>;
-    using SessionInfoMap = std::map<std::weak_ptr<mir::scene::Session>, ApplicationInfo, std::owner_less<std::weak_ptr<mir::scene::Session>>>;
+    using SurfaceInfoMap = InfoRegistry<mir::scene::Surface, WindowInfo>;
+    using SessionInfoMap = InfoRegistry<mir::scene::Session, ApplicationInfo>;
 
     mir::shell::FocusController* const focus_controller;
     std::shared_ptr<mir::shell::DisplayLayout> const display_layout;
@@ -183,56 +225,102 @@ private:
     struct DeadWorkspaces
     {
         std::mutex mutable dead_workspaces_mutex;
-        std::vector<std::weak_ptr<Workspace>> workspaces;
+        std::vector<WorkspaceIndex::Slot> workspaces;
     };
 
     std::shared_ptr<DeadWorkspaces> const dead_workspaces{std::make_shared<DeadWorkspaces>()};
 
     std::unique_ptr<WindowManagementPolicy> const policy;
     WorkspacePolicy* const workspace_policy;
+    GeometryBatchPolicy* const geometry_batch_policy;
 
-    std::mutex mutex;
+    std::shared_timed_mutex mutex;
+    std::shared_ptr<LatencyHistograms> latency_histograms;
+    LatencyHistogram* lock_wait = nullptr;
+    std::atomic<bool> coalescing_pointer_motion{false};
+    PointerMotionCoalescer pointer_motion;
     SessionInfoMap app_info;
     SurfaceInfoMap window_info;
     mir::geometry::Rectangles displays;
     mir::geometry::Point cursor;
     uint64_t last_input_event_timestamp{0};
     miral::MRUWindowList mru_active_windows;
-    using FullscreenSurfaces = std::set<Window>;
-    FullscreenSurfaces fullscreen_surfaces;
+    FullscreenIndex fullscreen_surfaces;
+    SceneSnapshotPublisher snapshot_publisher;
+    WindowSpatialIndex mutable spatial_index;
+    PlacementSolver placement_solver;
+
+    // Geometry changes made under a Locker reach the scene, and are advised to the policy,
+    // once per window when the Locker ends
+    struct PendingAdvice
+    {
+        Window window;
+        bool resized;
+        bool moved;
+    };
+
+    std::shared_ptr<GeometryBatch> const geometry_batch{std::make_shared<GeometryBatch>()};
+    std::vector<PendingAdvice> pending_advice;
+    std::unordered_map<Window, std::size_t> pending_advice_index;
 
     friend class Workspace;
-    using wwbimap_t = boost::bimap<
-        boost::bimaps::multiset_of<std::weak_ptr<Workspace>, std::owner_less<std::weak_ptr<Workspace>>>,
-        boost::bimaps::multiset_of<Window>>;
+    WorkspaceIndex workspace_index;
 
-    wwbimap_t workspaces_to_windows;
+    // Windows asked to close by close_window() all share close_alarm
+    CloseDeadlines close_deadlines;
+    std::unique_ptr<mir::time::Alarm> close_alarm;
 
     struct Locker;
 
+    void reschedule_close_alarm();
+
     void update_event_timestamp(MirKeyboardEvent const* kev);
     void update_event_timestamp(MirPointerEvent const* pev);
     void update_event_timestamp(MirTouchEvent const* tev);
 
+    auto dispatch_pointer_event(MirPointerEvent const* event) -> bool;
+    void deliver_coalesced_motion();
+
     auto can_activate_window_for_session(miral::Application const& session) -> bool;
     auto can_activate_window_for_session_in_workspace(
         miral::Application const& session,
-        std::vector<std::shared_ptr<Workspace>> const& workspaces) -> bool;
+        WorkspaceSet const& workspaces) -> bool;
 
     auto place_new_surface(ApplicationInfo const& app_info, WindowSpecification parameters) -> WindowSpecification;
     auto place_relative(mir::geometry::Rectangle const& parent, miral::WindowSpecification const& parameters, Size size)
         -> mir::optional_value<Rectangle>;
 
     void move_tree(miral::WindowInfo& root, mir::geometry::Displacement movement);
+
+    /// Visit root and its descendants, parents before children.
+    /// visit(info, depth) returns whether to continue into the children of info.
+    template<typename Visitor>
+    void for_each_in_tree(WindowInfo& root, Visitor const& visit);
+
     void erase(miral::WindowInfo const& info);
     void validate_modification_request(WindowSpecification const& modifications, WindowInfo const& window_info) const;
     void place_and_size(WindowInfo& root, Point const& new_pos, Size const& new_size);
+    void move_window(WindowInfo& info, Point top_left);
+    void resize_window(WindowInfo& info, Size size);
+    auto pending_advice_for(Window const& window) -> PendingAdvice&;
+    void commit_geometry();
+    void index_changed_geometry() const;
+    void advise_geometry_batch(std::vector<PendingAdvice> const& advice);
     void set_state(miral::WindowInfo& window_info, MirWindowState value);
     auto fullscreen_rect_for(WindowInfo const& window_info) const -> Rectangle;
+
+    struct FullscreenPlacement
+    {
+        Rectangle rect;
+        bool displaced;     ///< the window's requested output is not available
+    };
+
+    auto fullscreen_placement_for(WindowInfo const& window_info) const -> FullscreenPlacement;
+    void index_fullscreen(WindowInfo const& window_info);
+    void update_fullscreen_windows_affected_by(mir::geometry::Rectangle const& area);
     void remove_window(Application const& application, miral::WindowInfo const& info);
     void refocus(Application const& application, Window const& parent,
-                 std::vector<std::shared_ptr<Workspace>> const& workspaces_containing_window);
-    auto workspaces_containing(Window const& window) const -> std::vector<std::shared_ptr<Workspace>>;
+                 WorkspaceSet const& workspaces_containing_window);
 };
 }
 
@@ -0,0 +1,100 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "close_deadlines.h"
+
+void miral::CloseDeadlines::add(Window const& window, Clock::time_point deadline, OnClosed const& on_closed)
+{
+    auto const existing = requests.find(window);
+
+    if (existing == requests.end())
+    {
+        requests[window] = Request{deadline, false, {on_closed}};
+        deadlines.emplace(deadline, window);
+        return;
+    }
+
+    auto& request = existing->second;
+    request.on_closed.push_back(on_closed);
+
+    if (!request.expired && deadline < request.deadline)
+    {
+        erase_deadline(window, request.deadline);
+        request.deadline = deadline;
+        deadlines.emplace(deadline, window);
+    }
+}
+
+void miral::CloseDeadlines::closed(Window const& window)
+{
+    auto const found = requests.find(window);
+
+    if (found == requests.end())
+        return;
+
+    auto const request = std::move(found->second);
+    requests.erase(found);
+
+    if (!request.expired)
+        erase_deadline(window, request.deadline);
+
+    // Our state is consistent before calling out: the callbacks may close other windows
+    for (auto const& on_closed : request.on_closed)
+    {
+        if (on_closed)
+            on_closed(request.expired);
+    }
+}
+
+auto miral::CloseDeadlines::expire(Clock::time_point now) -> std::vector<Window>
+{
+    std::vector<Window> result;
+
+    while (!deadlines.empty() && deadlines.begin()->first <= now)
+    {
+        auto const window = deadlines.begin()->second;
+        deadlines.erase(deadlines.begin());
+
+        requests[window].expired = true;
+        result.push_back(window);
+    }
+
+    return result;
+}
+
+auto miral::CloseDeadlines::next_deadline() const -> mir::optional_value<Clock::time_point>
+{
+    if (deadlines.empty())
+        return {};
+
+    return deadlines.begin()->first;
+}
+
+void miral::CloseDeadlines::erase_deadline(Window const& window, Clock::time_point deadline)
+{
+    auto const range = deadlines.equal_range(deadline);
+
+    for (auto i = range.first; i != range.second; ++i)
+    {
+        if (i->second == window)
+        {
+            deadlines.erase(i);
+            return;
+        }
+    }
+}
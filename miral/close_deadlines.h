@@ -0,0 +1,72 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_CLOSE_DEADLINES_H
+#define MIRAL_CLOSE_DEADLINES_H
+
+#include "miral/window.h"
+
+#include <mir/optional_value.h>
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace miral
+{
+/// Windows that have been asked to close, and when to stop asking politely.
+/// All the deadlines share a single alarm, set for the earliest of them, rather
+/// than having an alarm per window.
+class CloseDeadlines
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using OnClosed = std::function<void(bool forced)>;
+
+    /// Track a request to close window. (If window is already being closed the
+    /// earlier deadline applies and both on_closed callbacks are called.)
+    void add(Window const& window, Clock::time_point deadline, OnClosed const& on_closed);
+
+    /// The window has gone: report that to whoever asked for it to close
+    void closed(Window const& window);
+
+    /// Take the windows whose deadline has passed.
+    /// When these are closed they will be reported as "forced".
+    auto expire(Clock::time_point now) -> std::vector<Window>;
+
+    /// When the alarm should next go off (if at all)
+    auto next_deadline() const -> mir::optional_value<Clock::time_point>;
+
+private:
+    struct Request
+    {
+        Clock::time_point deadline;
+        bool expired;
+        std::vector<OnClosed> on_closed;
+    };
+
+    void erase_deadline(Window const& window, Clock::time_point deadline);
+
+    std::unordered_map<Window, Request> requests;
+    std::multimap<Clock::time_point, Window> deadlines;
+};
+}
+
+#endif //MIRAL_CLOSE_DEADLINES_H
@@ -0,0 +1,44 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "forward_geometry_batch.h"
+
+#include "miral/window_info.h"
+#include "miral/window_management_policy.h"
+#include "miral/window_manager_tools.h"
+
+void miral::forward_geometry_batch(
+    WindowManagementPolicy& policy, WindowManagerTools const& tools, std::vector<GeometryChange> const& changes)
+{
+    if (auto const batch_policy = dynamic_cast<GeometryBatchPolicy*>(&policy))
+    {
+        batch_policy->advise_geometry_batch(changes);
+        return;
+    }
+
+    for (auto const& change : changes)
+    {
+        auto& info = tools.info_for(change.window);
+
+        if (change.size.is_set())
+            policy.advise_resize(info, change.size.value());
+
+        if (change.top_left.is_set())
+            policy.advise_move_to(info, change.top_left.value());
+    }
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_FORWARD_GEOMETRY_BATCH_H
+#define MIRAL_FORWARD_GEOMETRY_BATCH_H
+
+#include "miral/geometry_batch_policy.h"
+
+#include <vector>
+
+namespace miral
+{
+class WindowManagementPolicy;
+class WindowManagerTools;
+
+/// For policies that wrap another (such as the trace): advise changes to the wrapped
+/// policy as a batch if it implements GeometryBatchPolicy, and otherwise through
+/// advise_resize() and advise_move_to() as BasicWindowManager would.
+void forward_geometry_batch(
+    WindowManagementPolicy& policy, WindowManagerTools const& tools, std::vector<GeometryChange> const& changes);
+}
+
+#endif //MIRAL_FORWARD_GEOMETRY_BATCH_H
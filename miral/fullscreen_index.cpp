@@ -0,0 +1,93 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "fullscreen_index.h"
+
+#include <algorithm>
+
+using mir::geometry::Rectangle;
+
+void miral::FullscreenIndex::insert(Window const& window, Rectangle const& output, bool displaced)
+{
+    erase(window);
+
+    auto const i = std::find_if(begin(outputs), end(outputs),
+        [&](Output const& candidate) { return candidate.extent == output; });
+
+    if (i != end(outputs))
+        i->windows.push_back(window);
+    else
+        outputs.push_back(Output{output, {window}});
+
+    output_of[window] = output;
+
+    if (displaced)
+        this->displaced.insert(window);
+}
+
+void miral::FullscreenIndex::erase(Window const& window)
+{
+    auto const found = output_of.find(window);
+
+    if (found == end(output_of))
+        return;
+
+    auto const output = std::find_if(begin(outputs), end(outputs),
+        [&](Output const& candidate) { return candidate.extent == found->second; });
+
+    if (output != end(outputs))
+    {
+        auto& windows = output->windows;
+        windows.erase(std::remove(begin(windows), end(windows), window), end(windows));
+
+        if (windows.empty())
+            outputs.erase(output);
+    }
+
+    output_of.erase(found);
+    displaced.erase(window);
+}
+
+auto miral::FullscreenIndex::contains(Window const& window) const -> bool
+{
+    return output_of.find(window) != end(output_of);
+}
+
+auto miral::FullscreenIndex::size() const -> std::size_t
+{
+    return output_of.size();
+}
+
+auto miral::FullscreenIndex::affected_by(Rectangle const& area) const -> std::vector<Window>
+{
+    std::vector<Window> result;
+
+    for (auto const& output : outputs)
+    {
+        if (output.extent.overlaps(area))
+            result.insert(end(result), begin(output.windows), end(output.windows));
+    }
+
+    for (auto const& window : displaced)
+    {
+        if (!output_of.at(window).overlaps(area))
+            result.push_back(window);
+    }
+
+    return result;
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_FULLSCREEN_INDEX_H
+#define MIRAL_FULLSCREEN_INDEX_H
+
+#include <miral/window.h>
+
+#include <mir/geometry/rectangle.h>
+
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+namespace miral
+{
+/// Tracks fullscreen windows by the output they fill, so that a change to one
+/// output need only revisit the windows on that output.
+class FullscreenIndex
+{
+public:
+    /// Record window as filling output (or move it there).
+    /// displaced: the window asked for an output that isn't currently available.
+    void insert(Window const& window, mir::geometry::Rectangle const& output, bool displaced);
+    void erase(Window const& window);
+
+    auto contains(Window const& window) const -> bool;
+    auto size() const -> std::size_t;
+
+    /// The windows on outputs overlapping area, and any displaced windows (which
+    /// may belong there).
+    auto affected_by(mir::geometry::Rectangle const& area) const -> std::vector<Window>;
+
+private:
+    struct Output
+    {
+        mir::geometry::Rectangle extent;
+        std::vector<Window> windows;
+    };
+
+    std::vector<Output> outputs;
+    std::unordered_map<Window, mir::geometry::Rectangle> output_of;
+    std::set<Window> displaced;
+};
+}
+
+#endif //MIRAL_FULLSCREEN_INDEX_H
@@ -0,0 +1,176 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "geometry_batch.h"
+#include "window_self.h"
+
+#include <mir/scene/surface.h>
+
+void miral::GeometryBatch::adopt(Window const& window)
+{
+    auto const& self = window_self(window);
+
+    if (!self) return;
+
+    std::lock_guard<std::mutex> lock{self->mutex};
+    self->batch = shared_from_this();
+}
+
+void miral::GeometryBatch::open()
+{
+    open_ = true;
+}
+
+auto miral::GeometryBatch::is_open() const -> bool
+{
+    return open_;
+}
+
+void miral::GeometryBatch::move(Window const& window, mir::geometry::Point top_left)
+{
+    Change change;
+    change.top_left = top_left;
+    hold(window, change);
+}
+
+void miral::GeometryBatch::resize(Window const& window, mir::geometry::Size size)
+{
+    Change change;
+    change.size = size;
+    hold(window, change);
+}
+
+void miral::GeometryBatch::hold(Window const& window, Change const& change)
+{
+    auto const& self = window_self(window);
+
+    if (!self) return;
+
+    std::lock_guard<std::mutex> lock{self->mutex};
+
+    if (change.size.is_set())
+        self->pending_size = change.size;
+
+    if (change.top_left.is_set())
+        self->pending_top_left = change.top_left;
+
+    self->has_pending = true;
+
+    if (!self->batched)
+    {
+        self->batched = true;
+        pending.push_back(window);
+    }
+}
+
+auto miral::GeometryBatch::take(Window const& window) -> Change
+{
+    auto const& self = window_self(window);
+
+    std::lock_guard<std::mutex> lock{self->mutex};
+    Change const result{self->pending_size, self->pending_top_left};
+    self->pending_size = {};
+    self->pending_top_left = {};
+    self->has_pending = false;
+    return result;
+}
+
+void miral::GeometryBatch::apply(Window const& window, Change const& change)
+{
+    auto const& self = window_self(window);
+
+    if (auto const surface = self->surface.lock())
+    {
+        if (change.size.is_set() && surface->size() != change.size.value())
+            surface->resize(change.size.value());
+
+        if (change.top_left.is_set() && surface->top_left() != change.top_left.value())
+            surface->move_to(change.top_left.value());
+
+        self->cache_geometry_from(*surface);
+    }
+}
+
+void miral::GeometryBatch::apply_pending()
+{
+    for (auto const& window : pending)
+    {
+        auto const& self = window_self(window);
+
+        Change change;
+        {
+            std::lock_guard<std::mutex> lock{self->mutex};
+            change = Change{self->pending_size, self->pending_top_left};
+        }
+
+        apply(window, change);
+    }
+}
+
+void miral::GeometryBatch::commit()
+{
+    open_ = false;
+
+    for (auto const& window : pending)
+    {
+        auto const& self = window_self(window);
+
+        Change change;
+        {
+            std::lock_guard<std::mutex> lock{self->mutex};
+            change = Change{self->pending_size, self->pending_top_left};
+        }
+
+        // Readers see the pending geometry until the surface has it
+        apply(window, change);
+
+        std::lock_guard<std::mutex> lock{self->mutex};
+        self->pending_size = {};
+        self->pending_top_left = {};
+        self->has_pending = false;
+        self->batched = false;
+    }
+
+    pending.clear();
+}
+
+void miral::GeometryBatch::changed_directly(Window const& window)
+{
+    auto const& self = window_self(window);
+
+    std::lock_guard<std::mutex> lock{mutex};
+
+    if (!self->changed_directly)
+    {
+        self->changed_directly = true;
+        changed_directly_.push_back(window);
+    }
+}
+
+auto miral::GeometryBatch::take_changed_directly() -> std::vector<Window>
+{
+    std::vector<Window> result;
+
+    std::lock_guard<std::mutex> lock{mutex};
+    result.swap(changed_directly_);
+
+    for (auto const& window : result)
+        window_self(window)->changed_directly = false;
+
+    return result;
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_GEOMETRY_BATCH_H
+#define MIRAL_GEOMETRY_BATCH_H
+
+#include "miral/window.h"
+
+#include <mir/optional_value.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace miral
+{
+/// Accumulates the geometry changes BasicWindowManager makes to Windows while it is open, and
+/// commits them to the scene together: each surface receives at most one resize() and one move_to().
+/// While the batch is open Window::top_left() and Window::size() report the pending geometry.
+class GeometryBatch : public std::enable_shared_from_this<GeometryBatch>
+{
+public:
+    /// Have window report changes made directly through it (see take_changed_directly())
+    void adopt(Window const& window);
+
+    void open();
+    auto is_open() const -> bool;
+
+    /// Hold a new position or size for window until the commit.
+    /// (For use under the window management lock while the batch is open.)
+    void move(Window const& window, mir::geometry::Point top_left);
+    void resize(Window const& window, mir::geometry::Size size);
+
+    struct Change
+    {
+        mir::optional_value<mir::geometry::Size> size;
+        mir::optional_value<mir::geometry::Point> top_left;
+    };
+
+    /// Remove the pending geometry of window (which then reports that of its surface)
+    auto take(Window const& window) -> Change;
+
+    /// Apply change to the surface of window (unless the surface already has it)
+    static void apply(Window const& window, Change const& change);
+
+    /// Apply the pending geometry to the surfaces, leaving it pending until the commit
+    /// (for queries that are answered by the scene)
+    void apply_pending();
+
+    /// Apply the remaining pending geometry to the surfaces and close the batch
+    void commit();
+
+    /// Called by Window::move_to() and Window::resize() (from any thread) after
+    /// changing the surface directly
+    void changed_directly(Window const& window);
+
+    /// The windows changed directly since this was last called
+    auto take_changed_directly() -> std::vector<Window>;
+
+private:
+    void hold(Window const& window, Change const& change);
+
+    std::atomic<bool> open_{false};
+    std::vector<Window> pending;    // Only used under the window management lock
+
+    std::mutex mutex;
+    std::vector<Window> changed_directly_;
+};
+}
+
+#endif //MIRAL_GEOMETRY_BATCH_H
@@ -0,0 +1,112 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_INFO_REGISTRY_H
+#define MIRAL_INFO_REGISTRY_H
+
+#include <cassert>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+namespace miral
+{
+/// Associates metadata (WindowInfo, ApplicationInfo) with the identity of a Mir object.
+/// Looking up a live object is a hash of its address rather than an owner_less<> tree walk.
+/// An object that has expired is still found (and erased) by its owner identity, as
+/// teardown relies on that: this goes through an owner_less<> index only kept for that.
+/// \note references to Info remain valid until that entry is erased.
+template<typename Object, typename Info>
+class InfoRegistry
+{
+public:
+    using Key = Object const*;
+    using Storage = std::unordered_map<Key, Info>;
+    using iterator = typename Storage::iterator;
+    using const_iterator = typename Storage::const_iterator;
+
+    template<typename... Args>
+    auto emplace(std::shared_ptr<Object> const& object, Args&&... args) -> Info&
+    {
+        auto const result = storage.emplace(
+            std::piecewise_construct,
+            std::forward_as_tuple(object.get()),
+            std::forward_as_tuple(std::forward<Args>(args)...));
+
+        // A duplicate is either registered twice or a stale entry for a freed object at the same address
+        assert(result.second && "Info already registered for object");
+
+        owners.emplace(object, object.get());
+        return result.first->second;
+    }
+
+    auto at(std::weak_ptr<Object> const& object) const -> Info&
+    {
+        if (auto const live = object.lock())
+            return at(live.get());
+
+        auto const owner = owners.find(object);
+
+        if (owner == owners.end())
+            throw std::out_of_range{"No info registered for object"};
+
+        return at(owner->second);
+    }
+
+    void erase(std::weak_ptr<Object> const& object)
+    {
+        auto const owner = owners.find(object);
+
+        if (owner == owners.end())
+            return;
+
+        storage.erase(owner->second);
+        owners.erase(owner);
+    }
+
+    void reserve(std::size_t count) { storage.reserve(count); }
+
+    auto size() const -> std::size_t { return storage.size(); }
+
+    auto begin() -> iterator { return storage.begin(); }
+    auto end() -> iterator { return storage.end(); }
+    auto begin() const -> const_iterator { return storage.begin(); }
+    auto end() const -> const_iterator { return storage.end(); }
+
+private:
+    auto at(Key key) const -> Info&
+    {
+        auto const i = storage.find(key);
+
+        if (i == storage.end())
+            throw std::out_of_range{"No info registered for object"};
+
+        return const_cast<Info&>(i->second);
+    }
+
+    using Owners = std::map<std::weak_ptr<Object>, Key, std::owner_less<std::weak_ptr<Object>>>;
+
+    Storage storage;
+    Owners owners;
+};
+}
+
+#endif //MIRAL_INFO_REGISTRY_H
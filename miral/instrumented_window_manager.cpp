@@ -0,0 +1,150 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "instrumented_window_manager.h"
+
+#include "latency_histogram.h"
+#include "trace_ring_buffer.h"
+#include "window_management_latency.h"
+#include "window_management_recorder.h"
+#include "window_management_trace.h"
+
+#include <mir/main_loop.h>
+#include <mir/server.h>
+#include <mir/options/option.h>
+#include <mir/version.h>
+
+#define MIR_LOG_COMPONENT "miral::Window Management"
+#include <mir/log.h>
+
+#include <csignal>
+
+namespace
+{
+char const* const trace_option = "window-management-trace";
+char const* const trace_file_option = "window-management-trace-file";
+std::uint64_t const trace_file_records = 65536;
+char const* const record_option = "window-management-record";
+char const* const latency_option = "window-management-latency";
+char const* const coalesce_option = "window-management-coalesce-motion";
+
+void log_latency(miral::LatencyHistograms const& histograms)
+{
+    using namespace std::chrono;
+
+    mir::log_info("latency: %-32s %10s %12s %10s %10s %10s %10s", "call", "count", "total(us)", "p50(ns)", "p90(ns)", "p99(ns)", "max(ns)");
+
+    for (auto const& call : histograms.summary())
+    {
+        mir::log_info("latency: %-32s %10llu %12lld %10lld %10lld %10lld %10lld",
+            call.name.c_str(),
+            static_cast<unsigned long long>(call.count),
+            static_cast<long long>(duration_cast<microseconds>(call.total).count()),
+            static_cast<long long>(call.p50.count()),
+            static_cast<long long>(call.p90.count()),
+            static_cast<long long>(call.p99.count()),
+            static_cast<long long>(call.max.count()));
+    }
+}
+}
+
+void miral::add_window_management_instrumentation_options(mir::Server& server)
+{
+    server.add_configuration_option(trace_option, "log trace message", mir::OptionType::null);
+    server.add_configuration_option(trace_file_option, "record binary trace to file (synced on SIGUSR1)", mir::OptionType::string);
+    server.add_configuration_option(record_option, "record window management calls to file", mir::OptionType::string);
+    server.add_configuration_option(latency_option, "measure window management latency (logged on SIGUSR2)", mir::OptionType::null);
+    server.add_configuration_option(coalesce_option, "merge pointer motion that arrives while window management is busy", mir::OptionType::null);
+}
+
+auto miral::build_instrumented_window_manager(
+    mir::Server& server,
+    mir::shell::FocusController* focus_controller,
+    WindowManagementPolicyBuilder const& builder)
+-> std::shared_ptr<mir::shell::WindowManager>
+{
+    auto const options = server.get_options();
+    auto const display_layout = server.the_shell_display_layout();
+
+#if MIR_SERVER_VERSION >= MIR_VERSION_NUMBER(0, 24, 0)
+    auto const persistent_surface_store = server.the_persistent_surface_store();
+#else
+    std::shared_ptr<mir::shell::PersistentSurfaceStore> const persistent_surface_store;
+#endif
+
+    auto instrumented_builder = builder;
+
+    if (options->is_set(trace_option) || options->is_set(trace_file_option))
+    {
+        std::shared_ptr<TraceRingBuffer> binary;
+
+        if (options->is_set(trace_file_option))
+        {
+            auto const path = options->get<std::string>(trace_file_option);
+            binary = std::make_shared<TraceRingBuffer>(path, trace_file_records);
+
+            server.the_main_loop()->register_signal_handler({SIGUSR1}, [binary, path](int)
+                {
+                    binary->flush();
+                    mir::log_info("trace: synced %s", path.c_str());
+                });
+        }
+
+        instrumented_builder = [builder, binary](WindowManagerTools const& tools) -> std::unique_ptr<miral::WindowManagementPolicy>
+            {
+                return std::make_unique<WindowManagementTrace>(tools, builder, binary);
+            };
+    }
+
+    std::shared_ptr<LatencyHistograms> histograms;
+
+    if (options->is_set(latency_option))
+    {
+        histograms = std::make_shared<LatencyHistograms>();
+
+        instrumented_builder = [inner=instrumented_builder, histograms](WindowManagerTools const& tools)
+            -> std::unique_ptr<miral::WindowManagementPolicy>
+            {
+                return std::make_unique<WindowManagementLatency>(tools, inner, histograms);
+            };
+    }
+
+    auto const window_manager = std::make_shared<BasicWindowManager>(
+        focus_controller, display_layout, persistent_surface_store, instrumented_builder);
+
+    window_manager->enforce_close_deadlines_with(server.the_main_loop());
+
+    if (options->is_set(coalesce_option))
+        window_manager->coalesce_pointer_motion(true);
+
+    if (histograms)
+    {
+        window_manager->record_lock_waits(histograms);
+        server.the_main_loop()->register_signal_handler({SIGUSR2}, [histograms, window_manager](int)
+            {
+                log_latency(*histograms);
+                mir::log_info("latency: %llu pointer motion events coalesced",
+                    static_cast<unsigned long long>(window_manager->coalesced_pointer_motion()));
+            });
+    }
+
+    if (options->is_set(record_option))
+        return std::make_shared<RecordingWindowManager>(window_manager, options->get<std::string>(record_option));
+
+    return window_manager;
+}
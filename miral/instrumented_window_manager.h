@@ -0,0 +1,39 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_INSTRUMENTED_WINDOW_MANAGER_H
+#define MIRAL_INSTRUMENTED_WINDOW_MANAGER_H
+
+#include "basic_window_manager.h"
+
+namespace mir { class Server; }
+
+namespace miral
+{
+/// Adds the options to trace, record and measure window management
+void add_window_management_instrumentation_options(mir::Server& server);
+
+/// Builds a BasicWindowManager for a policy, instrumented as selected by those options
+auto build_instrumented_window_manager(
+    mir::Server& server,
+    mir::shell::FocusController* focus_controller,
+    WindowManagementPolicyBuilder const& builder)
+-> std::shared_ptr<mir::shell::WindowManager>;
+}
+
+#endif //MIRAL_INSTRUMENTED_WINDOW_MANAGER_H
@@ -0,0 +1,181 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "latency_histogram.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+auto fnv1a(char const* name) -> std::size_t
+{
+    std::size_t hash = 2166136261u;
+
+    for (; *name; ++name)
+        hash = (hash ^ static_cast<unsigned char>(*name))*16777619u;
+
+    return hash;
+}
+
+void update_max(std::atomic<std::uint64_t>& max, std::uint64_t value)
+{
+    auto current = max.load(std::memory_order_relaxed);
+
+    while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed))
+        ;
+}
+}
+
+miral::LatencyHistogram::LatencyHistogram() :
+    count_{0},
+    total_{0},
+    max_{0}
+{
+    for (auto& bucket : buckets)
+        bucket.store(0, std::memory_order_relaxed);
+}
+
+auto miral::LatencyHistogram::bucket_for(std::uint64_t nanoseconds) -> unsigned int
+{
+    // Small values each get a bucket of their own
+    if (nanoseconds < sub_buckets)
+        return nanoseconds;
+
+    unsigned int const magnitude = 63 - __builtin_clzll(nanoseconds);
+    unsigned int const sub_bucket = (nanoseconds >> (magnitude - sub_bucket_bits)) & (sub_buckets - 1);
+
+    return (magnitude - sub_bucket_bits + 1)*sub_buckets + sub_bucket;
+}
+
+auto miral::LatencyHistogram::lower_bound_of(unsigned int bucket) -> std::uint64_t
+{
+    if (bucket < sub_buckets)
+        return bucket;
+
+    auto const magnitude = bucket/sub_buckets + sub_bucket_bits - 1;
+    auto const sub_bucket = bucket % sub_buckets;
+
+    return std::uint64_t(sub_buckets + sub_bucket) << (magnitude - sub_bucket_bits);
+}
+
+void miral::LatencyHistogram::record(std::chrono::nanoseconds latency)
+{
+    std::uint64_t const value = std::max<std::chrono::nanoseconds::rep>(latency.count(), 0);
+
+    buckets[bucket_for(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    total_.fetch_add(value, std::memory_order_relaxed);
+    update_max(max_, value);
+}
+
+auto miral::LatencyHistogram::count() const -> std::uint64_t
+{
+    return count_.load(std::memory_order_relaxed);
+}
+
+auto miral::LatencyHistogram::total() const -> std::chrono::nanoseconds
+{
+    return std::chrono::nanoseconds(total_.load(std::memory_order_relaxed));
+}
+
+auto miral::LatencyHistogram::max() const -> std::chrono::nanoseconds
+{
+    return std::chrono::nanoseconds(max_.load(std::memory_order_relaxed));
+}
+
+auto miral::LatencyHistogram::percentile(double fraction) const -> std::chrono::nanoseconds
+{
+    // The buckets are read while they may be updated, so this is only a snapshot
+    std::uint64_t counts[bucket_count];
+    std::uint64_t total_count = 0;
+
+    for (auto i = 0U; i != bucket_count; ++i)
+        total_count += (counts[i] = buckets[i].load(std::memory_order_relaxed));
+
+    if (total_count == 0)
+        return std::chrono::nanoseconds{0};
+
+    auto const wanted = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(fraction*total_count + 0.5));
+    std::uint64_t seen = 0;
+
+    for (auto i = 0U; i != bucket_count; ++i)
+    {
+        seen += counts[i];
+
+        if (seen >= wanted)
+        {
+            auto const upper_bound = i+1 < bucket_count ? lower_bound_of(i+1) - 1 : max_.load();
+            return std::chrono::nanoseconds(std::min(upper_bound, max_.load(std::memory_order_relaxed)));
+        }
+    }
+
+    return max();
+}
+
+miral::LatencyHistograms::LatencyHistograms()
+{
+    for (auto& slot : slots)
+        slot.name.store(nullptr, std::memory_order_relaxed);
+}
+
+auto miral::LatencyHistograms::operator[](char const* name) -> LatencyHistogram&
+{
+    auto index = fnv1a(name) % capacity;
+
+    for (auto i = 0U; i != capacity; ++i, index = (index + 1) % capacity)
+    {
+        auto& slot = slots[index];
+        auto existing = slot.name.load(std::memory_order_acquire);
+
+        if (!existing && slot.name.compare_exchange_strong(existing, name, std::memory_order_acq_rel))
+            return slot.histogram;
+
+        if (existing == name || std::strcmp(existing, name) == 0)
+            return slot.histogram;
+    }
+
+    return overflow;
+}
+
+auto miral::LatencyHistograms::summary() const -> std::vector<Summary>
+{
+    std::vector<Summary> result;
+
+    for (auto const& slot : slots)
+    {
+        auto const name = slot.name.load(std::memory_order_acquire);
+        auto const& histogram = slot.histogram;
+
+        if (name && histogram.count())
+        {
+            result.push_back(Summary{
+                name,
+                histogram.count(),
+                histogram.total(),
+                histogram.percentile(0.50),
+                histogram.percentile(0.90),
+                histogram.percentile(0.99),
+                histogram.max()});
+        }
+    }
+
+    std::sort(begin(result), end(result), [](Summary const& lhs, Summary const& rhs) { return lhs.total > rhs.total; });
+
+    return result;
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_LATENCY_HISTOGRAM_H
+#define MIRAL_LATENCY_HISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace miral
+{
+/// A lock-free latency histogram with log-linear ("HDR") buckets: each power
+/// of two is split into eight buckets, so values are kept to within 12.5%.
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+
+    void record(std::chrono::nanoseconds latency);
+
+    auto count() const -> std::uint64_t;
+    auto total() const -> std::chrono::nanoseconds;
+    auto max() const -> std::chrono::nanoseconds;
+
+    /// \return an upper bound for the given fraction (0.0 to 1.0) of recorded latencies
+    auto percentile(double fraction) const -> std::chrono::nanoseconds;
+
+    static auto bucket_for(std::uint64_t nanoseconds) -> unsigned int;
+    static auto lower_bound_of(unsigned int bucket) -> std::uint64_t;
+
+    static unsigned int const sub_bucket_bits = 3;
+    static unsigned int const sub_buckets = 1 << sub_bucket_bits;
+    static unsigned int const bucket_count = (64 - sub_bucket_bits + 1)*sub_buckets;
+
+private:
+    std::array<std::atomic<std::uint64_t>, bucket_count> buckets;
+    std::atomic<std::uint64_t> count_;
+    std::atomic<std::uint64_t> total_;
+    std::atomic<std::uint64_t> max_;
+};
+
+/// A fixed capacity, lock-free collection of LatencyHistograms looked up by name.
+/// \note the names must outlive the collection (string literals and __func__ do)
+class LatencyHistograms
+{
+public:
+    LatencyHistograms();
+
+    auto operator[](char const* name) -> LatencyHistogram&;
+
+    struct Summary
+    {
+        std::string name;
+        std::uint64_t count;
+        std::chrono::nanoseconds total;
+        std::chrono::nanoseconds p50;
+        std::chrono::nanoseconds p90;
+        std::chrono::nanoseconds p99;
+        std::chrono::nanoseconds max;
+    };
+
+    /// \return a summary of each histogram that has a value, largest total first
+    auto summary() const -> std::vector<Summary>;
+
+    static unsigned int const capacity = 128;
+
+private:
+    struct Slot
+    {
+        std::atomic<char const*> name;
+        LatencyHistogram histogram;
+    };
+
+    std::array<Slot, capacity> slots;
+
+    // Used if ever we run out of slots
+    LatencyHistogram overflow;
+};
+
+/// Records the time from construction to destruction in a histogram
+class LatencyTimer
+{
+public:
+    explicit LatencyTimer(LatencyHistogram& histogram) :
+        histogram(histogram), start{std::chrono::steady_clock::now()} {}
+
+    ~LatencyTimer() { histogram.record(std::chrono::steady_clock::now() - start); }
+
+    LatencyTimer(LatencyTimer const&) = delete;
+    LatencyTimer& operator=(LatencyTimer const&) = delete;
+
+private:
+    LatencyHistogram& histogram;
+    std::chrono::steady_clock::time_point const start;
+};
+}
+
+#endif //MIRAL_LATENCY_HISTOGRAM_H
@@ -17,50 +17,102 @@
  */
 
 #include "mru_window_list.h"
+#include "surface_cache.h"
 
 #include <mir/client/detail/mir_forward_compatibility.h>
-#include <mir/scene/surface.h>
 
-#include <algorithm>
+#include <vector>
 
 namespace
 {
-bool visible(miral::Window const& window)
+bool is_visible(miral::Window const& window)
 {
-    std::shared_ptr<mir::scene::Surface> const& surface{window};
-
-    switch (surface->state())
+    switch (miral::SurfaceCache::state(window))
     {
     case mir_window_state_hidden:
     case mir_window_state_minimized:
         return false;
     default:
-        return surface->visible();
+        return miral::SurfaceCache::visible(window);
     }
 }
 }
 
+void miral::MRUWindowList::link_at_head(Entry* entry)
+{
+    entry->prev = nullptr;
+    entry->next = head;
+
+    if (head)
+        head->prev = entry;
+
+    head = entry;
+}
+
+void miral::MRUWindowList::unlink(Entry* entry)
+{
+    if (entry->prev)
+        entry->prev->next = entry->next;
+    else
+        head = entry->next;
+
+    if (entry->next)
+        entry->next->prev = entry->prev;
+
+    entry->prev = nullptr;
+    entry->next = nullptr;
+}
+
 void miral::MRUWindowList::push(Window const& window)
 {
-    windows.erase(remove(begin(windows), end(windows), window), end(windows));
-    windows.push_back(window);
+    auto const i = entries.find(window);
+
+    Entry* entry;
+
+    if (i != entries.end())
+    {
+        entry = &i->second;
+        unlink(entry);
+    }
+    else
+    {
+        entry = &entries.emplace(window, Entry{window, nullptr, nullptr}).first->second;
+    }
+
+    link_at_head(entry);
 }
 
 void miral::MRUWindowList::erase(Window const& window)
 {
-    windows.erase(remove(begin(windows), end(windows), window), end(windows));
+    auto const i = entries.find(window);
+
+    if (i == entries.end())
+        return;
+
+    unlink(&i->second);
+    entries.erase(i);
 }
 
 auto miral::MRUWindowList::top() const -> Window
 {
-    auto const& found = std::find_if(rbegin(windows), rend(windows), visible);
-    return (found != rend(windows)) ? *found: Window{};
+    for (auto entry = head; entry; entry = entry->next)
+        if (is_visible(entry->window))
+            return entry->window;
+
+    return {};
 }
 
 void miral::MRUWindowList::enumerate(Enumerator const& enumerator) const
 {
-    for (auto i = windows.rbegin(); i != windows.rend(); ++i)
-        if (visible(*i))
-            if (!enumerator(const_cast<Window&>(*i)))
-                break;
+    // The enumerator may update the list (e.g. select_active_window() pushes), so work on a copy
+    std::vector<Window> windows;
+    windows.reserve(entries.size());
+
+    for (auto entry = head; entry; entry = entry->next)
+        if (is_visible(entry->window))
+            windows.push_back(entry->window);
+
+    for (auto& window : windows)
+        if (!enumerator(window))
+            break;
 }
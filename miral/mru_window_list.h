@@ -22,10 +22,17 @@
 #include <miral/window.h>
 
 #include <functional>
-#include <vector>
+#include <unordered_map>
 
 namespace miral
 {
+/// Windows in most recently used order. push() and erase() are O(1): entries
+/// form an intrusive list.
+///
+/// Visibility is not copied into the list, so it can't go stale whichever way a
+/// window is shown or hidden: top() and enumerate() read the visibility that
+/// SurfaceCache keeps current and pass over hidden windows. top() costs O(h),
+/// where h is the number of hidden windows used more recently than the top one.
 class MRUWindowList
 {
 public:
@@ -39,7 +46,18 @@ public:
     void enumerate(Enumerator const& enumerator) const;
 
 private:
-    std::vector<Window> windows;
+    struct Entry
+    {
+        Window window;
+        Entry* prev;
+        Entry* next;
+    };
+
+    std::unordered_map<Window, Entry> entries;
+    Entry* head = nullptr;
+
+    void link_at_head(Entry* entry);
+    void unlink(Entry* entry);
 };
 }
 
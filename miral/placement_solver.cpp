@@ -0,0 +1,390 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "placement_solver.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <stdexcept>
+
+using namespace mir::geometry;
+
+namespace
+{
+template<typename T>
+struct Range
+{
+    T const* first;
+    T const* last;
+
+    auto begin() const -> T const* { return first; }
+    auto end() const -> T const* { return last; }
+};
+
+template<typename T>
+auto make_range(T const* first, int count) -> Range<T>
+{
+    return {first, first + count};
+}
+
+auto flip_x(MirPlacementGravity rect_gravity) -> MirPlacementGravity
+{
+    switch (rect_gravity)
+    {
+    case mir_placement_gravity_northwest:
+        return mir_placement_gravity_northeast;
+
+    case mir_placement_gravity_northeast:
+        return mir_placement_gravity_northwest;
+
+    case mir_placement_gravity_west:
+        return mir_placement_gravity_east;
+
+    case mir_placement_gravity_east:
+        return mir_placement_gravity_west;
+
+    case mir_placement_gravity_southwest:
+        return mir_placement_gravity_southeast;
+
+    case mir_placement_gravity_southeast:
+        return mir_placement_gravity_southwest;
+
+    default:
+        return rect_gravity;
+    }
+}
+
+auto flip_y(MirPlacementGravity rect_gravity) -> MirPlacementGravity
+{
+    switch (rect_gravity)
+    {
+    case mir_placement_gravity_northwest:
+        return mir_placement_gravity_southwest;
+
+    case mir_placement_gravity_north:
+        return mir_placement_gravity_south;
+
+    case mir_placement_gravity_northeast:
+        return mir_placement_gravity_southeast;
+
+    case mir_placement_gravity_southwest:
+        return mir_placement_gravity_northwest;
+
+    case mir_placement_gravity_south:
+        return mir_placement_gravity_north;
+
+    case mir_placement_gravity_southeast:
+        return mir_placement_gravity_northeast;
+
+    default:
+        return rect_gravity;
+    }
+}
+
+auto flip_x(Displacement const& d) -> Displacement { return {-1*d.dx, d.dy}; }
+auto flip_y(Displacement const& d) -> Displacement { return {d.dx, -1*d.dy}; }
+
+auto antipodes(MirPlacementGravity rect_gravity) -> MirPlacementGravity
+{
+    switch (rect_gravity)
+    {
+    case mir_placement_gravity_northwest:
+        return mir_placement_gravity_southeast;
+
+    case mir_placement_gravity_north:
+        return mir_placement_gravity_south;
+
+    case mir_placement_gravity_northeast:
+        return mir_placement_gravity_southwest;
+
+    case mir_placement_gravity_west:
+        return mir_placement_gravity_east;
+
+    case mir_placement_gravity_east:
+        return mir_placement_gravity_west;
+
+    case mir_placement_gravity_southwest:
+        return mir_placement_gravity_northeast;
+
+    case mir_placement_gravity_south:
+        return mir_placement_gravity_north;
+
+    case mir_placement_gravity_southeast:
+        return mir_placement_gravity_northwest;
+
+    default:
+        return rect_gravity;
+    }
+}
+
+auto constrain_to(mir::geometry::Rectangle const& rect, Point point) -> Point
+{
+    if (point.x < rect.top_left.x)
+        point.x = rect.top_left.x;
+
+    if (point.y < rect.top_left.y)
+        point.y = rect.top_left.y;
+
+    if (point.x > rect.bottom_right().x)
+        point.x = rect.bottom_right().x;
+
+    if (point.y > rect.bottom_right().y)
+        point.y = rect.bottom_right().y;
+
+    return point;
+}
+
+auto anchor_for(Rectangle const& aux_rect, MirPlacementGravity rect_gravity) -> Point
+{
+    switch (rect_gravity)
+    {
+    case mir_placement_gravity_northwest:
+        return aux_rect.top_left;
+
+    case mir_placement_gravity_north:
+        return aux_rect.top_left + 0.5*as_displacement(aux_rect.size).dx;
+
+    case mir_placement_gravity_northeast:
+        return aux_rect.top_right();
+
+    case mir_placement_gravity_west:
+        return aux_rect.top_left + 0.5*as_displacement(aux_rect.size).dy;
+
+    case mir_placement_gravity_center:
+        return aux_rect.top_left + 0.5*as_displacement(aux_rect.size);
+
+    case mir_placement_gravity_east:
+        return aux_rect.top_right() + 0.5*as_displacement(aux_rect.size).dy;
+
+    case mir_placement_gravity_southwest:
+        return aux_rect.bottom_left();
+
+    case mir_placement_gravity_south:
+        return aux_rect.bottom_left() + 0.5*as_displacement(aux_rect.size).dx;
+
+    case mir_placement_gravity_southeast:
+        return aux_rect.bottom_right();
+
+    default:
+        BOOST_THROW_EXCEPTION(std::runtime_error("bad placement gravity"));
+    }
+}
+
+auto offset_for(Size const& size, MirPlacementGravity rect_gravity) -> Displacement
+{
+    auto const displacement = as_displacement(size);
+
+    switch (rect_gravity)
+    {
+    case mir_placement_gravity_northwest:
+        return {0, 0};
+
+    case mir_placement_gravity_north:
+        return {-0.5 * displacement.dx, 0};
+
+    case mir_placement_gravity_northeast:
+        return {-1 * displacement.dx, 0};
+
+    case mir_placement_gravity_west:
+        return {0, -0.5 * displacement.dy};
+
+    case mir_placement_gravity_center:
+        return {-0.5 * displacement.dx, -0.5 * displacement.dy};
+
+    case mir_placement_gravity_east:
+        return {-1 * displacement.dx, -0.5 * displacement.dy};
+
+    case mir_placement_gravity_southwest:
+        return {0, -1 * displacement.dy};
+
+    case mir_placement_gravity_south:
+        return {-0.5 * displacement.dx, -1 * displacement.dy};
+
+    case mir_placement_gravity_southeast:
+        return {-1 * displacement.dx, -1 * displacement.dy};
+
+    default:
+        BOOST_THROW_EXCEPTION(std::runtime_error("bad placement gravity"));
+    }
+}
+}
+
+auto miral::operator==(PlacementSolver::Request const& lhs, PlacementSolver::Request const& rhs) -> bool
+{
+    return lhs.parent == rhs.parent &&
+        lhs.aux_rect == rhs.aux_rect &&
+        lhs.offset == rhs.offset &&
+        lhs.rect_gravity == rhs.rect_gravity &&
+        lhs.window_gravity == rhs.window_gravity &&
+        lhs.hints == rhs.hints &&
+        lhs.size == rhs.size &&
+        lhs.display == rhs.display;
+}
+
+auto miral::PlacementSolver::place(Request const& request) -> mir::optional_value<Rectangle>
+{
+    for (auto i = 0u; i != cached; ++i)
+    {
+        if (cache[i].request == request)
+            return cache[i].result;
+    }
+
+    auto const result = solve(request);
+
+    cache[next] = Entry{request, result};
+    next = (next + 1) % cache_size;
+    if (cached < cache_size) ++cached;
+
+    return result;
+}
+
+auto miral::PlacementSolver::solve(Request const& request) -> mir::optional_value<Rectangle>
+{
+    auto const& parent = request.parent;
+    auto const hints = request.hints;
+    auto const& active_display_area = request.display;
+    auto const win_gravity = request.window_gravity;
+    auto const offset = request.offset;
+    auto size = request.size;
+
+    Rectangle aux_rect = request.aux_rect;
+    aux_rect.top_left = aux_rect.top_left + (parent.top_left-Point{});
+
+    // At most the requested gravity and its antipodes: no need for a heap allocation
+    MirPlacementGravity const gravities[] = {request.rect_gravity, antipodes(request.rect_gravity)};
+    auto const rect_gravities = make_range(gravities, (hints & mir_placement_hints_antipodes) ? 2 : 1);
+
+    mir::optional_value<Rectangle> default_result;
+
+    for (auto const& rect_gravity : rect_gravities)
+    {
+        {
+            auto result = constrain_to(parent, anchor_for(aux_rect, rect_gravity) + offset) +
+                offset_for(size, win_gravity);
+
+            if (active_display_area.contains(Rectangle{result, size}))
+                return Rectangle{result, size};
+
+            if (!default_result.is_set())
+                default_result = Rectangle{result, size};
+        }
+
+        if (hints & mir_placement_hints_flip_x)
+        {
+            auto result = constrain_to(parent, anchor_for(aux_rect, flip_x(rect_gravity)) + flip_x(offset)) +
+                offset_for(size, flip_x(win_gravity));
+
+            if (active_display_area.contains(Rectangle{result, size}))
+                return Rectangle{result, size};
+        }
+
+        if (hints & mir_placement_hints_flip_y)
+        {
+            auto result = constrain_to(parent, anchor_for(aux_rect, flip_y(rect_gravity)) + flip_y(offset)) +
+                offset_for(size, flip_y(win_gravity));
+
+            if (active_display_area.contains(Rectangle{result, size}))
+                return Rectangle{result, size};
+        }
+
+        if (hints & mir_placement_hints_flip_x && hints & mir_placement_hints_flip_y)
+        {
+            auto result = constrain_to(parent, anchor_for(aux_rect, flip_x(flip_y(rect_gravity))) + flip_x(flip_y(offset))) +
+                offset_for(size, flip_x(flip_y(win_gravity)));
+
+            if (active_display_area.contains(Rectangle{result, size}))
+                return Rectangle{result, size};
+        }
+    }
+
+    for (auto const& rect_gravity : rect_gravities)
+    {
+        auto result = constrain_to(parent, anchor_for(aux_rect, rect_gravity) + offset) +
+            offset_for(size, win_gravity);
+
+        if (hints & mir_placement_hints_slide_x)
+        {
+            auto const left_overhang  = result.x - active_display_area.top_left.x;
+            auto const right_overhang = (result + as_displacement(size)).x - active_display_area.top_right().x;
+
+            if (left_overhang < DeltaX{0})
+                result -= left_overhang;
+            else if (right_overhang > DeltaX{0})
+                result -= right_overhang;
+        }
+
+        if (hints & mir_placement_hints_slide_y)
+        {
+            auto const top_overhang  = result.y - active_display_area.top_left.y;
+            auto const bot_overhang = (result + as_displacement(size)).y - active_display_area.bottom_left().y;
+
+            if (top_overhang < DeltaY{0})
+                result -= top_overhang;
+            else if (bot_overhang > DeltaY{0})
+                result -= bot_overhang;
+        }
+
+        if (active_display_area.contains(Rectangle{result, size}))
+            return Rectangle{result, size};
+    }
+
+    for (auto const& rect_gravity : rect_gravities)
+    {
+        auto result = constrain_to(parent, anchor_for(aux_rect, rect_gravity) + offset) +
+            offset_for(size, win_gravity);
+
+        if (hints & mir_placement_hints_resize_x)
+        {
+            auto const left_overhang  = result.x - active_display_area.top_left.x;
+            auto const right_overhang = (result + as_displacement(size)).x - active_display_area.top_right().x;
+
+            if (left_overhang < DeltaX{0})
+            {
+                result -= left_overhang;
+                size = Size{size.width + left_overhang, size.height};
+            }
+
+            if (right_overhang > DeltaX{0})
+            {
+                size = Size{size.width - right_overhang, size.height};
+            }
+        }
+
+        if (hints & mir_placement_hints_resize_y)
+        {
+            auto const top_overhang  = result.y - active_display_area.top_left.y;
+            auto const bot_overhang = (result + as_displacement(size)).y - active_display_area.bottom_left().y;
+
+            if (top_overhang < DeltaY{0})
+            {
+                result -= top_overhang;
+                size = Size{size.width, size.height + top_overhang};
+            }
+
+            if (bot_overhang > DeltaY{0})
+            {
+                size = Size{size.width, size.height - bot_overhang};
+            }
+        }
+
+        if (active_display_area.contains(Rectangle{result, size}))
+            return Rectangle{result, size};
+    }
+
+    return default_result;
+}
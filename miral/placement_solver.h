@@ -0,0 +1,73 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_PLACEMENT_SOLVER_H
+#define MIRAL_PLACEMENT_SOLVER_H
+
+#include <mir/geometry/displacement.h>
+#include <mir/geometry/rectangle.h>
+#include <mir/optional_value.h>
+#include <mir_toolkit/common.h>
+
+#include <array>
+#include <cstddef>
+
+namespace miral
+{
+/// Places menus, tooltips &c. relative to an anchor rectangle on their parent.
+/// The most recent placements are remembered: popup-heavy toolkits reopen the same
+/// menus repeatedly and the answer only depends on the request.
+class PlacementSolver
+{
+public:
+    struct Request
+    {
+        mir::geometry::Rectangle parent;
+        mir::geometry::Rectangle aux_rect;      ///< relative to parent
+        mir::geometry::Displacement offset;
+        MirPlacementGravity rect_gravity;
+        MirPlacementGravity window_gravity;
+        MirPlacementHints hints;
+        mir::geometry::Size size;
+        mir::geometry::Rectangle display;
+    };
+
+    static std::size_t const cache_size = 16;
+
+    /// Solve request, or return the remembered solution to the same request
+    auto place(Request const& request) -> mir::optional_value<mir::geometry::Rectangle>;
+
+    /// Solve request without consulting (or updating) the cache
+    static auto solve(Request const& request) -> mir::optional_value<mir::geometry::Rectangle>;
+
+private:
+    struct Entry
+    {
+        Request request;
+        mir::optional_value<mir::geometry::Rectangle> result;
+    };
+
+    std::array<Entry, cache_size> cache{};
+    std::size_t cached{0};
+    std::size_t next{0};
+};
+
+auto operator==(PlacementSolver::Request const& lhs, PlacementSolver::Request const& rhs) -> bool;
+}
+
+#endif //MIRAL_PLACEMENT_SOLVER_H
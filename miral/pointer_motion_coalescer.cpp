@@ -0,0 +1,173 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "pointer_motion_coalescer.h"
+
+#include <mir/report_exception.h>
+
+#include <vector>
+
+namespace mev = mir::events;
+
+namespace
+{
+std::vector<uint8_t> const no_cookie;
+
+auto buttons_of(MirPointerEvent const* event) -> MirPointerButtons
+{
+    MirPointerButtons result{0};
+
+    for (auto const button : {
+        mir_pointer_button_primary,
+        mir_pointer_button_secondary,
+        mir_pointer_button_tertiary,
+        mir_pointer_button_back,
+        mir_pointer_button_forward})
+    {
+        if (mir_pointer_event_button_state(event, button))
+            result |= button;
+    }
+
+    return result;
+}
+}
+
+miral::PointerMotionCoalescer::~PointerMotionCoalescer()
+{
+    stop_delivery();
+}
+
+auto miral::PointerMotionCoalescer::can_coalesce(MirPointerEvent const* event) -> bool
+{
+    return mir_pointer_event_action(event) == mir_pointer_action_motion && !buttons_of(event);
+}
+
+void miral::PointerMotionCoalescer::stash(MirPointerEvent const* event)
+{
+    auto const input_event = mir_pointer_event_input_event(event);
+
+    std::lock_guard<decltype(mutex)> lock{mutex};
+
+    if (pending)
+    {
+        ++dropped_count;
+    }
+    else
+    {
+        pending = true;
+        motion.dx = motion.dy = motion.hscroll = motion.vscroll = 0;
+    }
+
+    motion.device = mir_input_event_get_device_id(input_event);
+    motion.timestamp = std::chrono::nanoseconds{mir_input_event_get_event_time(input_event)};
+    motion.modifiers = mir_pointer_event_modifiers(event);
+    motion.buttons = buttons_of(event);
+    motion.x = mir_pointer_event_axis_value(event, mir_pointer_axis_x);
+    motion.y = mir_pointer_event_axis_value(event, mir_pointer_axis_y);
+    motion.hscroll += mir_pointer_event_axis_value(event, mir_pointer_axis_hscroll);
+    motion.vscroll += mir_pointer_event_axis_value(event, mir_pointer_axis_vscroll);
+    motion.dx += mir_pointer_event_axis_value(event, mir_pointer_axis_relative_x);
+    motion.dy += mir_pointer_event_axis_value(event, mir_pointer_axis_relative_y);
+
+    motion_waiting.notify_one();
+}
+
+auto miral::PointerMotionCoalescer::take() -> mir::EventUPtr
+{
+    std::lock_guard<decltype(mutex)> lock{mutex};
+
+    if (!pending)
+        return mir::EventUPtr{nullptr, [](MirEvent*) {}};
+
+    pending = false;
+
+    return mev::make_event(
+        motion.device, motion.timestamp, no_cookie, motion.modifiers, mir_pointer_action_motion, motion.buttons,
+        motion.x, motion.y, motion.hscroll, motion.vscroll, motion.dx, motion.dy);
+}
+
+auto miral::PointerMotionCoalescer::merge(MirPointerEvent const* event) -> mir::EventUPtr
+{
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+
+        if (!pending)
+            return mir::EventUPtr{nullptr, [](MirEvent*) {}};
+    }
+
+    stash(event);
+    return take();
+}
+
+void miral::PointerMotionCoalescer::start_delivery(std::function<void()> const& deliver)
+{
+    std::lock_guard<decltype(mutex)> lock{mutex};
+
+    if (delivery.joinable())
+        return;
+
+    stopping = false;
+    delivery = std::thread{[this, deliver] { deliver_while_running(deliver); }};
+}
+
+void miral::PointerMotionCoalescer::stop_delivery()
+{
+    std::thread stopped;
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        stopping = true;
+        stopped.swap(delivery);
+    }
+
+    motion_waiting.notify_one();
+
+    if (stopped.joinable())
+        stopped.join();
+}
+
+void miral::PointerMotionCoalescer::deliver_while_running(std::function<void()> const& deliver)
+{
+    std::unique_lock<decltype(mutex)> lock{mutex};
+
+    for (;;)
+    {
+        // The predicate is checked under the lock, so motion stashed at any time is seen
+        motion_waiting.wait(lock, [this] { return pending || stopping; });
+
+        if (stopping)
+            return;
+
+        lock.unlock();
+
+        try
+        {
+            deliver();
+        }
+        catch (...)
+        {
+            mir::report_exception();
+        }
+
+        lock.lock();
+    }
+}
+
+auto miral::PointerMotionCoalescer::dropped() const -> std::uint64_t
+{
+    return dropped_count;
+}
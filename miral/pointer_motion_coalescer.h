@@ -0,0 +1,101 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_POINTER_MOTION_COALESCER_H
+#define MIRAL_POINTER_MOTION_COALESCER_H
+
+#include <mir/events/event_builders.h>
+#include <mir_toolkit/event.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace miral
+{
+/// Holds the motion-only pointer events (with no button held) that arrive while the
+/// window manager is busy.
+/// Consecutive motions are merged into one: the latest position, buttons and modifiers
+/// with the relative motion and scroll of all the merged events summed.
+/// Waiting motion is delivered by a thread of its own, so that it is the delivery thread
+/// (and not the input thread) that waits for the window manager.
+class PointerMotionCoalescer
+{
+public:
+    ~PointerMotionCoalescer();
+
+    /// Only pure motion with no button held can be coalesced - button transitions etc.
+    /// are always delivered. (Motion with a button held may be a drag the policy consumes,
+    /// e.g. an Alt-drag or titlebar drag, so the policy has to decide before the client
+    /// gets it.)
+    static auto can_coalesce(MirPointerEvent const* event) -> bool;
+
+    /// Merge event with any motion already waiting
+    void stash(MirPointerEvent const* event);
+
+    /// \return the waiting motion as a single event (or null if there is none)
+    auto take() -> mir::EventUPtr;
+
+    /// \return event merged with the waiting motion (or null if there is none, and event
+    /// can be used as it is)
+    auto merge(MirPointerEvent const* event) -> mir::EventUPtr;
+
+    /// Start a thread that calls deliver() whenever motion is waiting.
+    /// deliver() is expected to take() the motion (once it holds any lock it needs).
+    void start_delivery(std::function<void()> const& deliver);
+
+    /// Stop the delivery thread, waiting for any delivery in progress.
+    /// \note not to be called while holding a lock deliver() needs
+    void stop_delivery();
+
+    /// The number of motion events merged into a later one
+    auto dropped() const -> std::uint64_t;
+
+private:
+    struct Motion
+    {
+        MirInputDeviceId device;
+        std::chrono::nanoseconds timestamp;
+        MirInputEventModifiers modifiers;
+        MirPointerButtons buttons;
+        float x;
+        float y;
+        float hscroll;
+        float vscroll;
+        float dx;
+        float dy;
+    };
+
+    std::mutex mutable mutex;
+    std::condition_variable motion_waiting;
+    bool pending{false};
+    bool stopping{false};
+    Motion motion;
+
+    std::thread delivery;
+
+    std::atomic<std::uint64_t> dropped_count{0};
+
+    void deliver_while_running(std::function<void()> const& deliver);
+};
+}
+
+#endif //MIRAL_POINTER_MOTION_COALESCER_H
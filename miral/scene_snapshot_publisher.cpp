@@ -0,0 +1,190 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "scene_snapshot_publisher.h"
+#include "window_manager_tools_implementation.h"
+
+#include "miral/application_info.h"
+#include "miral/window_info.h"
+
+#include <atomic>
+#include <stdexcept>
+
+miral::SceneSnapshotPublisher::SceneSnapshotPublisher() :
+    published{std::make_shared<SceneSnapshot>(SceneSnapshot{
+        0, {}, {}, std::make_shared<std::vector<ApplicationSnapshot> const>()})}
+{
+}
+
+void miral::SceneSnapshotPublisher::window_changed(Window const& window)
+{
+    changed.insert(window);
+}
+
+void miral::SceneSnapshotPublisher::window_removed(Window const& window)
+{
+    changed.erase(window);
+    removed.insert(window);
+}
+
+void miral::SceneSnapshotPublisher::applications_changed()
+{
+    applications_dirty = true;
+}
+
+void miral::SceneSnapshotPublisher::publish(WindowManagerToolsImplementation& tools)
+{
+    auto const active_window = tools.active_window();
+
+    if (changed.empty() && removed.empty() && !applications_dirty && active_window == published->active_window)
+        return;
+
+    auto const next = std::make_shared<SceneSnapshot>(*published);
+    auto& windows = next->windows;
+
+    next->version = published->version + 1;
+    next->active_window = active_window;
+
+    auto const remove = [&](Window const& window)
+        {
+            auto const i = index.find(window);
+
+            if (i == index.end())
+                return;
+
+            auto const position = i->second;
+            index.erase(i);
+
+            auto const last = windows.size() - 1;
+
+            if (position != last)
+            {
+                writable(windows, position) = windows[last];
+                index[windows[position]->window] = position;
+            }
+
+            pop_back(windows);
+        };
+
+    for (auto const& window : removed)
+        remove(window);
+
+    for (auto const& window : changed)
+    {
+        // This runs as a transaction ends (from ~Locker) so it mustn't throw: a window
+        // that is no longer known is treated as removed
+        WindowInfo const* info_ptr;
+
+        try
+        {
+            info_ptr = &tools.info_for(window);
+        }
+        catch (std::out_of_range const&)
+        {
+            remove(window);
+            continue;
+        }
+
+        auto const& info = *info_ptr;
+
+        auto record = std::make_shared<WindowSnapshot const>(WindowSnapshot{
+            window,
+            info.parent(),
+            info.name(),
+            info.type(),
+            info.state(),
+            window.top_left(),
+            window.size(),
+            next->version});
+
+        auto const i = index.find(window);
+
+        if (i != index.end())
+        {
+            writable(windows, i->second) = std::move(record);
+        }
+        else
+        {
+            index[window] = windows.size();
+            push_back(windows, std::move(record));
+        }
+    }
+
+    if (applications_dirty)
+    {
+        auto const applications = std::make_shared<std::vector<ApplicationSnapshot>>();
+
+        tools.for_each_application([&](ApplicationInfo& info)
+            {
+                auto const application = info.application();
+                applications->push_back(ApplicationSnapshot{application, pid_of(application), info.name()});
+            });
+
+        next->applications = applications;
+    }
+
+    changed.clear();
+    removed.clear();
+    applications_dirty = false;
+
+    std::atomic_store(&published, std::shared_ptr<SceneSnapshot const>{next});
+}
+
+auto miral::SceneSnapshotPublisher::writable(WindowSnapshots& windows, std::size_t position)
+-> WindowSnapshots::value_type&
+{
+    auto& chunk = windows.chunks[position/WindowSnapshots::chunk_size];
+
+    // The published snapshot (and any reader) shares the chunk until it is copied here
+    if (chunk.use_count() > 1)
+        chunk = std::make_shared<WindowSnapshots::Chunk>(*chunk);
+
+    return (*chunk)[position%WindowSnapshots::chunk_size];
+}
+
+void miral::SceneSnapshotPublisher::push_back(WindowSnapshots& windows, WindowSnapshots::value_type record)
+{
+    if (windows.count%WindowSnapshots::chunk_size == 0)
+    {
+        windows.chunks.push_back(std::make_shared<WindowSnapshots::Chunk>());
+        windows.chunks.back()->reserve(WindowSnapshots::chunk_size);
+    }
+    else
+    {
+        writable(windows, windows.count - 1);
+    }
+
+    windows.chunks.back()->push_back(std::move(record));
+    ++windows.count;
+}
+
+void miral::SceneSnapshotPublisher::pop_back(WindowSnapshots& windows)
+{
+    writable(windows, windows.count - 1);
+    windows.chunks.back()->pop_back();
+
+    if (windows.chunks.back()->empty())
+        windows.chunks.pop_back();
+
+    --windows.count;
+}
+
+auto miral::SceneSnapshotPublisher::snapshot() const -> std::shared_ptr<SceneSnapshot const>
+{
+    return std::atomic_load(&published);
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_SCENE_SNAPSHOT_PUBLISHER_H
+#define MIRAL_SCENE_SNAPSHOT_PUBLISHER_H
+
+#include "miral/scene_snapshot.h"
+
+#include <unordered_map>
+#include <unordered_set>
+
+namespace miral
+{
+class WindowManagerToolsImplementation;
+
+/// Maintains the SceneSnapshot published by the window manager.
+/// Changes are noted as they happen and applied to a copy of the previous snapshot on publish():
+/// the records for unchanged windows are shared, not rebuilt, and only the chunks of the
+/// WindowSnapshots holding changed records are copied.
+class SceneSnapshotPublisher
+{
+public:
+    SceneSnapshotPublisher();
+
+    void window_changed(Window const& window);
+    void window_removed(Window const& window);
+    void applications_changed();
+
+    /// Publish a new snapshot if the model has changed. Must be called with the model locked.
+    void publish(WindowManagerToolsImplementation& tools);
+
+    /// The most recently published snapshot. May be called from any thread.
+    auto snapshot() const -> std::shared_ptr<SceneSnapshot const>;
+
+private:
+    // Copy on write: the chunk holding position is copied unless only windows has it
+    static auto writable(WindowSnapshots& windows, std::size_t position) -> WindowSnapshots::value_type&;
+    static void push_back(WindowSnapshots& windows, WindowSnapshots::value_type record);
+    static void pop_back(WindowSnapshots& windows);
+
+    std::shared_ptr<SceneSnapshot const> published;
+
+    std::unordered_set<Window> changed;
+    std::unordered_set<Window> removed;
+    bool applications_dirty{false};
+
+    // The position of each window's record in the published windows
+    std::unordered_map<Window, std::size_t> index;
+};
+}
+
+#endif //MIRAL_SCENE_SNAPSHOT_PUBLISHER_H
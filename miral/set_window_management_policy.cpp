@@ -17,8 +17,7 @@
  */
 
 #include "miral/set_window_management_policy.h"
-#include "basic_window_manager.h"
-#include "window_management_trace.h"
+#include "instrumented_window_manager.h"
 #include "both_versions.h"
 
 #include <mir/server.h>
@@ -27,11 +26,6 @@
 
 namespace msh = mir::shell;
 
-namespace
-{
-char const* const trace_option = "window-management-trace";
-}
-
 MIRAL_FAKE_OLD_SYMBOL(
     _ZN5miral24SetWindowManagmentPolicyC1ERKSt8functionIFSt10unique_ptrINS_22WindowManagementPolicyESt14default_deleteIS3_EERKNS_18WindowManagerToolsEEE,
     _ZN5miral25SetWindowManagementPolicyC1ERKSt8functionIFSt10unique_ptrINS_22WindowManagementPolicyESt14default_deleteIS3_EERKNS_18WindowManagerToolsEEE)
@@ -57,29 +51,11 @@ miral::SetWindowManagementPolicy::~SetWindowManagementPolicy() = default;
 
 void miral::SetWindowManagementPolicy::operator()(mir::Server& server) const
 {
-    server.add_configuration_option(trace_option, "log trace message", mir::OptionType::null);
+    add_window_management_instrumentation_options(server);
 
     server.override_the_window_manager_builder([this, &server](msh::FocusController* focus_controller)
         -> std::shared_ptr<msh::WindowManager>
         {
-            auto const display_layout = server.the_shell_display_layout();
-
-#if MIR_SERVER_VERSION >= MIR_VERSION_NUMBER(0, 24, 0)
-            auto const persistent_surface_store = server.the_persistent_surface_store();
-#else
-            std::shared_ptr<mir::shell::PersistentSurfaceStore> const persistent_surface_store;
-#endif
-
-            if (server.get_options()->is_set(trace_option))
-            {
-                auto trace_builder = [this](WindowManagerTools const& tools) -> std::unique_ptr<miral::WindowManagementPolicy>
-                    {
-                        return std::make_unique<WindowManagementTrace>(tools, builder);
-                    };
-
-                return std::make_shared<BasicWindowManager>(focus_controller, display_layout, persistent_surface_store, trace_builder);
-            }
-
-            return std::make_shared<BasicWindowManager>(focus_controller, display_layout, persistent_surface_store, builder);
+            return build_instrumented_window_manager(server, focus_controller, builder);
         });
 }
@@ -0,0 +1,130 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "surface_cache.h"
+#include "window_self.h"
+
+#include <mir/scene/surface.h>
+
+void miral::SurfaceCache::attach(Window const& window)
+{
+    auto const& self = window_self(window);
+
+    if (!self) return;
+
+    if (auto const surface = self->surface.lock())
+    {
+        surface->add_observer(std::shared_ptr<SurfaceCache>{new SurfaceCache{self}});
+
+        self->cache_geometry_from(*surface);
+        self->cache_attributes_from(*surface);
+        self->cached = true;
+    }
+}
+
+void miral::SurfaceCache::refresh(Window const& window)
+{
+    auto const& self = window_self(window);
+
+    if (!self) return;
+
+    if (auto const surface = self->surface.lock())
+    {
+        self->cache_geometry_from(*surface);
+        self->cache_attributes_from(*surface);
+    }
+}
+
+auto miral::SurfaceCache::state(Window const& window) -> MirWindowState
+{
+    auto const& self = window_self(window);
+
+    if (!self || self->surface.expired())
+        return mir_window_state_unknown;
+
+    if (self->cached)
+        return self->cached_state;
+
+    if (auto const surface = self->surface.lock())
+        return surface->state();
+
+    return mir_window_state_unknown;
+}
+
+auto miral::SurfaceCache::visible(Window const& window) -> bool
+{
+    auto const& self = window_self(window);
+
+    if (!self || self->surface.expired())
+        return false;
+
+    if (self->cached)
+        return self->cached_visible;
+
+    if (auto const surface = self->surface.lock())
+        return surface->visible();
+
+    return false;
+}
+
+miral::SurfaceCache::SurfaceCache(std::weak_ptr<WindowSelf> const& window) :
+    window{window}
+{
+}
+
+void miral::SurfaceCache::attrib_changed(MirWindowAttrib attrib, int value)
+{
+    if (attrib != mir_window_attrib_state)
+        return;
+
+    if (auto const self = window.lock())
+        self->cached_state = MirWindowState(value);
+}
+
+void miral::SurfaceCache::resized_to(mir::geometry::Size const& size)
+{
+    if (auto const self = window.lock())
+        self->cached_size = size;
+}
+
+void miral::SurfaceCache::moved_to(mir::geometry::Point const& top_left)
+{
+    if (auto const self = window.lock())
+        self->cached_top_left = top_left;
+}
+
+void miral::SurfaceCache::hidden_set_to(bool /*hide*/)
+{
+    refresh_visibility();
+}
+
+void miral::SurfaceCache::frame_posted(int /*frames_available*/, mir::geometry::Size const& /*size*/)
+{
+    // Only the first frame can change visibility
+    if (!first_frame_posted.exchange(true))
+        refresh_visibility();
+}
+
+void miral::SurfaceCache::refresh_visibility()
+{
+    if (auto const self = window.lock())
+    {
+        if (auto const surface = self->surface.lock())
+            self->cached_visible = surface->visible();
+    }
+}
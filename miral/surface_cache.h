@@ -0,0 +1,67 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_SURFACE_CACHE_H
+#define MIRAL_SURFACE_CACHE_H
+
+#include "window_self.h"
+
+#include <mir/scene/null_surface_observer.h>
+
+#include <atomic>
+
+namespace miral
+{
+/// Keeps the surface attributes cached in a Window (geometry, state and visibility)
+/// current with its surface, so that MiRAL's hot paths read plain values instead of
+/// locking the surface for a virtual call.
+/// Changes made by the window manager are cached as it makes them; the observer
+/// picks up those made elsewhere (e.g. a client posting its first frame).
+class SurfaceCache : public mir::scene::NullSurfaceObserver
+{
+public:
+    /// Prime the cache of window and observe its surface to keep it current.
+    /// (Call before anything other than the window manager can change the surface.)
+    static void attach(Window const& window);
+
+    /// Re-read the cached attributes after changing the surface directly
+    static void refresh(Window const& window);
+
+    /// \return the state of the surface (mir_window_state_unknown if it has gone)
+    static auto state(Window const& window) -> MirWindowState;
+
+    /// \return the visibility of the surface (false if it has gone)
+    static auto visible(Window const& window) -> bool;
+
+    void attrib_changed(MirWindowAttrib attrib, int value) override;
+    void resized_to(mir::geometry::Size const& size) override;
+    void moved_to(mir::geometry::Point const& top_left) override;
+    void hidden_set_to(bool hide) override;
+    void frame_posted(int frames_available, mir::geometry::Size const& size) override;
+
+private:
+    explicit SurfaceCache(std::weak_ptr<WindowSelf> const& window);
+
+    std::weak_ptr<WindowSelf> const window;
+    std::atomic<bool> first_frame_posted{false};
+
+    void refresh_visibility();
+};
+}
+
+#endif //MIRAL_SURFACE_CACHE_H
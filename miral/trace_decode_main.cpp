@@ -0,0 +1,69 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "trace_ring_buffer.h"
+
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+auto timestamp(std::uint64_t nanoseconds) -> std::string
+{
+    time_t const seconds = nanoseconds/1000000000;
+    auto const microseconds = (nanoseconds % 1000000000)/1000;
+
+    tm local;
+    localtime_r(&seconds, &local);
+
+    char buffer[32];
+    strftime(buffer, sizeof buffer, "%Y-%m-%d %H:%M:%S", &local);
+
+    std::ostringstream out;
+    out << buffer << '.' << std::setw(6) << std::setfill('0') << microseconds;
+    return out.str();
+}
+}
+
+// Decodes a binary trace (written with --window-management-trace-file) into the
+// same text that --window-management-trace logs.
+int main(int argc, char const* argv[])
+try
+{
+    if (argc != 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <trace file>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    for (auto const& entry : miral::trace::read_entries(argv[1]))
+    {
+        std::cout << '[' << timestamp(entry.timestamp) << "] <information> miral::Window Management: "
+                  << miral::trace::format(entry) << '\n';
+    }
+
+    return EXIT_SUCCESS;
+}
+catch (std::exception const& error)
+{
+    std::cerr << argv[0] << ": " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
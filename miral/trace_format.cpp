@@ -0,0 +1,766 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "trace_format.h"
+
+#include <miral/application_info.h>
+#include <miral/window_info.h>
+#include <miral/window_specification.h>
+
+#include <mir/scene/session.h>
+#include <mir/scene/surface.h>
+#include <mir/event_printer.h>
+
+#include <boost/throw_exception.hpp>
+
+#include <cstdio>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace trace = miral::trace;
+
+using mir::operator<<;
+
+namespace
+{
+std::string const null_ptr{"(null)"};
+
+// Written before each value so that it can be formatted without knowing the call it came from
+enum class Tag : std::uint8_t
+{
+    text,
+    integer,
+    pointer,
+    point,
+    size,
+    displacement,
+    rectangle,
+    window_state,
+    windows,
+    window_info,
+    application_info,
+    specification,
+    keyboard_event,
+    touch_event,
+    pointer_event
+};
+
+using DeviceId = decltype(mir_input_event_get_device_id(nullptr));
+using Modifiers = decltype(mir_pointer_event_modifiers(nullptr));
+using KeyCode = decltype(mir_keyboard_event_key_code(nullptr));
+using ScanCode = decltype(mir_keyboard_event_scan_code(nullptr));
+using TouchCount = decltype(mir_touch_event_point_count(nullptr));
+using TouchId = decltype(mir_touch_event_id(nullptr, 0));
+using Axis = decltype(mir_pointer_event_axis_value(nullptr, mir_pointer_axis_x));
+
+auto operator<< (std::ostream& out, miral::WindowSpecification::AspectRatio const& ratio) -> std::ostream&;
+
+struct BracedItemStream
+{
+    BracedItemStream(std::ostream& out) : out{out} { out << '{'; }
+    ~BracedItemStream() { out << '}'; }
+    bool mutable first_field = true;
+    std::ostream& out;
+
+    template<typename Type>
+    auto append(Type const& item) const -> BracedItemStream const&
+    {
+        if (!first_field) out << ", ";
+        out << item;
+        first_field = false;
+        return *this;
+    }
+
+    template<typename Type>
+    auto append(char const* name, Type const& item) const -> BracedItemStream const&
+    {
+        if (!first_field) out << ", ";
+        out << name << '=' << item;
+        first_field = false;
+        return *this;
+    }
+
+    auto append(char const* name, MirOrientationMode item) const -> BracedItemStream const&
+    {
+        auto const flags = out.flags();
+        auto const prec  = out.precision();
+        auto const fill  = out.fill();
+
+        if (!first_field) out << ", ";
+        out << name << '=' << std::showbase << std::internal << std::setfill('0') << std::setw(2) << std::hex << item;
+        first_field = false;
+
+        out.flags(flags);
+        out.precision(prec);
+        out.fill(fill);
+        return *this;
+    }
+};
+
+auto operator<< (std::ostream& out, miral::WindowSpecification::AspectRatio const& ratio) -> std::ostream&
+{
+    BracedItemStream{out}.append(ratio.width).append(ratio.height);
+    return out;
+}
+
+template<typename Type>
+auto streamed(Type const& value) -> std::string
+{
+    std::stringstream out;
+    out << value;
+    return out.str();
+}
+
+// The encoding of the parts of a value...
+template<typename Type>
+auto put(trace::Writer& out, Type value) -> typename std::enable_if<std::is_arithmetic<Type>::value || std::is_enum<Type>::value>::type
+{
+    out.put(value);
+}
+
+void put(trace::Writer& out, std::string const& text) { out.put_text(text); }
+void put(trace::Writer& out, mir::geometry::Width value) { out.put(value.as_int()); }
+void put(trace::Writer& out, mir::geometry::Height value) { out.put(value.as_int()); }
+void put(trace::Writer& out, mir::geometry::DeltaX value) { out.put(value.as_int()); }
+void put(trace::Writer& out, mir::geometry::DeltaY value) { out.put(value.as_int()); }
+
+void put(trace::Writer& out, mir::geometry::Point value)
+{
+    out.put(value.x.as_int());
+    out.put(value.y.as_int());
+}
+
+void put(trace::Writer& out, mir::geometry::Size value)
+{
+    out.put(value.width.as_int());
+    out.put(value.height.as_int());
+}
+
+void put(trace::Writer& out, mir::geometry::Displacement value)
+{
+    out.put(value.dx.as_int());
+    out.put(value.dy.as_int());
+}
+
+void put(trace::Writer& out, mir::geometry::Rectangle const& value)
+{
+    put(out, value.top_left);
+    put(out, value.size);
+}
+
+void put(trace::Writer& out, miral::WindowSpecification::AspectRatio value)
+{
+    out.put(value.width);
+    out.put(value.height);
+}
+
+void put(trace::Writer& out, miral::Window const& window)
+{
+    if (std::shared_ptr<mir::scene::Surface> surface = window)
+        out.put_text(surface->name());
+    else
+        out.put_text(null_ptr);
+}
+
+void put(trace::Writer& out, std::vector<miral::Window> const& windows)
+{
+    out.put(static_cast<std::uint32_t>(windows.size()));
+
+    for (auto const& window : windows)
+        put(out, window);
+}
+
+template<typename Type>
+void put_if_set(trace::Writer& out, mir::optional_value<Type> const& value)
+{
+    out.put(value.is_set());
+    if (value.is_set()) put(out, value.value());
+}
+
+// ...and the corresponding decoding
+template<typename Type>
+auto get(trace::Reader& in, Type& value) -> typename std::enable_if<std::is_arithmetic<Type>::value || std::is_enum<Type>::value>::type
+{
+    value = in.get<Type>();
+}
+
+void get(trace::Reader& in, std::string& value) { value = in.get_text(); }
+
+template<typename Dimension>
+auto get(trace::Reader& in, Dimension& value) -> decltype(value.as_int(), void())
+{
+    value = Dimension{in.get<decltype(value.as_int())>()};
+}
+
+void get(trace::Reader& in, mir::geometry::Point& value)
+{
+    get(in, value.x);
+    get(in, value.y);
+}
+
+void get(trace::Reader& in, mir::geometry::Size& value)
+{
+    get(in, value.width);
+    get(in, value.height);
+}
+
+void get(trace::Reader& in, mir::geometry::Displacement& value)
+{
+    get(in, value.dx);
+    get(in, value.dy);
+}
+
+void get(trace::Reader& in, mir::geometry::Rectangle& value)
+{
+    get(in, value.top_left);
+    get(in, value.size);
+}
+
+void get(trace::Reader& in, miral::WindowSpecification::AspectRatio& value)
+{
+    get(in, value.width);
+    get(in, value.height);
+}
+
+template<typename Type>
+auto get(trace::Reader& in) -> Type
+{
+    Type result{};
+    get(in, result);
+    return result;
+}
+
+auto format_windows(trace::Reader& in) -> std::string
+{
+    std::stringstream out;
+
+    {
+        BracedItemStream bout{out};
+
+        for (auto count = in.get<std::uint32_t>(); count--;)
+            bout.append(in.get_text());
+    }
+
+    return out.str();
+}
+
+template<typename Type>
+void append_if_set(trace::Reader& in, BracedItemStream const& bout, char const* name)
+{
+    if (in.get<bool>())
+        bout.append(name, get<Type>(in));
+}
+
+void encode_window_info(trace::Writer& out, miral::WindowInfo const& info)
+{
+    put(out, info.name());
+    put(out, info.type());
+    put(out, info.state());
+    put(out, info.restore_rect());
+
+    if (std::shared_ptr<mir::scene::Surface> parent = info.parent())
+    {
+        out.put(true);
+        put(out, parent->name());
+    }
+    else
+    {
+        out.put(false);
+    }
+
+    put(out, info.children());
+    put(out, info.min_width());
+    put(out, info.min_height());
+    put(out, info.max_width());
+    put(out, info.max_height());
+    put(out, info.width_inc());
+    put(out, info.height_inc());
+    put(out, info.min_aspect());
+    put(out, info.max_aspect());
+    put(out, info.preferred_orientation());
+    put(out, info.confine_pointer());
+    out.put(info.has_output_id());
+    if (info.has_output_id()) put(out, info.output_id());
+}
+
+auto format_window_info(trace::Reader& in) -> std::string
+{
+    using namespace mir::geometry;
+    using AspectRatio = miral::WindowInfo::AspectRatio;
+
+    std::stringstream out;
+    {
+        BracedItemStream bout{out};
+
+        bout.append("name", get<std::string>(in));
+        bout.append("type", get<MirWindowType>(in));
+        auto const state = get<MirWindowState>(in);
+        bout.append("state", state);
+        auto const restore_rect = get<Rectangle>(in);
+        if (state != mir_window_state_restored) bout.append("restore_rect", restore_rect);
+        append_if_set<std::string>(in, bout, "parent");
+        bout.append("children", format_windows(in));
+        auto const min_width = get<Width>(in);
+        if (min_width  != Width{0}) bout.append("min_width", min_width);
+        auto const min_height = get<Height>(in);
+        if (min_height != Height{0}) bout.append("min_height", min_height);
+        auto const max_width = get<Width>(in);
+        if (max_width  != Width{std::numeric_limits<int>::max()}) bout.append("max_width", max_width);
+        auto const max_height = get<Height>(in);
+        if (max_height != Height{std::numeric_limits<int>::max()}) bout.append("max_height", max_height);
+        auto const width_inc = get<DeltaX>(in);
+        if (width_inc  != DeltaX{1}) bout.append("width_inc", width_inc);
+        auto const height_inc = get<DeltaY>(in);
+        if (height_inc != DeltaY{1}) bout.append("height_inc", height_inc);
+        auto const min_aspect = get<AspectRatio>(in);
+        if (min_aspect.width != 0U || min_aspect.height != std::numeric_limits<unsigned>::max())
+            bout.append("min_aspect", min_aspect);
+        auto const max_aspect = get<AspectRatio>(in);
+        if (max_aspect.width != std::numeric_limits<unsigned>::max() || max_aspect.height != 0U)
+            bout.append("max_aspect", max_aspect);
+        bout.append("preferred_orientation", get<MirOrientationMode>(in));
+        bout.append("confine_pointer", get<MirPointerConfinementState>(in));
+        append_if_set<int>(in, bout, "output_id");
+    }
+
+    return out.str();
+}
+
+void encode_specification(trace::Writer& out, miral::WindowSpecification const& specification)
+{
+    put_if_set(out, specification.name());
+    put_if_set(out, specification.type());
+    put_if_set(out, specification.top_left());
+    put_if_set(out, specification.size());
+    put_if_set(out, specification.output_id());
+    put_if_set(out, specification.state());
+    put_if_set(out, specification.preferred_orientation());
+    put_if_set(out, specification.aux_rect());
+    put_if_set(out, specification.placement_hints());
+    put_if_set(out, specification.window_placement_gravity());
+    put_if_set(out, specification.aux_rect_placement_gravity());
+    put_if_set(out, specification.aux_rect_placement_offset());
+    put_if_set(out, specification.min_width());
+    put_if_set(out, specification.min_height());
+    put_if_set(out, specification.max_width());
+    put_if_set(out, specification.max_height());
+    put_if_set(out, specification.width_inc());
+    put_if_set(out, specification.height_inc());
+    put_if_set(out, specification.min_aspect());
+    put_if_set(out, specification.max_aspect());
+
+    std::shared_ptr<mir::scene::Surface> parent;
+    if (specification.parent().is_set())
+        parent = specification.parent().value().lock();
+    out.put(parent != nullptr);
+    if (parent) put(out, parent->name());
+
+    put_if_set(out, specification.shell_chrome());
+    put_if_set(out, specification.confine_pointer());
+}
+
+auto format_specification(trace::Reader& in) -> std::string
+{
+    using namespace mir::geometry;
+    using AspectRatio = miral::WindowSpecification::AspectRatio;
+
+    std::stringstream out;
+    {
+        BracedItemStream bout{out};
+
+        append_if_set<std::string>(in, bout, "name");
+        append_if_set<MirWindowType>(in, bout, "type");
+        append_if_set<Point>(in, bout, "top_left");
+        append_if_set<Size>(in, bout, "size");
+        append_if_set<int>(in, bout, "output_id");
+        append_if_set<MirWindowState>(in, bout, "state");
+        append_if_set<MirOrientationMode>(in, bout, "preferred_orientation");
+        append_if_set<Rectangle>(in, bout, "aux_rect");
+        append_if_set<MirPlacementHints>(in, bout, "placement_hints");
+        append_if_set<MirPlacementGravity>(in, bout, "window_placement_gravity");
+        append_if_set<MirPlacementGravity>(in, bout, "aux_rect_placement_gravity");
+        append_if_set<Displacement>(in, bout, "aux_rect_placement_offset");
+        append_if_set<Width>(in, bout, "min_width");
+        append_if_set<Height>(in, bout, "min_height");
+        append_if_set<Width>(in, bout, "max_width");
+        append_if_set<Height>(in, bout, "max_height");
+        append_if_set<DeltaX>(in, bout, "width_inc");
+        append_if_set<DeltaY>(in, bout, "height_inc");
+        append_if_set<AspectRatio>(in, bout, "min_aspect");
+        append_if_set<AspectRatio>(in, bout, "max_aspect");
+        append_if_set<std::string>(in, bout, "parent");
+        append_if_set<MirShellChrome>(in, bout, "shell_chrome");
+        append_if_set<MirPointerConfinementState>(in, bout, "confine_pointer");
+    }
+
+    return out.str();
+}
+
+void encode_keyboard_event(trace::Writer& out, MirKeyboardEvent const* event)
+{
+    put(out, mir_input_event_get_device_id(mir_keyboard_event_input_event(event)));
+    put(out, mir_keyboard_event_action(event));
+    put(out, mir_keyboard_event_key_code(event));
+    put(out, mir_keyboard_event_scan_code(event));
+    put(out, mir_keyboard_event_modifiers(event));
+}
+
+auto format_keyboard_event(trace::Reader& in) -> std::string
+{
+    std::stringstream out;
+
+    {
+        BracedItemStream bout{out};
+
+        bout.append("from", get<DeviceId>(in));
+        bout.append("action", get<MirKeyboardAction>(in));
+        bout.append("code", get<KeyCode>(in));
+        bout.append("scan", get<ScanCode>(in));
+
+        out.setf(std::ios_base::hex, std::ios_base::basefield);
+        bout.append(std::hex).append("modifiers", get<Modifiers>(in));
+    }
+
+    return out.str();
+}
+
+void encode_touch_event(trace::Writer& out, MirTouchEvent const* event)
+{
+    auto const count = mir_touch_event_point_count(event);
+
+    put(out, mir_input_event_get_device_id(mir_touch_event_input_event(event)));
+    put(out, count);
+
+    for (auto index = 0U; index != count; ++index)
+    {
+        put(out, mir_touch_event_id(event, index));
+        put(out, mir_touch_event_action(event, index));
+        put(out, mir_touch_event_tooltype(event, index));
+        put(out, mir_touch_event_axis_value(event, index, mir_touch_axis_x));
+        put(out, mir_touch_event_axis_value(event, index, mir_touch_axis_y));
+        put(out, mir_touch_event_axis_value(event, index, mir_touch_axis_pressure));
+        put(out, mir_touch_event_axis_value(event, index, mir_touch_axis_touch_major));
+        put(out, mir_touch_event_axis_value(event, index, mir_touch_axis_touch_minor));
+        put(out, mir_touch_event_axis_value(event, index, mir_touch_axis_size));
+    }
+
+    put(out, mir_touch_event_modifiers(event));
+}
+
+auto format_touch_event(trace::Reader& in) -> std::string
+{
+    std::stringstream out;
+
+    {
+        BracedItemStream bout{out};
+
+        bout.append("from", get<DeviceId>(in));
+
+        for (auto count = get<TouchCount>(in); count--;)
+        {
+            BracedItemStream touch{out};
+            touch.append("id", get<TouchId>(in));
+            touch.append("action", get<MirTouchAction>(in));
+            touch.append("tool", get<MirTouchTooltype>(in));
+            touch.append("x", get<Axis>(in));
+            touch.append("y", get<Axis>(in));
+            touch.append("pressure", get<Axis>(in));
+            touch.append("major", get<Axis>(in));
+            touch.append("minor", get<Axis>(in));
+            touch.append("size", get<Axis>(in));
+        }
+
+        out.setf(std::ios_base::hex, std::ios_base::basefield);
+        bout.append("modifiers", get<Modifiers>(in));
+    }
+
+    return out.str();
+}
+
+void encode_pointer_event(trace::Writer& out, MirPointerEvent const* event)
+{
+    unsigned int button_state = 0;
+
+    for (auto const a : {mir_pointer_button_primary, mir_pointer_button_secondary, mir_pointer_button_tertiary,
+                         mir_pointer_button_back, mir_pointer_button_forward})
+        button_state |= mir_pointer_event_button_state(event, a) ? a : 0;
+
+    put(out, mir_input_event_get_device_id(mir_pointer_event_input_event(event)));
+    put(out, mir_pointer_event_action(event));
+    put(out, button_state);
+    put(out, mir_pointer_event_axis_value(event, mir_pointer_axis_x));
+    put(out, mir_pointer_event_axis_value(event, mir_pointer_axis_y));
+    put(out, mir_pointer_event_axis_value(event, mir_pointer_axis_relative_x));
+    put(out, mir_pointer_event_axis_value(event, mir_pointer_axis_relative_y));
+    put(out, mir_pointer_event_axis_value(event, mir_pointer_axis_vscroll));
+    put(out, mir_pointer_event_axis_value(event, mir_pointer_axis_hscroll));
+    put(out, mir_pointer_event_modifiers(event));
+}
+
+auto format_pointer_event(trace::Reader& in) -> std::string
+{
+    std::stringstream out;
+
+    {
+        BracedItemStream bout{out};
+
+        bout.append("from", get<DeviceId>(in));
+        bout.append("action", get<MirPointerAction>(in));
+        bout.append("button_state", get<unsigned int>(in));
+        bout.append("x", get<Axis>(in));
+        bout.append("y", get<Axis>(in));
+        bout.append("dx", get<Axis>(in));
+        bout.append("dy", get<Axis>(in));
+        bout.append("vscroll", get<Axis>(in));
+        bout.append("hscroll", get<Axis>(in));
+
+        out.setf(std::ios_base::hex, std::ios_base::basefield);
+        bout.append("modifiers", get<Modifiers>(in));
+    }
+
+    return out.str();
+}
+}
+
+auto trace::Reader::take(std::size_t length) -> char const*
+{
+    if (data.size() - position < length)
+        BOOST_THROW_EXCEPTION(std::runtime_error("Truncated trace entry"));
+
+    auto const result = data.data() + position;
+    position += length;
+    return result;
+}
+
+auto trace::Reader::get_text() -> std::string
+{
+    auto const length = get<std::uint32_t>();
+    return std::string(take(length), length);
+}
+
+void trace::encode(Writer& out, std::string const& text)
+{
+    out.put(Tag::text);
+    out.put_text(text);
+}
+
+void trace::encode(Writer& out, unsigned int value)
+{
+    out.put(Tag::integer);
+    out.put(static_cast<std::int64_t>(value));
+}
+
+void trace::encode(Writer& out, void const* pointer)
+{
+    out.put(Tag::pointer);
+    out.put(static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(pointer)));
+}
+
+void trace::encode(Writer& out, mir::geometry::Point point)
+{
+    out.put(Tag::point);
+    put(out, point);
+}
+
+void trace::encode(Writer& out, mir::geometry::Size size)
+{
+    out.put(Tag::size);
+    put(out, size);
+}
+
+void trace::encode(Writer& out, mir::geometry::Displacement displacement)
+{
+    out.put(Tag::displacement);
+    put(out, displacement);
+}
+
+void trace::encode(Writer& out, mir::geometry::Rectangle const& rect)
+{
+    out.put(Tag::rectangle);
+    put(out, rect);
+}
+
+void trace::encode(Writer& out, MirWindowState state)
+{
+    out.put(Tag::window_state);
+    put(out, state);
+}
+
+void trace::encode(Writer& out, Window const& window)
+{
+    out.put(Tag::text);
+    put(out, window);
+}
+
+void trace::encode(Writer& out, Application const& application)
+{
+    out.put(Tag::text);
+    out.put_text(application ? application->name() : null_ptr);
+}
+
+void trace::encode(Writer& out, std::vector<Window> const& windows)
+{
+    out.put(Tag::windows);
+    put(out, windows);
+}
+
+void trace::encode(Writer& out, WindowInfo const& info)
+{
+    out.put(Tag::window_info);
+    encode_window_info(out, info);
+}
+
+void trace::encode(Writer& out, ApplicationInfo const& info)
+{
+    auto const& application = info.application();
+
+    out.put(Tag::application_info);
+    out.put_text(application ? application->name() : null_ptr);
+    put(out, info.windows());
+}
+
+void trace::encode(Writer& out, WindowSpecification const& specification)
+{
+    out.put(Tag::specification);
+    encode_specification(out, specification);
+}
+
+void trace::encode(Writer& out, MirKeyboardEvent const* event)
+{
+    out.put(Tag::keyboard_event);
+    encode_keyboard_event(out, event);
+}
+
+void trace::encode(Writer& out, MirTouchEvent const* event)
+{
+    out.put(Tag::touch_event);
+    encode_touch_event(out, event);
+}
+
+void trace::encode(Writer& out, MirPointerEvent const* event)
+{
+    out.put(Tag::pointer_event);
+    encode_pointer_event(out, event);
+}
+
+auto trace::format_value(Reader& in) -> std::string
+{
+    switch (in.get<Tag>())
+    {
+    case Tag::text:
+        return in.get_text();
+
+    case Tag::integer:
+        return std::to_string(in.get<std::int64_t>());
+
+    case Tag::pointer:
+    {
+        char buffer[32];
+        snprintf(buffer, sizeof buffer, "%p", reinterpret_cast<void const*>(in.get<std::uint64_t>()));
+        return buffer;
+    }
+
+    case Tag::point:
+        return streamed(get<mir::geometry::Point>(in));
+
+    case Tag::size:
+        return streamed(get<mir::geometry::Size>(in));
+
+    case Tag::displacement:
+        return streamed(get<mir::geometry::Displacement>(in));
+
+    case Tag::rectangle:
+        return streamed(get<mir::geometry::Rectangle>(in));
+
+    case Tag::window_state:
+        return streamed(get<MirWindowState>(in));
+
+    case Tag::windows:
+        return format_windows(in);
+
+    case Tag::window_info:
+        return format_window_info(in);
+
+    case Tag::application_info:
+    {
+        std::stringstream out;
+        auto const application = in.get_text();
+
+        BracedItemStream{out}
+            .append("application", application)
+            .append("windows", format_windows(in));
+
+        return out.str();
+    }
+
+    case Tag::specification:
+        return format_specification(in);
+
+    case Tag::keyboard_event:
+        return format_keyboard_event(in);
+
+    case Tag::touch_event:
+        return format_touch_event(in);
+
+    case Tag::pointer_event:
+        return format_pointer_event(in);
+    }
+
+    BOOST_THROW_EXCEPTION(std::runtime_error("Unknown value in trace entry"));
+}
+
+void trace::encode(Writer& out, char const* function, std::initializer_list<Field> fields)
+{
+    out.put_text(function);
+    out.put(static_cast<std::uint8_t>(fields.size()));
+
+    for (auto const& field : fields)
+    {
+        out.put_text(field.label);
+        field.encode_value(out, field.value);
+    }
+}
+
+auto trace::format_entry(std::string const& data) -> std::string
+{
+    Reader in{data};
+    std::ostringstream out;
+    out << in.get_text();
+
+    auto separator = " ";
+
+    for (auto count = in.get<std::uint8_t>(); count--;)
+    {
+        auto const label = in.get_text();
+        auto const value = format_value(in);
+
+        if (label == "->")
+        {
+            out << " -> " << value;
+        }
+        else
+        {
+            out << separator << label << '=' << value;
+            separator = ", ";
+        }
+    }
+
+    return out.str();
+}
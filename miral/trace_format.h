@@ -0,0 +1,141 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_TRACE_FORMAT_H
+#define MIRAL_TRACE_FORMAT_H
+
+#include <miral/application.h>
+#include <miral/window.h>
+
+#include <mir/geometry/displacement.h>
+#include <mir/geometry/rectangle.h>
+#include <mir_toolkit/event.h>
+
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace miral
+{
+class ApplicationInfo;
+class WindowInfo;
+class WindowSpecification;
+
+/// The window management trace is encoded as typed values which are formatted
+/// only when the trace is logged as text or a binary trace is decoded. Both
+/// use the same formatting, so a decoded trace is the text that would be logged.
+namespace trace
+{
+class Writer
+{
+public:
+    void clear() { buffer.clear(); }
+
+    auto data() const -> std::string const& { return buffer; }
+
+    template<typename Type>
+    auto put(Type value) -> typename std::enable_if<std::is_arithmetic<Type>::value || std::is_enum<Type>::value>::type
+    {
+        buffer.append(reinterpret_cast<char const*>(&value), sizeof value);
+    }
+
+    void put_text(char const* text, std::size_t length)
+    {
+        put(static_cast<std::uint32_t>(length));
+        buffer.append(text, length);
+    }
+
+    void put_text(char const* text) { put_text(text, std::strlen(text)); }
+    void put_text(std::string const& text) { put_text(text.data(), text.size()); }
+
+private:
+    std::string buffer;
+};
+
+class Reader
+{
+public:
+    explicit Reader(std::string const& data) : data{data} {}
+
+    template<typename Type>
+    auto get() -> Type
+    {
+        Type result;
+        std::memcpy(&result, take(sizeof result), sizeof result);
+        return result;
+    }
+
+    auto get_text() -> std::string;
+
+private:
+    auto take(std::size_t length) -> char const*;
+
+    std::string const& data;
+    std::size_t position = 0;
+};
+
+void encode(Writer& out, std::string const& text);
+void encode(Writer& out, unsigned int value);
+void encode(Writer& out, void const* pointer);
+void encode(Writer& out, mir::geometry::Point point);
+void encode(Writer& out, mir::geometry::Size size);
+void encode(Writer& out, mir::geometry::Displacement displacement);
+void encode(Writer& out, mir::geometry::Rectangle const& rect);
+void encode(Writer& out, MirWindowState state);
+void encode(Writer& out, Window const& window);
+void encode(Writer& out, Application const& application);
+void encode(Writer& out, std::vector<Window> const& windows);
+void encode(Writer& out, WindowInfo const& info);
+void encode(Writer& out, ApplicationInfo const& info);
+void encode(Writer& out, WindowSpecification const& specification);
+void encode(Writer& out, MirKeyboardEvent const* event);
+void encode(Writer& out, MirTouchEvent const* event);
+void encode(Writer& out, MirPointerEvent const* event);
+
+/// Formats the next encoded value
+auto format_value(Reader& in) -> std::string;
+
+/// A labelled value, encoded when the trace entry it belongs to is written.
+/// (The value must outlive the entry - which is fine for the arguments of a call.)
+struct Field
+{
+    template<typename Type>
+    Field(char const* label, Type const& value) :
+        label{label},
+        value{&value},
+        encode_value{[](Writer& out, void const* value) { encode(out, *static_cast<Type const*>(value)); }}
+    {
+    }
+
+    char const* label;
+    void const* value;
+    void (*encode_value)(Writer& out, void const* value);
+};
+
+/// Encodes an entry: the name of the function traced and its fields
+void encode(Writer& out, char const* function, std::initializer_list<Field> fields);
+
+/// Formats an encoded entry as "function label=value, ... -> result"
+auto format_entry(std::string const& data) -> std::string;
+}
+}
+
+#endif //MIRAL_TRACE_FORMAT_H
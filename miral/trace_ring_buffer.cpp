@@ -0,0 +1,222 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "trace_ring_buffer.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <new>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace trace = miral::trace;
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "trace records are published with lock-free atomics");
+
+namespace
+{
+char const magic[8] = {'M', 'I', 'R', 'A', 'L', 'T', 'R', 'C'};
+std::uint32_t const version = 2;
+
+auto now() -> std::uint64_t
+{
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return ts.tv_sec*1000000000ULL + ts.tv_nsec;
+}
+
+auto thread_id() -> std::uint32_t
+{
+    static thread_local std::uint32_t const id = syscall(SYS_gettid);
+    return id;
+}
+
+auto file_length(std::uint64_t capacity) -> std::size_t
+{
+    return sizeof(trace::FileHeader) + capacity*sizeof(trace::Record);
+}
+
+auto map_file(std::string const& path, std::size_t length) -> void*
+{
+    auto const fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+    if (fd < 0)
+        BOOST_THROW_EXCEPTION(std::system_error(errno, std::system_category(), "Failed to open trace file: " + path));
+
+    if (ftruncate(fd, length) < 0)
+    {
+        auto const error = errno;
+        close(fd);
+        BOOST_THROW_EXCEPTION(std::system_error(error, std::system_category(), "Failed to size trace file: " + path));
+    }
+
+    auto const mapping = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    auto const error = errno;
+    close(fd);
+
+    if (mapping == MAP_FAILED)
+        BOOST_THROW_EXCEPTION(std::system_error(error, std::system_category(), "Failed to map trace file: " + path));
+
+    return mapping;
+}
+}
+
+auto trace::read_entries(std::string const& path) -> std::vector<Entry>
+{
+    std::ifstream file{path, std::ios::binary};
+
+    if (!file)
+        BOOST_THROW_EXCEPTION(std::runtime_error("Failed to open trace file: " + path));
+
+    FileHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof header);
+
+    if (!file || std::memcmp(header.magic, magic, sizeof magic) != 0)
+        BOOST_THROW_EXCEPTION(std::runtime_error("Not a trace file: " + path));
+
+    if (header.version != version || header.record_size != sizeof(Record))
+        BOOST_THROW_EXCEPTION(std::runtime_error("Unsupported trace file version: " + path));
+
+    struct Part
+    {
+        std::uint64_t timestamp;
+        std::uint32_t thread;
+        std::uint16_t part;
+        std::uint16_t parts;
+        std::string payload;
+    };
+
+    std::map<std::uint64_t, Part> sequenced;
+
+    for (auto i = 0ULL; i != header.capacity; ++i)
+    {
+        Record record;
+        if (!file.read(reinterpret_cast<char*>(&record), sizeof record))
+            break;
+
+        // Records still being written (or never written) have a zero sequence
+        if (auto const sequence = record.sequence.load())
+        {
+            sequenced[sequence] = Part{record.timestamp, record.thread, record.part, record.parts,
+                std::string(record.payload, std::min<std::size_t>(record.size, record_payload))};
+        }
+    }
+
+    std::vector<Entry> result;
+
+    for (auto i = sequenced.begin(); i != sequenced.end(); ++i)
+    {
+        auto const& first = i->second;
+
+        if (first.part != 0)
+            continue;
+
+        Entry entry{first.timestamp, first.thread, {}};
+        auto part = 0U;
+
+        // An entry whose earlier parts were overwritten, or whose later parts are still being written, is skipped
+        for (auto j = i; j != sequenced.end() && j->first == i->first + part && j->second.part == part; ++j, ++part)
+            entry.data += j->second.payload;
+
+        if (part == first.parts)
+            result.push_back(std::move(entry));
+    }
+
+    return result;
+}
+
+auto trace::format(Entry const& entry) -> std::string
+{
+    return format_entry(entry.data);
+}
+
+miral::TraceRingBuffer::TraceRingBuffer(std::string const& path, std::uint64_t capacity) :
+    length{file_length(capacity)},
+    mapping{map_file(path, length)},
+    header{new (mapping) trace::FileHeader},
+    records{reinterpret_cast<trace::Record*>(static_cast<char*>(mapping) + sizeof(trace::FileHeader))}
+{
+    std::memcpy(header->magic, magic, sizeof magic);
+    header->version = version;
+    header->record_size = sizeof(trace::Record);
+    header->capacity = capacity;
+    header->next.store(0);
+
+    // The file is zero filled, so every record starts with an unused (zero) sequence
+    for (auto i = 0ULL; i != capacity; ++i)
+        new (records+i) trace::Record;
+}
+
+miral::TraceRingBuffer::~TraceRingBuffer()
+{
+    flush();
+    munmap(mapping, length);
+}
+
+void miral::TraceRingBuffer::record(char const* function, std::initializer_list<trace::Field> fields)
+{
+    static thread_local trace::Writer writer;
+    writer.clear();
+    trace::encode(writer, function, fields);
+
+    auto const& data = writer.data();
+    auto const parts = std::max<std::size_t>(1, (data.size() + trace::record_payload - 1)/trace::record_payload);
+
+    if (parts > header->capacity || parts > std::numeric_limits<std::uint16_t>::max())
+        return;
+
+    auto const timestamp = now();
+
+    // A writer would need to stall for a whole lap of the ring before another
+    // could claim the same records, so we don't guard against that.
+    auto const index = header->next.fetch_add(parts, std::memory_order_relaxed);
+
+    for (auto part = 0U; part != parts; ++part)
+    {
+        auto& record = records[(index + part) % header->capacity];
+
+        record.sequence.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        auto const offset = part*trace::record_payload;
+        record.timestamp = timestamp;
+        record.thread = thread_id();
+        record.part = part;
+        record.parts = parts;
+        record.size = std::min<std::size_t>(data.size() - offset, trace::record_payload);
+        std::memcpy(record.payload, data.data() + offset, record.size);
+
+        record.sequence.store(index + part + 1, std::memory_order_release);
+    }
+}
+
+void miral::TraceRingBuffer::flush()
+{
+    msync(mapping, length, MS_SYNC);
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_TRACE_RING_BUFFER_H
+#define MIRAL_TRACE_RING_BUFFER_H
+
+#include "trace_format.h"
+
+#include <atomic>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+namespace miral
+{
+namespace trace
+{
+/// The binary trace file is a header followed by a ring of fixed-size records.
+/// The file is a shared mapping so records written before a crash survive it.
+/// An entry (see trace_format.h) is split across as many consecutive records
+/// as it needs.
+int const record_payload = 356;
+
+struct Record
+{
+    std::atomic<std::uint64_t> sequence;    ///< zero while being written, otherwise index + 1
+    std::uint64_t timestamp;                ///< nanoseconds since the epoch
+    std::uint32_t thread;
+    std::uint16_t part;                     ///< of the entry, counting from 0
+    std::uint16_t parts;
+    std::uint32_t size;                     ///< bytes of payload used
+    char payload[record_payload];
+};
+
+struct FileHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t record_size;
+    std::uint64_t capacity;
+    std::atomic<std::uint64_t> next;
+    char reserved[32];
+};
+
+static_assert(sizeof(Record) == 384, "trace::Record is part of the file format");
+static_assert(sizeof(FileHeader) == 64, "trace::FileHeader is part of the file format");
+
+struct Entry
+{
+    std::uint64_t timestamp;
+    std::uint32_t thread;
+    std::string data;
+};
+
+/// Copies the complete entries from a trace file, oldest first
+auto read_entries(std::string const& path) -> std::vector<Entry>;
+
+/// Formats an entry as the text trace logs it
+auto format(Entry const& entry) -> std::string;
+}
+
+/// A lock-free ring of binary trace records in a memory mapped file.
+/// Writers never block each other: records are claimed with an atomic increment
+/// and their sequence numbers are published once they are complete.
+class TraceRingBuffer
+{
+public:
+    TraceRingBuffer(std::string const& path, std::uint64_t capacity);
+    ~TraceRingBuffer();
+
+    /// Entries that need more records than the ring holds are dropped
+    void record(char const* function, std::initializer_list<trace::Field> fields);
+
+    /// Synchronously writes the mapping to the file
+    void flush();
+
+    TraceRingBuffer(TraceRingBuffer const&) = delete;
+    TraceRingBuffer& operator=(TraceRingBuffer const&) = delete;
+
+private:
+    std::size_t const length;
+    void* const mapping;
+    trace::FileHeader* const header;
+    trace::Record* const records;
+};
+}
+
+#endif //MIRAL_TRACE_RING_BUFFER_H
@@ -16,22 +16,27 @@
  * Authored by: Alan Griffiths <alan@octopull.co.uk>
  */
 
-#include "miral/window.h"
+#include "window_self.h"
+#include "geometry_batch.h"
 
 #include <mir/scene/session.h>
 #include <mir/scene/surface.h>
 
-struct miral::Window::Self
-{
-    Self(std::shared_ptr<mir::scene::Session> const& session, std::shared_ptr<mir::scene::Surface> const& surface);
-
-    std::weak_ptr<mir::scene::Session> const session;
-    std::weak_ptr<mir::scene::Surface> const surface;
-};
-
 miral::Window::Self::Self(std::shared_ptr<mir::scene::Session> const& session, std::shared_ptr<mir::scene::Surface> const& surface) :
     session{session}, surface{surface} {}
 
+void miral::Window::Self::cache_geometry_from(mir::scene::Surface const& surface)
+{
+    cached_top_left = surface.top_left();
+    cached_size = surface.size();
+}
+
+void miral::Window::Self::cache_attributes_from(mir::scene::Surface const& surface)
+{
+    cached_state = surface.state();
+    cached_visible = surface.visible();
+}
+
 miral::Window::Window(Application const& application, std::shared_ptr<mir::scene::Surface> const& surface) :
     self{std::make_shared<Self>(application, surface)}
 {
@@ -45,7 +50,7 @@ miral::Window::~Window() = default;
 
 miral::Window::operator bool() const
 {
-    return !!operator std::shared_ptr<mir::scene::Surface>();
+    return self && !self->surface.expired();
 }
 
 miral::Window::operator std::shared_ptr<mir::scene::Surface>() const
@@ -63,15 +68,47 @@ miral::Window::operator std::weak_ptr<mir::scene::Surface>() const
 void miral::Window::resize(mir::geometry::Size const& size)
 {
     if (!self) return;
+
     if (auto const surface = self->surface.lock())
+    {
         surface->resize(size);
+        self->cache_geometry_from(*surface);
+    }
+
+    std::shared_ptr<GeometryBatch> batch;
+    {
+        // A direct change supersedes any the window manager has pending
+        std::lock_guard<std::mutex> lock{self->mutex};
+        self->pending_size = {};
+        self->has_pending = self->pending_top_left.is_set() || self->pending_size.is_set();
+        batch = self->batch.lock();
+    }
+
+    if (batch)
+        batch->changed_directly(*this);
 }
 
 void miral::Window::move_to(mir::geometry::Point top_left)
 {
     if (!self) return;
+
     if (auto const surface = self->surface.lock())
+    {
         surface->move_to(top_left);
+        self->cache_geometry_from(*surface);
+    }
+
+    std::shared_ptr<GeometryBatch> batch;
+    {
+        // A direct change supersedes any the window manager has pending
+        std::lock_guard<std::mutex> lock{self->mutex};
+        self->pending_top_left = {};
+        self->has_pending = self->pending_top_left.is_set() || self->pending_size.is_set();
+        batch = self->batch.lock();
+    }
+
+    if (batch)
+        batch->changed_directly(*this);
 }
 
 auto miral::Window::top_left() const
@@ -79,6 +116,17 @@ auto miral::Window::top_left() const
 {
     if (self)
     {
+        if (self->has_pending)
+        {
+            std::lock_guard<std::mutex> lock{self->mutex};
+
+            if (self->pending_top_left.is_set())
+                return self->pending_top_left.value();
+        }
+
+        if (self->cached)
+            return self->surface.expired() ? mir::geometry::Point{} : self->cached_top_left.load();
+
         if (auto const surface = self->surface.lock())
             return surface->top_left();
     }
@@ -91,6 +139,17 @@ auto miral::Window::size() const
 {
     if (self)
     {
+        if (self->has_pending)
+        {
+            std::lock_guard<std::mutex> lock{self->mutex};
+
+            if (self->pending_size.is_set())
+                return self->pending_size.value();
+        }
+
+        if (self->cached)
+            return self->surface.expired() ? mir::geometry::Size{} : self->cached_size.load();
+
         if (auto const surface = self->surface.lock())
             return surface->size();
     }
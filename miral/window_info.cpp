@@ -17,6 +17,7 @@
  */
 
 #include "miral/window_info.h"
+#include "surface_cache.h"
 
 #include "both_versions.h"
 
@@ -227,10 +228,8 @@ bool miral::WindowInfo::is_visible() const
     case mir_window_state_minimized:
         return false;
     default:
-        if (std::shared_ptr<mir::scene::Surface> surface = window())
-            return surface->visible();
+        return SurfaceCache::visible(window());
     }
-    return false;
 }
 
 void miral::WindowInfo::constrain_resize(Point& requested_pos, Size& requested_size) const
@@ -0,0 +1,377 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "window_management_latency.h"
+#include "forward_geometry_batch.h"
+#include "latency_histogram.h"
+
+#include <miral/application_info.h>
+#include <miral/window_info.h>
+
+miral::WindowManagementLatency::WindowManagementLatency(
+    WindowManagerTools const& wrapped,
+    WindowManagementPolicyBuilder const& builder,
+    std::shared_ptr<LatencyHistograms> const& histograms) :
+    wrapped{wrapped},
+    histograms{histograms},
+    policy(builder(WindowManagerTools{this}))
+{
+}
+
+auto miral::WindowManagementLatency::count_applications() const -> unsigned int
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    return wrapped.count_applications();
+}
+
+void miral::WindowManagementLatency::for_each_application(std::function<void(miral::ApplicationInfo&)> const& functor)
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    wrapped.for_each_application(functor);
+}
+
+auto miral::WindowManagementLatency::find_application(std::function<bool(ApplicationInfo const& info)> const& predicate)
+-> Application
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    return wrapped.find_application(predicate);
+}
+
+auto miral::WindowManagementLatency::info_for(std::weak_ptr<mir::scene::Session> const& session) const -> ApplicationInfo&
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    return wrapped.info_for(session);
+}
+
+auto miral::WindowManagementLatency::info_for(std::weak_ptr<mir::scene::Surface> const& surface) const -> WindowInfo&
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    return wrapped.info_for(surface);
+}
+
+auto miral::WindowManagementLatency::info_for(Window const& window) const -> WindowInfo&
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    return wrapped.info_for(window);
+}
+
+void miral::WindowManagementLatency::ask_client_to_close(miral::Window const& window)
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    wrapped.ask_client_to_close(window);
+}
+
+void miral::WindowManagementLatency::force_close(miral::Window const& window)
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    wrapped.force_close(window);
+}
+
+void miral::WindowManagementLatency::close_window(
+    miral::Window const& window, std::chrono::milliseconds timeout, std::function<void(bool forced)> const& on_closed)
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    wrapped.close_window(window, timeout, on_closed);
+}
+
+auto miral::WindowManagementLatency::active_window() const -> Window
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    return wrapped.active_window();
+}
+
+auto miral::WindowManagementLatency::select_active_window(Window const& hint) -> Window
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    return wrapped.select_active_window(hint);
+}
+
+auto miral::WindowManagementLatency::window_at(mir::geometry::Point cursor) const -> Window
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    return wrapped.window_at(cursor);
+}
+
+auto miral::WindowManagementLatency::windows_at(mir::geometry::Point point) const -> std::vector<Window>
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    return wrapped.windows_at(point);
+}
+
+auto miral::WindowManagementLatency::windows_in(mir::geometry::Rectangle const& area) const -> std::vector<Window>
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    return wrapped.windows_in(area);
+}
+
+auto miral::WindowManagementLatency::active_display() -> mir::geometry::Rectangle const
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    return wrapped.active_display();
+}
+
+auto miral::WindowManagementLatency::info_for_window_id(std::string const& id) const -> WindowInfo&
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    return wrapped.info_for_window_id(id);
+}
+
+auto miral::WindowManagementLatency::id_for_window(Window const& window) const -> std::string
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    return wrapped.id_for_window(window);
+}
+
+void miral::WindowManagementLatency::place_and_size_for_state(
+    WindowSpecification& modifications, WindowInfo const& window_info) const
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    wrapped.place_and_size_for_state(modifications, window_info);
+}
+
+void miral::WindowManagementLatency::drag_active_window(mir::geometry::Displacement movement)
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    wrapped.drag_active_window(movement);
+}
+
+void miral::WindowManagementLatency::drag_window(Window const& window, mir::geometry::Displacement& movement)
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    wrapped.drag_window(window, movement);
+}
+
+void miral::WindowManagementLatency::focus_next_application()
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    wrapped.focus_next_application();
+}
+
+void miral::WindowManagementLatency::focus_next_within_application()
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    wrapped.focus_next_within_application();
+}
+
+void miral::WindowManagementLatency::focus_prev_within_application()
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    wrapped.focus_prev_within_application();
+}
+
+void miral::WindowManagementLatency::raise_tree(miral::Window const& root)
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    wrapped.raise_tree(root);
+}
+
+void miral::WindowManagementLatency::modify_window(
+    miral::WindowInfo& window_info, miral::WindowSpecification const& modifications)
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    wrapped.modify_window(window_info, modifications);
+}
+
+void miral::WindowManagementLatency::invoke_under_lock(std::function<void()> const& callback)
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    wrapped.invoke_under_lock(callback);
+}
+
+void miral::WindowManagementLatency::invoke_under_shared_lock(std::function<void()> const& callback)
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    wrapped.invoke_under_shared_lock(callback);
+}
+
+auto miral::WindowManagementLatency::scene_snapshot() const -> std::shared_ptr<SceneSnapshot const>
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    return wrapped.scene_snapshot();
+}
+
+auto miral::WindowManagementLatency::create_workspace() -> std::shared_ptr<Workspace>
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    return wrapped.create_workspace();
+}
+
+void miral::WindowManagementLatency::add_tree_to_workspace(
+    miral::Window const& window, std::shared_ptr<miral::Workspace> const& workspace)
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    wrapped.add_tree_to_workspace(window, workspace);
+}
+
+void miral::WindowManagementLatency::remove_tree_from_workspace(
+    miral::Window const& window, std::shared_ptr<miral::Workspace> const& workspace)
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    wrapped.remove_tree_from_workspace(window, workspace);
+}
+
+void miral::WindowManagementLatency::move_workspace_content_to_workspace(
+    std::shared_ptr<Workspace> const& to_workspace, std::shared_ptr<Workspace> const& from_workspace)
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    wrapped.move_workspace_content_to_workspace(to_workspace, from_workspace);
+}
+
+void miral::WindowManagementLatency::for_each_workspace_containing(
+    miral::Window const& window, std::function<void(std::shared_ptr<miral::Workspace> const&)> const& callback)
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    wrapped.for_each_workspace_containing(window, callback);
+}
+
+void miral::WindowManagementLatency::for_each_window_in_workspace(
+    std::shared_ptr<miral::Workspace> const& workspace, std::function<void(miral::Window const&)> const& callback)
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    wrapped.for_each_window_in_workspace(workspace, callback);
+}
+
+auto miral::WindowManagementLatency::place_new_window(
+    ApplicationInfo const& app_info,
+    WindowSpecification const& requested_specification) -> WindowSpecification
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    return policy->place_new_window(app_info, requested_specification);
+}
+
+void miral::WindowManagementLatency::handle_window_ready(miral::WindowInfo& window_info)
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    policy->handle_window_ready(window_info);
+}
+
+void miral::WindowManagementLatency::handle_modify_window(
+    miral::WindowInfo& window_info, miral::WindowSpecification const& modifications)
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    policy->handle_modify_window(window_info, modifications);
+}
+
+void miral::WindowManagementLatency::handle_raise_window(miral::WindowInfo& window_info)
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    policy->handle_raise_window(window_info);
+}
+
+bool miral::WindowManagementLatency::handle_keyboard_event(MirKeyboardEvent const* event)
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    return policy->handle_keyboard_event(event);
+}
+
+bool miral::WindowManagementLatency::handle_touch_event(MirTouchEvent const* event)
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    return policy->handle_touch_event(event);
+}
+
+bool miral::WindowManagementLatency::handle_pointer_event(MirPointerEvent const* event)
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    return policy->handle_pointer_event(event);
+}
+
+auto miral::WindowManagementLatency::confirm_inherited_move(WindowInfo const& window_info, Displacement movement)
+-> Rectangle
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    return policy->confirm_inherited_move(window_info, movement);
+}
+
+void miral::WindowManagementLatency::advise_begin()
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    policy->advise_begin();
+}
+
+void miral::WindowManagementLatency::advise_end()
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    policy->advise_end();
+}
+
+void miral::WindowManagementLatency::advise_new_app(miral::ApplicationInfo& application)
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    policy->advise_new_app(application);
+}
+
+void miral::WindowManagementLatency::advise_delete_app(miral::ApplicationInfo const& application)
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    policy->advise_delete_app(application);
+}
+
+void miral::WindowManagementLatency::advise_new_window(miral::WindowInfo const& window_info)
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    policy->advise_new_window(window_info);
+}
+
+void miral::WindowManagementLatency::advise_focus_lost(miral::WindowInfo const& window_info)
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    policy->advise_focus_lost(window_info);
+}
+
+void miral::WindowManagementLatency::advise_focus_gained(miral::WindowInfo const& window_info)
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    policy->advise_focus_gained(window_info);
+}
+
+void miral::WindowManagementLatency::advise_state_change(miral::WindowInfo const& window_info, MirWindowState state)
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    policy->advise_state_change(window_info, state);
+}
+
+void miral::WindowManagementLatency::advise_move_to(miral::WindowInfo const& window_info, mir::geometry::Point top_left)
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    policy->advise_move_to(window_info, top_left);
+}
+
+void miral::WindowManagementLatency::advise_resize(miral::WindowInfo const& window_info, mir::geometry::Size const& new_size)
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    policy->advise_resize(window_info, new_size);
+}
+
+void miral::WindowManagementLatency::advise_delete_window(miral::WindowInfo const& window_info)
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    policy->advise_delete_window(window_info);
+}
+
+void miral::WindowManagementLatency::advise_raise(std::vector<miral::Window> const& windows)
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    policy->advise_raise(windows);
+}
+
+void miral::WindowManagementLatency::advise_geometry_batch(std::vector<GeometryChange> const& changes)
+{
+    LatencyTimer const timer{(*histograms)[__func__]};
+    forward_geometry_batch(*policy, wrapped, changes);
+}
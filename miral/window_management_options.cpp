@@ -18,8 +18,7 @@
 
 #include "miral/window_management_options.h"
 
-#include "basic_window_manager.h"
-#include "window_management_trace.h"
+#include "instrumented_window_manager.h"
 
 #include <mir/abnormal_exit.h>
 #include <mir/server.h>
@@ -34,7 +33,6 @@ namespace
 {
 char const* const wm_option = "window-manager";
 char const* const wm_system_compositor = "system-compositor";
-char const* const trace_option = "window-management-trace";
 }
 
 void miral::WindowManagerOptions::operator()(mir::Server& server) const
@@ -47,7 +45,7 @@ void miral::WindowManagerOptions::operator()(mir::Server& server) const
     description += "system-compositor}]";
 
     server.add_configuration_option(wm_option, description, policies.begin()->name);
-    server.add_configuration_option(trace_option, "log trace message", mir::OptionType::null);
+    add_window_management_instrumentation_options(server);
 
     server.override_the_window_manager_builder([this, &server](msh::FocusController* focus_controller)
         -> std::shared_ptr<msh::WindowManager>
@@ -55,36 +53,17 @@ void miral::WindowManagerOptions::operator()(mir::Server& server) const
             auto const options = server.get_options();
             auto const selection = options->get<std::string>(wm_option);
 
-            auto const display_layout = server.the_shell_display_layout();
-
-#if MIR_SERVER_VERSION >= MIR_VERSION_NUMBER(0, 24, 0)
-            auto const persistent_surface_store = server.the_persistent_surface_store();
-#else
-            std::shared_ptr<mir::shell::PersistentSurfaceStore> const persistent_surface_store;
-#endif
             for (auto const& option : policies)
             {
                 if (selection == option.name)
-                {
-                    if (server.get_options()->is_set(trace_option))
-                    {
-                        auto trace_builder = [&option](WindowManagerTools const& tools) -> std::unique_ptr<miral::WindowManagementPolicy>
-                            {
-                                return std::make_unique<WindowManagementTrace>(tools, option.build);
-                            };
-
-                        return std::make_shared<BasicWindowManager>(focus_controller, display_layout, persistent_surface_store, trace_builder);
-                    }
-
-                    return std::make_shared<BasicWindowManager>(focus_controller, display_layout, persistent_surface_store, option.build);
-                }
+                    return build_instrumented_window_manager(server, focus_controller, option.build);
             }
 
             if (selection == wm_system_compositor)
             {
                 return std::make_shared<msh::SystemCompositorWindowManager>(
                     focus_controller,
-                    display_layout,
+                    server.the_shell_display_layout(),
                     server.the_session_coordinator());
             }
 
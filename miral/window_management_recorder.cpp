@@ -0,0 +1,594 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "window_management_recorder.h"
+
+#include <mir/scene/session.h>
+#include <mir/scene/surface.h>
+#include <mir/shell/surface_specification.h>
+#include <mir_toolkit/event.h>
+
+#include <boost/throw_exception.hpp>
+
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <type_traits>
+#include <unordered_map>
+
+namespace geom = mir::geometry;
+
+namespace
+{
+// Lines a thread records before it writes out the recording
+auto const lines_per_buffer = 256u;
+
+std::atomic<std::uint64_t> next_serial{1};
+
+auto open_recording(std::string const& filename) -> std::shared_ptr<std::ostream>
+{
+    auto const result = std::make_shared<std::ofstream>(filename);
+
+    if (!*result)
+        BOOST_THROW_EXCEPTION(std::runtime_error("Failed to open window management recording: " + filename));
+
+    return result;
+}
+
+void put(std::ostream& out, std::string const& value) { out << std::quoted(value); }
+void put(std::ostream& out, int value) { out << value; }
+void put(std::ostream& out, geom::Width value) { out << value.as_int(); }
+void put(std::ostream& out, geom::Height value) { out << value.as_int(); }
+void put(std::ostream& out, geom::DeltaX value) { out << value.as_int(); }
+void put(std::ostream& out, geom::DeltaY value) { out << value.as_int(); }
+void put(std::ostream& out, geom::Point value) { out << value.x.as_int() << ',' << value.y.as_int(); }
+void put(std::ostream& out, geom::Size value) { out << value.width.as_int() << ',' << value.height.as_int(); }
+void put(std::ostream& out, geom::Displacement value) { out << value.dx.as_int() << ',' << value.dy.as_int(); }
+
+void put(std::ostream& out, geom::Rectangle const& value)
+{
+    put(out, value.top_left);
+    out << ',';
+    put(out, value.size);
+}
+
+void put(std::ostream& out, miral::WindowSpecification::AspectRatio value)
+{
+    out << value.width << ',' << value.height;
+}
+
+template<typename Enum>
+auto put(std::ostream& out, Enum value) -> typename std::enable_if<std::is_enum<Enum>::value>::type
+{
+    out << static_cast<int>(value);
+}
+
+void get(std::istream& in, std::string& value) { in >> std::quoted(value); }
+void get(std::istream& in, int& value) { in >> value; }
+
+template<typename Enum>
+auto get(std::istream& in, Enum& value) -> typename std::enable_if<std::is_enum<Enum>::value>::type
+{
+    int as_int;
+    in >> as_int;
+    value = static_cast<Enum>(as_int);
+}
+
+template<typename Dimension>
+auto get(std::istream& in, Dimension& value) -> decltype(value.as_int(), void())
+{
+    int as_int;
+    in >> as_int;
+    value = Dimension{as_int};
+}
+
+void get(std::istream& in, int& first, int& second)
+{
+    char comma;
+    in >> first >> comma >> second;
+}
+
+void get(std::istream& in, geom::Point& value)
+{
+    int x, y;
+    get(in, x, y);
+    value = geom::Point{x, y};
+}
+
+void get(std::istream& in, geom::Size& value)
+{
+    int width, height;
+    get(in, width, height);
+    value = geom::Size{width, height};
+}
+
+void get(std::istream& in, geom::Displacement& value)
+{
+    int dx, dy;
+    get(in, dx, dy);
+    value = geom::Displacement{dx, dy};
+}
+
+void get(std::istream& in, geom::Rectangle& value)
+{
+    char comma;
+    get(in, value.top_left);
+    in >> comma;
+    get(in, value.size);
+}
+
+void get(std::istream& in, miral::WindowSpecification::AspectRatio& value)
+{
+    char comma;
+    in >> value.width >> comma >> value.height;
+}
+
+template<typename Type>
+void get(std::istream& in, mir::optional_value<Type>& value)
+{
+    Type result{};
+    get(in, result);
+    value = result;
+}
+
+inline auto button_state(MirPointerEvent const* event) -> unsigned int
+{
+    unsigned int result = 0;
+
+    for (auto const a : {mir_pointer_button_primary, mir_pointer_button_secondary, mir_pointer_button_tertiary,
+                         mir_pointer_button_back, mir_pointer_button_forward})
+        result |= mir_pointer_event_button_state(event, a) ? a : 0;
+
+    return result;
+}
+}
+
+void miral::recording::write(std::ostream& out, WindowSpecification const& specification, SurfaceIdFor const& id_for)
+{
+#define WRITE_IF_SET(field)\
+    if (specification.field().is_set()) { out << ' ' << #field << '='; put(out, specification.field().value()); }
+    WRITE_IF_SET(name);
+    WRITE_IF_SET(type);
+    WRITE_IF_SET(top_left);
+    WRITE_IF_SET(size);
+    WRITE_IF_SET(output_id);
+    WRITE_IF_SET(state);
+    WRITE_IF_SET(preferred_orientation);
+    WRITE_IF_SET(aux_rect);
+    WRITE_IF_SET(placement_hints);
+    WRITE_IF_SET(window_placement_gravity);
+    WRITE_IF_SET(aux_rect_placement_gravity);
+    WRITE_IF_SET(aux_rect_placement_offset);
+    WRITE_IF_SET(min_width);
+    WRITE_IF_SET(min_height);
+    WRITE_IF_SET(max_width);
+    WRITE_IF_SET(max_height);
+    WRITE_IF_SET(width_inc);
+    WRITE_IF_SET(height_inc);
+    WRITE_IF_SET(min_aspect);
+    WRITE_IF_SET(max_aspect);
+    WRITE_IF_SET(shell_chrome);
+    WRITE_IF_SET(confine_pointer);
+#undef  WRITE_IF_SET
+
+    if (specification.parent().is_set())
+        if (auto const parent = specification.parent().value().lock())
+            out << " parent=" << id_for(parent);
+}
+
+auto miral::recording::read_specification(std::istream& in, SurfaceFor const& surface_for) -> WindowSpecification
+{
+    WindowSpecification specification;
+    std::string key;
+
+    while (std::getline(in >> std::ws, key, '='))
+    {
+#define READ_IF_MATCHED(field) if (key == #field) get(in, specification.field()); else
+        READ_IF_MATCHED(name)
+        READ_IF_MATCHED(type)
+        READ_IF_MATCHED(top_left)
+        READ_IF_MATCHED(size)
+        READ_IF_MATCHED(output_id)
+        READ_IF_MATCHED(state)
+        READ_IF_MATCHED(preferred_orientation)
+        READ_IF_MATCHED(aux_rect)
+        READ_IF_MATCHED(placement_hints)
+        READ_IF_MATCHED(window_placement_gravity)
+        READ_IF_MATCHED(aux_rect_placement_gravity)
+        READ_IF_MATCHED(aux_rect_placement_offset)
+        READ_IF_MATCHED(min_width)
+        READ_IF_MATCHED(min_height)
+        READ_IF_MATCHED(max_width)
+        READ_IF_MATCHED(max_height)
+        READ_IF_MATCHED(width_inc)
+        READ_IF_MATCHED(height_inc)
+        READ_IF_MATCHED(min_aspect)
+        READ_IF_MATCHED(max_aspect)
+        READ_IF_MATCHED(shell_chrome)
+        READ_IF_MATCHED(confine_pointer)
+#undef  READ_IF_MATCHED
+        if (key == "parent")
+        {
+            int id;
+            in >> id;
+            specification.parent() = std::weak_ptr<mir::scene::Surface>{surface_for(id)};
+        }
+        else
+        {
+            BOOST_THROW_EXCEPTION(std::runtime_error("Unknown field in window management recording: " + key));
+        }
+    }
+
+    return specification;
+}
+
+miral::RecordingWindowManager::RecordingWindowManager(
+    std::shared_ptr<mir::shell::WindowManager> const& wrapped,
+    std::string const& filename) :
+    RecordingWindowManager{wrapped, open_recording(filename)}
+{
+}
+
+miral::RecordingWindowManager::RecordingWindowManager(
+    std::shared_ptr<mir::shell::WindowManager> const& wrapped,
+    std::shared_ptr<std::ostream> const& recording) :
+    wrapped{wrapped},
+    recording{recording},
+    start{std::chrono::steady_clock::now()},
+    serial{next_serial++}
+{
+}
+
+miral::RecordingWindowManager::~RecordingWindowManager()
+{
+    std::lock_guard<decltype(write_mutex)> lock{write_mutex};
+    write_pending();
+
+    // Nothing is being recorded now, so there are no more lines to wait for
+    for (auto const& line : pending)
+        *recording << line.second;
+
+    recording->flush();
+}
+
+void miral::RecordingWindowManager::flush()
+{
+    std::lock_guard<decltype(write_mutex)> lock{write_mutex};
+    write_pending();
+    recording->flush();
+}
+
+auto miral::RecordingWindowManager::thread_buffer() -> ThreadBuffer&
+{
+    // A thread may record for more than one recorder, so its buffers are found by recorder
+    // serial. The recorders own the buffers: entries for recorders that have gone expire,
+    // and are dropped when a buffer is added.
+    thread_local std::unordered_map<std::uint64_t, std::weak_ptr<ThreadBuffer>> thread_buffers;
+
+    // There is normally one recorder, so remember the last buffer used
+    thread_local std::uint64_t last_serial = 0;
+    thread_local ThreadBuffer* last_buffer = nullptr;
+
+    if (last_serial == serial)
+        return *last_buffer;
+
+    auto const existing = thread_buffers.find(serial);
+    auto buffer = existing != thread_buffers.end() ? existing->second.lock() : nullptr;
+
+    if (!buffer)
+    {
+        for (auto i = thread_buffers.begin(); i != thread_buffers.end();)
+            i = i->second.expired() ? thread_buffers.erase(i) : std::next(i);
+
+        buffer = std::make_shared<ThreadBuffer>();
+        thread_buffers[serial] = buffer;
+
+        std::lock_guard<decltype(buffers_mutex)> lock{buffers_mutex};
+        buffers.push_back(buffer);
+    }
+
+    last_serial = serial;
+    last_buffer = buffer.get();
+    return *buffer;
+}
+
+void miral::RecordingWindowManager::begin_line(std::ostream& line, char const* call) const
+{
+    auto const elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    line.precision(std::numeric_limits<float>::max_digits10);
+    line << elapsed.count() << ' ' << call;
+}
+
+void miral::RecordingWindowManager::end_line(std::ostringstream& line)
+{
+    line << '\n';
+
+    auto& buffer = thread_buffer();
+    bool full;
+    {
+        std::lock_guard<decltype(buffer.mutex)> lock{buffer.mutex};
+        buffer.lines.emplace_back(next_line++, line.str());
+        full = buffer.lines.size() >= lines_per_buffer;
+    }
+
+    if (full)
+    {
+        // If another thread is writing then these lines can wait for the next write
+        std::unique_lock<decltype(write_mutex)> lock{write_mutex, std::try_to_lock};
+        if (lock) write_pending();
+    }
+}
+
+void miral::RecordingWindowManager::write_pending()
+{
+    decltype(buffers) current;
+    {
+        std::lock_guard<decltype(buffers_mutex)> lock{buffers_mutex};
+        current = buffers;
+    }
+
+    for (auto const& buffer : current)
+    {
+        std::vector<Line> lines;
+        {
+            std::lock_guard<decltype(buffer->mutex)> lock{buffer->mutex};
+            lines.swap(buffer->lines);
+        }
+
+        for (auto& line : lines)
+            pending.emplace(line.first, std::move(line.second));
+    }
+
+    for (auto i = pending.begin(); i != pending.end() && i->first == next_to_write; i = pending.erase(i))
+    {
+        *recording << i->second;
+        ++next_to_write;
+    }
+}
+
+auto miral::RecordingWindowManager::id_for(std::shared_ptr<mir::scene::Session> const& session) -> int
+{
+    std::lock_guard<decltype(ids_mutex)> lock{ids_mutex};
+    auto const i = session_ids.find(session.get());
+    return i != session_ids.end() ? i->second : session_ids[session.get()] = next_session_id++;
+}
+
+auto miral::RecordingWindowManager::id_for(std::shared_ptr<mir::scene::Surface> const& surface) -> int
+{
+    std::lock_guard<decltype(ids_mutex)> lock{ids_mutex};
+    auto const i = surface_ids.find(surface.get());
+    return i != surface_ids.end() ? i->second : surface_ids[surface.get()] = next_surface_id++;
+}
+
+void miral::RecordingWindowManager::forget(mir::scene::Session const* session)
+{
+    std::lock_guard<decltype(ids_mutex)> lock{ids_mutex};
+    session_ids.erase(session);
+}
+
+void miral::RecordingWindowManager::forget(mir::scene::Surface const* surface)
+{
+    std::lock_guard<decltype(ids_mutex)> lock{ids_mutex};
+    surface_ids.erase(surface);
+}
+
+void miral::RecordingWindowManager::add_session(std::shared_ptr<mir::scene::Session> const& session)
+{
+    // A new session may reuse the address of one that has gone
+    forget(session.get());
+
+    std::ostringstream line;
+    begin_line(line, __func__);
+    line << ' ' << id_for(session) << ' ' << session->process_id() << ' ' << std::quoted(session->name());
+    end_line(line);
+
+    wrapped->add_session(session);
+}
+
+void miral::RecordingWindowManager::remove_session(std::shared_ptr<mir::scene::Session> const& session)
+{
+    std::ostringstream line;
+    begin_line(line, __func__);
+    line << ' ' << id_for(session);
+    end_line(line);
+
+    forget(session.get());
+    wrapped->remove_session(session);
+}
+
+auto miral::RecordingWindowManager::add_surface(
+    std::shared_ptr<mir::scene::Session> const& session,
+    mir::scene::SurfaceCreationParameters const& params,
+    std::function<mir::frontend::SurfaceId(std::shared_ptr<mir::scene::Session> const& session, mir::scene::SurfaceCreationParameters const& params)> const& build)
+-> mir::frontend::SurfaceId
+{
+    auto const result = wrapped->add_surface(session, params, build);
+    auto const surface = session->surface(result);
+
+    forget(surface.get());
+
+    std::ostringstream line;
+    begin_line(line, __func__);
+    line << ' ' << id_for(session) << ' ' << id_for(surface);
+    recording::write(line, WindowSpecification{params}, [this](auto const& surface) { return id_for(surface); });
+    end_line(line);
+
+    return result;
+}
+
+void miral::RecordingWindowManager::modify_surface(
+    std::shared_ptr<mir::scene::Session> const& session,
+    std::shared_ptr<mir::scene::Surface> const& surface,
+    mir::shell::SurfaceSpecification const& modifications)
+{
+    std::ostringstream line;
+    begin_line(line, __func__);
+    line << ' ' << id_for(session) << ' ' << id_for(surface);
+    recording::write(line, WindowSpecification{modifications}, [this](auto const& surface) { return id_for(surface); });
+    end_line(line);
+
+    wrapped->modify_surface(session, surface, modifications);
+}
+
+void miral::RecordingWindowManager::remove_surface(
+    std::shared_ptr<mir::scene::Session> const& session,
+    std::weak_ptr<mir::scene::Surface> const& surface)
+{
+    if (auto const s = surface.lock())
+    {
+        std::ostringstream line;
+        begin_line(line, __func__);
+        line << ' ' << id_for(session) << ' ' << id_for(s);
+        end_line(line);
+
+        forget(s.get());
+    }
+
+    wrapped->remove_surface(session, surface);
+}
+
+void miral::RecordingWindowManager::add_display(mir::geometry::Rectangle const& area)
+{
+    std::ostringstream line;
+    begin_line(line, __func__);
+    line << ' ';
+    put(line, area);
+    end_line(line);
+
+    wrapped->add_display(area);
+}
+
+void miral::RecordingWindowManager::remove_display(mir::geometry::Rectangle const& area)
+{
+    std::ostringstream line;
+    begin_line(line, __func__);
+    line << ' ';
+    put(line, area);
+    end_line(line);
+
+    wrapped->remove_display(area);
+}
+
+bool miral::RecordingWindowManager::handle_keyboard_event(MirKeyboardEvent const* event)
+{
+    std::ostringstream line;
+    begin_line(line, __func__);
+    line
+        << ' ' << mir_input_event_get_device_id(mir_keyboard_event_input_event(event))
+        << ' ' << mir_keyboard_event_modifiers(event)
+        << ' ' << static_cast<int>(mir_keyboard_event_action(event))
+        << ' ' << mir_keyboard_event_key_code(event)
+        << ' ' << mir_keyboard_event_scan_code(event);
+    end_line(line);
+
+    return wrapped->handle_keyboard_event(event);
+}
+
+bool miral::RecordingWindowManager::handle_touch_event(MirTouchEvent const* event)
+{
+    auto const count = mir_touch_event_point_count(event);
+
+    std::ostringstream line;
+    begin_line(line, __func__);
+    line
+        << ' ' << mir_input_event_get_device_id(mir_touch_event_input_event(event))
+        << ' ' << mir_touch_event_modifiers(event)
+        << ' ' << count;
+
+    for (auto index = 0U; index != count; ++index)
+    {
+        line
+            << ' ' << mir_touch_event_id(event, index)
+            << ' ' << static_cast<int>(mir_touch_event_action(event, index))
+            << ' ' << static_cast<int>(mir_touch_event_tooltype(event, index))
+            << ' ' << mir_touch_event_axis_value(event, index, mir_touch_axis_x)
+            << ' ' << mir_touch_event_axis_value(event, index, mir_touch_axis_y)
+            << ' ' << mir_touch_event_axis_value(event, index, mir_touch_axis_pressure)
+            << ' ' << mir_touch_event_axis_value(event, index, mir_touch_axis_touch_major)
+            << ' ' << mir_touch_event_axis_value(event, index, mir_touch_axis_touch_minor)
+            << ' ' << mir_touch_event_axis_value(event, index, mir_touch_axis_size);
+    }
+
+    end_line(line);
+
+    return wrapped->handle_touch_event(event);
+}
+
+bool miral::RecordingWindowManager::handle_pointer_event(MirPointerEvent const* event)
+{
+    std::ostringstream line;
+    begin_line(line, __func__);
+    line
+        << ' ' << mir_input_event_get_device_id(mir_pointer_event_input_event(event))
+        << ' ' << mir_pointer_event_modifiers(event)
+        << ' ' << static_cast<int>(mir_pointer_event_action(event))
+        << ' ' << button_state(event)
+        << ' ' << mir_pointer_event_axis_value(event, mir_pointer_axis_x)
+        << ' ' << mir_pointer_event_axis_value(event, mir_pointer_axis_y)
+        << ' ' << mir_pointer_event_axis_value(event, mir_pointer_axis_hscroll)
+        << ' ' << mir_pointer_event_axis_value(event, mir_pointer_axis_vscroll)
+        << ' ' << mir_pointer_event_axis_value(event, mir_pointer_axis_relative_x)
+        << ' ' << mir_pointer_event_axis_value(event, mir_pointer_axis_relative_y);
+    end_line(line);
+
+    return wrapped->handle_pointer_event(event);
+}
+
+void miral::RecordingWindowManager::handle_raise_surface(
+    std::shared_ptr<mir::scene::Session> const& session,
+    std::shared_ptr<mir::scene::Surface> const& surface,
+    uint64_t timestamp)
+{
+    std::ostringstream line;
+    begin_line(line, __func__);
+    line << ' ' << id_for(session) << ' ' << id_for(surface) << ' ' << timestamp;
+    end_line(line);
+
+    wrapped->handle_raise_surface(session, surface, timestamp);
+}
+
+#if MIR_SERVER_VERSION >= MIR_VERSION_NUMBER(0, 27, 0)
+void miral::RecordingWindowManager::handle_request_drag_and_drop(
+    std::shared_ptr<mir::scene::Session> const& session,
+    std::shared_ptr<mir::scene::Surface> const& surface,
+    uint64_t timestamp)
+{
+    std::ostringstream line;
+    begin_line(line, __func__);
+    line << ' ' << id_for(session) << ' ' << id_for(surface) << ' ' << timestamp;
+    end_line(line);
+
+    wrapped->handle_request_drag_and_drop(session, surface, timestamp);
+}
+#endif
+
+int miral::RecordingWindowManager::set_surface_attribute(
+    std::shared_ptr<mir::scene::Session> const& session,
+    std::shared_ptr<mir::scene::Surface> const& surface,
+    MirWindowAttrib attrib,
+    int value)
+{
+    std::ostringstream line;
+    begin_line(line, __func__);
+    line << ' ' << id_for(session) << ' ' << id_for(surface) << ' ' << static_cast<int>(attrib) << ' ' << value;
+    end_line(line);
+
+    return wrapped->set_surface_attribute(session, surface, attrib, value);
+}
@@ -0,0 +1,164 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_WINDOW_MANAGEMENT_RECORDER_H
+#define MIRAL_WINDOW_MANAGEMENT_RECORDER_H
+
+#include "miral/window_specification.h"
+
+#include <mir/shell/window_manager.h>
+#include <mir/version.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace miral
+{
+/// The recording is a text file with one call to the window manager per line:
+/// "<nanoseconds since start> <call> <arguments...>". Sessions and surfaces are
+/// identified by numbers allocated in the order they are first seen.
+namespace recording
+{
+using SurfaceIdFor = std::function<int(std::shared_ptr<mir::scene::Surface> const& surface)>;
+using SurfaceFor = std::function<std::shared_ptr<mir::scene::Surface>(int id)>;
+
+/// Writes the fields set in specification as " key=value" pairs
+void write(std::ostream& out, WindowSpecification const& specification, SurfaceIdFor const& id_for);
+
+/// Reads " key=value" pairs (as written by write()) to the end of the input
+auto read_specification(std::istream& in, SurfaceFor const& surface_for) -> WindowSpecification;
+}
+
+/// Decorates a window manager (typically BasicWindowManager) recording the
+/// calls it receives. The recording can be replayed "headless" to reproduce
+/// a session without the clients that created it.
+/// Calls are not serialized by the recorder: each thread records into a
+/// buffer of its own and the lines are written out in the order the calls
+/// arrived when a buffer fills, on flush() and on destruction.
+class RecordingWindowManager : public virtual mir::shell::WindowManager
+{
+public:
+    RecordingWindowManager(std::shared_ptr<mir::shell::WindowManager> const& wrapped, std::string const& filename);
+
+    RecordingWindowManager(
+        std::shared_ptr<mir::shell::WindowManager> const& wrapped,
+        std::shared_ptr<std::ostream> const& recording);
+
+    ~RecordingWindowManager();
+
+    /// Write out everything recorded so far
+    void flush();
+
+    void add_session(std::shared_ptr<mir::scene::Session> const& session) override;
+
+    void remove_session(std::shared_ptr<mir::scene::Session> const& session) override;
+
+    auto add_surface(
+        std::shared_ptr<mir::scene::Session> const& session,
+        mir::scene::SurfaceCreationParameters const& params,
+        std::function<mir::frontend::SurfaceId(std::shared_ptr<mir::scene::Session> const& session, mir::scene::SurfaceCreationParameters const& params)> const& build)
+    -> mir::frontend::SurfaceId override;
+
+    void modify_surface(
+        std::shared_ptr<mir::scene::Session> const& session,
+        std::shared_ptr<mir::scene::Surface> const& surface,
+        mir::shell::SurfaceSpecification const& modifications) override;
+
+    void remove_surface(
+        std::shared_ptr<mir::scene::Session> const& session,
+        std::weak_ptr<mir::scene::Surface> const& surface) override;
+
+    void add_display(mir::geometry::Rectangle const& area) override;
+
+    void remove_display(mir::geometry::Rectangle const& area) override;
+
+    bool handle_keyboard_event(MirKeyboardEvent const* event) override;
+
+    bool handle_touch_event(MirTouchEvent const* event) override;
+
+    bool handle_pointer_event(MirPointerEvent const* event) override;
+
+    void handle_raise_surface(
+        std::shared_ptr<mir::scene::Session> const& session,
+        std::shared_ptr<mir::scene::Surface> const& surface,
+        uint64_t timestamp) override;
+
+#if MIR_SERVER_VERSION >= MIR_VERSION_NUMBER(0, 27, 0)
+    void handle_request_drag_and_drop(
+        std::shared_ptr<mir::scene::Session> const& session,
+        std::shared_ptr<mir::scene::Surface> const& surface,
+        uint64_t timestamp) override;
+#endif
+
+    int set_surface_attribute(
+        std::shared_ptr<mir::scene::Session> const& session,
+        std::shared_ptr<mir::scene::Surface> const& surface,
+        MirWindowAttrib attrib,
+        int value) override;
+
+private:
+    using Line = std::pair<std::uint64_t, std::string>;
+
+    // Only contended when a flush collects the lines
+    struct ThreadBuffer
+    {
+        std::mutex mutex;
+        std::vector<Line> lines;
+    };
+
+    std::shared_ptr<mir::shell::WindowManager> const wrapped;
+    std::shared_ptr<std::ostream> const recording;
+    std::chrono::steady_clock::time_point const start;
+    std::uint64_t const serial;
+
+    std::atomic<std::uint64_t> next_line{0};
+
+    std::mutex buffers_mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+
+    std::mutex ids_mutex;
+    int next_session_id = 0;
+    int next_surface_id = 0;
+    std::map<mir::scene::Session const*, int> session_ids;
+    std::map<mir::scene::Surface const*, int> surface_ids;
+
+    // Lines that are waiting for earlier lines still being recorded
+    std::mutex write_mutex;
+    std::uint64_t next_to_write = 0;
+    std::map<std::uint64_t, std::string> pending;
+
+    auto thread_buffer() -> ThreadBuffer&;
+    void begin_line(std::ostream& line, char const* call) const;
+    void end_line(std::ostringstream& line);
+    void write_pending();
+    auto id_for(std::shared_ptr<mir::scene::Session> const& session) -> int;
+    auto id_for(std::shared_ptr<mir::scene::Surface> const& surface) -> int;
+    void forget(mir::scene::Session const* session);
+    void forget(mir::scene::Surface const* surface);
+};
+}
+
+#endif //MIRAL_WINDOW_MANAGEMENT_RECORDER_H
@@ -17,23 +17,18 @@
  */
 
 #include "window_management_trace.h"
+#include "forward_geometry_batch.h"
+#include "trace_ring_buffer.h"
 
 #include <miral/application_info.h>
 #include <miral/window_info.h>
 
-#include <mir/scene/session.h>
-#include <mir/scene/surface.h>
-#include <mir/event_printer.h>
-
-#include <iomanip>
 #include <sstream>
 
 #define MIR_LOG_COMPONENT "miral::Window Management"
 #include <mir/log.h>
 #include <mir/report_exception.h>
 
-using mir::operator<<;
-
 #define MIRAL_TRACE_EXCEPTION \
 catch (std::exception const& x)\
 {\
@@ -44,305 +39,47 @@ catch (std::exception const& x)\
 }
 
 
-namespace
-{
-std::string const null_ptr{"(null)"};
-
-auto operator<< (std::ostream& out, miral::WindowSpecification::AspectRatio const& ratio) -> std::ostream&;
-
-struct BracedItemStream
-{
-    BracedItemStream(std::ostream& out) : out{out} { out << '{'; }
-    ~BracedItemStream() { out << '}'; }
-    bool mutable first_field = true;
-    std::ostream& out;
-
-    template<typename Type>
-    auto append(Type const& item) const -> BracedItemStream const&
-    {
-        if (!first_field) out << ", ";
-        out << item;
-        first_field = false;
-        return *this;
-    }
-
-    template<typename Type>
-    auto append(char const* name, Type const& item) const -> BracedItemStream const&
-    {
-        if (!first_field) out << ", ";
-        out << name << '=' << item;
-        first_field = false;
-        return *this;
-    }
-
-    auto append(char const* name, MirOrientationMode item) const -> BracedItemStream const&
-    {
-        auto const flags = out.flags();
-        auto const prec  = out.precision();
-        auto const fill  = out.fill();
-
-        if (!first_field) out << ", ";
-        out << name << '=' << std::showbase << std::internal << std::setfill('0') << std::setw(2) << std::hex << item;
-        first_field = false;
-
-        out.flags(flags);
-        out.precision(prec);
-        out.fill(fill);
-        return *this;
-    }
-};
-
-auto operator<< (std::ostream& out, miral::WindowSpecification::AspectRatio const& ratio) -> std::ostream&
-{
-    BracedItemStream{out}.append(ratio.width).append(ratio.height);
-    return out;
-}
-
-auto dump_of(miral::Window const& window) -> std::string
-{
-    if (std::shared_ptr<mir::scene::Surface> surface = window)
-        return surface->name();
-    else
-        return null_ptr;
-}
-
-auto dump_of(miral::Application const& application) -> std::string
-{
-    if (application)
-        return application->name();
-    else
-        return null_ptr;
-}
-
-auto dump_of(std::vector<miral::Window> const& windows) -> std::string;
-
-inline auto operator!=(miral::WindowInfo::AspectRatio const& lhs, miral::WindowInfo::AspectRatio const& rhs)
-{
-    return lhs.width != rhs.width || lhs.height != rhs.height;
-}
-
-auto dump_of(miral::WindowInfo const& info) -> std::string
-{
-    using namespace mir::geometry;
+namespace trace = miral::trace;
 
-    std::stringstream out;
-    {
-        BracedItemStream bout{out};
-
-#define APPEND(field) bout.append(#field, info.field());
-        APPEND(name);
-        APPEND(type);
-        APPEND(state);
-        if (info.state() != mir_window_state_restored) APPEND(restore_rect);
-        if (std::shared_ptr<mir::scene::Surface> parent = info.parent())
-            bout.append("parent", parent->name());
-        bout.append("children", dump_of(info.children()));
-        if (info.min_width()  != Width{0}) APPEND(min_width);
-        if (info.min_height() != Height{0}) APPEND(min_height);
-        if (info.max_width()  != Width{std::numeric_limits<int>::max()}) APPEND(max_width);
-        if (info.max_height() != Height{std::numeric_limits<int>::max()}) APPEND(max_height);
-        if (info.width_inc()  != DeltaX{1}) APPEND(width_inc);
-        if (info.height_inc() != DeltaY{1}) APPEND(height_inc);
-        if (info.min_aspect() != miral::WindowInfo::AspectRatio{0U, std::numeric_limits<unsigned>::max()}) APPEND(min_aspect);
-        if (info.max_aspect() != miral::WindowInfo::AspectRatio{std::numeric_limits<unsigned>::max(), 0U}) APPEND(max_aspect);
-        APPEND(preferred_orientation);
-        APPEND(confine_pointer);
-
-#define APPEND_IF_SET(field) if (info.has_##field()) bout.append(#field, info.field());
-        APPEND_IF_SET(output_id);
-#undef  APPEND_IF_SET
-#undef  APPEND
-    }
-
-    return out.str();
-}
-
-auto dump_of(miral::WindowSpecification const& specification) -> std::string
+namespace
 {
-    std::stringstream out;
-
-    {
-        BracedItemStream bout{out};
-
-#define APPEND_IF_SET(field) if (specification.field().is_set()) bout.append(#field, specification.field().value());
-        APPEND_IF_SET(name);
-        APPEND_IF_SET(type);
-        APPEND_IF_SET(top_left);
-        APPEND_IF_SET(size);
-        APPEND_IF_SET(output_id);
-        APPEND_IF_SET(state);
-        APPEND_IF_SET(preferred_orientation);
-        APPEND_IF_SET(aux_rect);
-        APPEND_IF_SET(placement_hints);
-        APPEND_IF_SET(window_placement_gravity);
-        APPEND_IF_SET(aux_rect_placement_gravity);
-        APPEND_IF_SET(aux_rect_placement_offset);
-        APPEND_IF_SET(min_width);
-        APPEND_IF_SET(min_height);
-        APPEND_IF_SET(max_width);
-        APPEND_IF_SET(max_height);
-        APPEND_IF_SET(width_inc);
-        APPEND_IF_SET(height_inc);
-        APPEND_IF_SET(min_aspect);
-        APPEND_IF_SET(max_aspect);
-        if (specification.parent().is_set())
-            if (auto const& parent = specification.parent().value().lock())
-                bout.append("parent", parent->name());
-//        APPEND_IF_SET(input_shape);
-//        APPEND_IF_SET(input_mode);
-        APPEND_IF_SET(shell_chrome);
-        APPEND_IF_SET(confine_pointer);
-#undef  APPEND_IF_SET
-    }
-
-    return out.str();
-}
-
-auto dump_of(std::vector<miral::Window> const& windows) -> std::string
+template<typename Type>
+auto field(char const* label, Type const& value) -> trace::Field
 {
-    std::stringstream out;
-
-    {
-        BracedItemStream bout{out};
-
-        for (auto const& window: windows)
-            bout.append(dump_of(window));
-    }
-
-    return out.str();
+    return {label, value};
 }
-
-auto dump_of(miral::ApplicationInfo const& app_info) -> std::string
-{
-    std::stringstream out;
-
-    BracedItemStream{out}
-        .append("application", dump_of(app_info.application()))
-        .append("windows", dump_of(app_info.windows()));
-
-    return out.str();
 }
 
-auto dump_of(MirKeyboardEvent const* event) -> std::string
+miral::WindowManagementTrace::WindowManagementTrace(
+    WindowManagerTools const& wrapped,
+    WindowManagementPolicyBuilder const& builder,
+    std::shared_ptr<TraceRingBuffer> const& binary) :
+    wrapped{wrapped},
+    binary{binary},
+    policy(builder(WindowManagerTools{this}))
 {
-    std::stringstream out;
-
-    auto device_id = mir_input_event_get_device_id(mir_keyboard_event_input_event(event));
-
-    {
-        BracedItemStream bout{out};
-
-        bout.append("from", device_id)
-            .append("action", mir_keyboard_event_action(event))
-            .append("code", mir_keyboard_event_key_code(event))
-            .append("scan", mir_keyboard_event_scan_code(event));
-
-        out.setf(std::ios_base::hex, std::ios_base::basefield);
-        bout.append(std::hex).append("modifiers", mir_keyboard_event_modifiers(event));
-    }
-
-    return out.str();
 }
 
-auto dump_of(MirTouchEvent const* event) -> std::string
+void miral::WindowManagementTrace::trace_call(char const* function, std::initializer_list<trace::Field> fields) const
 {
-    std::stringstream out;
-
-    auto device_id = mir_input_event_get_device_id(mir_touch_event_input_event(event));
-
+    if (binary)
     {
-        BracedItemStream bout{out};
-
-        bout.append("from", device_id);
-
-        for (unsigned int index = 0, count = mir_touch_event_point_count(event); index != count; ++index)
-        {
-            BracedItemStream{out}
-                .append("id", mir_touch_event_id(event, index))
-                .append("action", mir_touch_event_action(event, index))
-                .append("tool", mir_touch_event_tooltype(event, index))
-                .append("x", mir_touch_event_axis_value(event, index, mir_touch_axis_x))
-                .append("y", mir_touch_event_axis_value(event, index, mir_touch_axis_y))
-                .append("pressure", mir_touch_event_axis_value(event, index, mir_touch_axis_pressure))
-                .append("major", mir_touch_event_axis_value(event, index, mir_touch_axis_touch_major))
-                .append("minor", mir_touch_event_axis_value(event, index, mir_touch_axis_touch_minor))
-                .append("size", mir_touch_event_axis_value(event, index, mir_touch_axis_size));
-        }
-
-        out.setf(std::ios_base::hex, std::ios_base::basefield);
-        bout.append("modifiers", mir_touch_event_modifiers(event));
+        binary->record(function, fields);
     }
-
-    return out.str();
-}
-
-auto dump_of(MirPointerEvent const* event) -> std::string
-{
-    std::stringstream out;
-
-    auto device_id = mir_input_event_get_device_id(mir_pointer_event_input_event(event));
-
-    unsigned int button_state = 0;
-
-    for (auto const a : {mir_pointer_button_primary, mir_pointer_button_secondary, mir_pointer_button_tertiary,
-                         mir_pointer_button_back, mir_pointer_button_forward})
-        button_state |= mir_pointer_event_button_state(event, a) ? a : 0;
-
+    else
     {
-        BracedItemStream bout{out};
-
-        bout.append("from", device_id)
-            .append("action", mir_pointer_event_action(event))
-            .append("button_state", button_state)
-            .append("x", mir_pointer_event_axis_value(event, mir_pointer_axis_x))
-            .append("y", mir_pointer_event_axis_value(event, mir_pointer_axis_y))
-            .append("dx", mir_pointer_event_axis_value(event, mir_pointer_axis_relative_x))
-            .append("dy", mir_pointer_event_axis_value(event, mir_pointer_axis_relative_y))
-            .append("vscroll", mir_pointer_event_axis_value(event, mir_pointer_axis_vscroll))
-            .append("hscroll", mir_pointer_event_axis_value(event, mir_pointer_axis_hscroll));
-
-        out.setf(std::ios_base::hex, std::ios_base::basefield);
-        bout.append("modifiers", mir_pointer_event_modifiers(event));
+        static thread_local trace::Writer writer;
+        writer.clear();
+        trace::encode(writer, function, fields);
+        mir::log_info("%s", trace::format_entry(writer.data()).c_str());
     }
-
-    return out.str();
-}
-
-auto dump_of(MirWindowState state) -> std::string
-{
-    std::stringstream out;
-    out << state;
-    return out.str();
-}
-
-auto dump_of(mir::geometry::Point point) -> std::string
-{
-    std::stringstream out;
-    out << point;
-    return out.str();
-}
-
-auto dump_of(mir::geometry::Size const size) -> std::string
-{
-    std::stringstream out;
-    out << size;
-    return out.str();
-}
-}
-
-miral::WindowManagementTrace::WindowManagementTrace(
-    WindowManagerTools const& wrapped,
-    WindowManagementPolicyBuilder const& builder) :
-    wrapped{wrapped},
-    policy(builder(WindowManagerTools{this}))
-{
 }
 
 auto miral::WindowManagementTrace::count_applications() const -> unsigned int
 try {
     log_input();
     auto const result = wrapped.count_applications();
-    mir::log_info("%s -> %d", __func__, result);
+    trace_call(__func__, {field("->", result)});
     trace_count++;
     return result;
 }
@@ -351,7 +88,7 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::for_each_application(std::function<void(miral::ApplicationInfo&)> const& functor)
 try {
     log_input();
-    mir::log_info("%s", __func__);
+    trace_call(__func__, {});
     trace_count++;
     wrapped.for_each_application(functor);
 }
@@ -362,7 +99,7 @@ auto miral::WindowManagementTrace::find_application(std::function<bool(Applicati
 try {
     log_input();
     auto result = wrapped.find_application(predicate);
-    mir::log_info("%s -> %s", __func__, dump_of(result).c_str());
+    trace_call(__func__, {field("->", result)});
     trace_count++;
     return result;
 }
@@ -372,7 +109,7 @@ auto miral::WindowManagementTrace::info_for(std::weak_ptr<mir::scene::Session> c
 try {
     log_input();
     auto& result = wrapped.info_for(session);
-    mir::log_info("%s -> %s", __func__, result.application()->name().c_str());
+    trace_call(__func__, {field("->", result.application())});
     trace_count++;
     return result;
 }
@@ -382,7 +119,7 @@ auto miral::WindowManagementTrace::info_for(std::weak_ptr<mir::scene::Surface> c
 try {
     log_input();
     auto& result = wrapped.info_for(surface);
-    mir::log_info("%s -> %s", __func__, result.name().c_str());
+    trace_call(__func__, {field("->", result.name())});
     trace_count++;
     return result;
 }
@@ -392,7 +129,7 @@ auto miral::WindowManagementTrace::info_for(Window const& window) const -> Windo
 try {
     log_input();
     auto& result = wrapped.info_for(window);
-    mir::log_info("%s -> %s", __func__, result.name().c_str());
+    trace_call(__func__, {field("->", result.name())});
     trace_count++;
     return result;
 }
@@ -401,7 +138,7 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::ask_client_to_close(miral::Window const& window)
 try {
     log_input();
-    mir::log_info("%s -> %s", __func__, dump_of(window).c_str());
+    trace_call(__func__, {field("->", window)});
     trace_count++;
     wrapped.ask_client_to_close(window);
 }
@@ -410,17 +147,27 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::force_close(miral::Window const& window)
 try {
     log_input();
-    mir::log_info("%s -> %s", __func__, dump_of(window).c_str());
+    trace_call(__func__, {field("->", window)});
     trace_count++;
     wrapped.force_close(window);
 }
 MIRAL_TRACE_EXCEPTION
 
+void miral::WindowManagementTrace::close_window(
+    miral::Window const& window, std::chrono::milliseconds timeout, std::function<void(bool forced)> const& on_closed)
+try {
+    log_input();
+    trace_call(__func__, {field("window", window), field("timeout_ms", static_cast<unsigned>(timeout.count()))});
+    trace_count++;
+    wrapped.close_window(window, timeout, on_closed);
+}
+MIRAL_TRACE_EXCEPTION
+
 auto miral::WindowManagementTrace::active_window() const -> Window
 try {
     log_input();
     auto result = wrapped.active_window();
-    mir::log_info("%s -> %s", __func__, dump_of(result).c_str());
+    trace_call(__func__, {field("->", result)});
     trace_count++;
     return result;
 }
@@ -430,7 +177,7 @@ auto miral::WindowManagementTrace::select_active_window(Window const& hint) -> W
 try {
     log_input();
     auto result = wrapped.select_active_window(hint);
-    mir::log_info("%s hint=%s -> %s", __func__, dump_of(hint).c_str(), dump_of(result).c_str());
+    trace_call(__func__, {field("hint", hint), field("->", result)});
     trace_count++;
     return result;
 }
@@ -440,9 +187,27 @@ auto miral::WindowManagementTrace::window_at(mir::geometry::Point cursor) const
 try {
     log_input();
     auto result = wrapped.window_at(cursor);
-    std::stringstream out;
-    out << cursor << " -> " << dump_of(result);
-    mir::log_info("%s cursor=%s", __func__, out.str().c_str());
+    trace_call(__func__, {field("cursor", cursor), field("->", result)});
+    trace_count++;
+    return result;
+}
+MIRAL_TRACE_EXCEPTION
+
+auto miral::WindowManagementTrace::windows_at(mir::geometry::Point point) const -> std::vector<Window>
+try {
+    log_input();
+    auto result = wrapped.windows_at(point);
+    trace_call(__func__, {field("point", point), field("->", result)});
+    trace_count++;
+    return result;
+}
+MIRAL_TRACE_EXCEPTION
+
+auto miral::WindowManagementTrace::windows_in(mir::geometry::Rectangle const& area) const -> std::vector<Window>
+try {
+    log_input();
+    auto result = wrapped.windows_in(area);
+    trace_call(__func__, {field("area", area), field("->", result)});
     trace_count++;
     return result;
 }
@@ -452,9 +217,7 @@ auto miral::WindowManagementTrace::active_display() -> mir::geometry::Rectangle
 try {
     log_input();
     auto result = wrapped.active_display();
-    std::stringstream out;
-    out << result;
-    mir::log_info("%s -> ", __func__, out.str().c_str());
+    trace_call(__func__, {field("->", result)});
     trace_count++;
     return result;
 }
@@ -464,7 +227,7 @@ auto miral::WindowManagementTrace::info_for_window_id(std::string const& id) con
 try {
     log_input();
     auto& result = wrapped.info_for_window_id(id);
-    mir::log_info("%s id=%s -> %s", __func__, id.c_str(), dump_of(result).c_str());
+    trace_call(__func__, {field("id", id), field("->", result)});
     trace_count++;
     return result;
 }
@@ -474,7 +237,7 @@ auto miral::WindowManagementTrace::id_for_window(Window const& window) const ->
 try {
     log_input();
     auto result = wrapped.id_for_window(window);
-    mir::log_info("%s window=%s -> %s", __func__, dump_of(window).c_str(), result.c_str());
+    trace_call(__func__, {field("window", window), field("->", result)});
     trace_count++;
     return result;
 }
@@ -484,7 +247,7 @@ void miral::WindowManagementTrace::place_and_size_for_state(
     WindowSpecification& modifications, WindowInfo const& window_info) const
 try {
     log_input();
-    mir::log_info("%s modifications=%s window_info=%s", __func__, dump_of(modifications).c_str(), dump_of(window_info).c_str());
+    trace_call(__func__, {field("modifications", modifications), field("window_info", window_info)});
     wrapped.place_and_size_for_state(modifications, window_info);
 }
 MIRAL_TRACE_EXCEPTION
@@ -492,9 +255,7 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::drag_active_window(mir::geometry::Displacement movement)
 try {
     log_input();
-    std::stringstream out;
-    out << movement;
-    mir::log_info("%s movement=%s", __func__, out.str().c_str());
+    trace_call(__func__, {field("movement", movement)});
     trace_count++;
     wrapped.drag_active_window(movement);
 }
@@ -503,9 +264,7 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::drag_window(Window const& window, mir::geometry::Displacement& movement)
 try {
     log_input();
-    std::stringstream out;
-    out << movement;
-    mir::log_info("%s window=%s -> %s", __func__, dump_of(window).c_str(), out.str().c_str());
+    trace_call(__func__, {field("window", window), field("->", movement)});
     trace_count++;
     wrapped.drag_window(window, movement);
 }
@@ -514,7 +273,7 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::focus_next_application()
 try {
     log_input();
-    mir::log_info("%s", __func__);
+    trace_call(__func__, {});
     trace_count++;
     wrapped.focus_next_application();
 }
@@ -523,7 +282,7 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::focus_next_within_application()
 try {
     log_input();
-    mir::log_info("%s", __func__);
+    trace_call(__func__, {});
     trace_count++;
     wrapped.focus_next_within_application();
 }
@@ -532,7 +291,7 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::focus_prev_within_application()
 try {
     log_input();
-    mir::log_info("%s", __func__);
+    trace_call(__func__, {});
     trace_count++;
     wrapped.focus_prev_within_application();
 }
@@ -541,7 +300,7 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::raise_tree(miral::Window const& root)
 try {
     log_input();
-    mir::log_info("%s root=%s", __func__, dump_of(root).c_str());
+    trace_call(__func__, {field("root", root)});
     trace_count++;
     wrapped.raise_tree(root);
 }
@@ -551,8 +310,7 @@ void miral::WindowManagementTrace::modify_window(
     miral::WindowInfo& window_info, miral::WindowSpecification const& modifications)
 try {
     log_input();
-    mir::log_info("%s window_info=%s, modifications=%s",
-                  __func__, dump_of(window_info).c_str(), dump_of(modifications).c_str());
+    trace_call(__func__, {field("window_info", window_info), field("modifications", modifications)});
     trace_count++;
     wrapped.modify_window(window_info, modifications);
 }
@@ -560,14 +318,28 @@ MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::invoke_under_lock(std::function<void()> const& callback)
 try {
-    mir::log_info("%s", __func__);
+    trace_call(__func__, {});
     wrapped.invoke_under_lock(callback);
 }
 MIRAL_TRACE_EXCEPTION
 
+void miral::WindowManagementTrace::invoke_under_shared_lock(std::function<void()> const& callback)
+try {
+    trace_call(__func__, {});
+    wrapped.invoke_under_shared_lock(callback);
+}
+MIRAL_TRACE_EXCEPTION
+
+auto miral::WindowManagementTrace::scene_snapshot() const -> std::shared_ptr<SceneSnapshot const>
+try {
+    trace_call(__func__, {});
+    return wrapped.scene_snapshot();
+}
+MIRAL_TRACE_EXCEPTION
+
 auto miral::WindowManagementTrace::create_workspace() -> std::shared_ptr<Workspace>
 try {
-    mir::log_info("%s", __func__);
+    trace_call(__func__, {});
     return wrapped.create_workspace();
 }
 MIRAL_TRACE_EXCEPTION
@@ -575,7 +347,7 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::add_tree_to_workspace(
     miral::Window const& window, std::shared_ptr<miral::Workspace> const& workspace)
 try {
-    mir::log_info("%s window=%s, workspace =%p", __func__, dump_of(window).c_str(), workspace.get());
+    trace_call(__func__, {field("window", window), field("workspace ", workspace.get())});
     wrapped.add_tree_to_workspace(window, workspace);
 }
 MIRAL_TRACE_EXCEPTION
@@ -583,7 +355,7 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::remove_tree_from_workspace(
     miral::Window const& window, std::shared_ptr<miral::Workspace> const& workspace)
 try {
-    mir::log_info("%s window=%s, workspace =%p", __func__, dump_of(window).c_str(), workspace.get());
+    trace_call(__func__, {field("window", window), field("workspace ", workspace.get())});
     wrapped.remove_tree_from_workspace(window, workspace);
 }
 MIRAL_TRACE_EXCEPTION
@@ -591,7 +363,7 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::move_workspace_content_to_workspace(
     std::shared_ptr<Workspace> const& to_workspace, std::shared_ptr<Workspace> const& from_workspace)
 try {
-    mir::log_info("%s to_workspace=%p, from_workspace=%p", __func__, to_workspace.get(), from_workspace.get());
+    trace_call(__func__, {field("to_workspace", to_workspace.get()), field("from_workspace", from_workspace.get())});
     wrapped.move_workspace_content_to_workspace(to_workspace, from_workspace);
 }
 MIRAL_TRACE_EXCEPTION
@@ -599,7 +371,7 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::for_each_workspace_containing(
     miral::Window const& window, std::function<void(std::shared_ptr<miral::Workspace> const&)> const& callback)
 try {
-    mir::log_info("%s window=%s", __func__, dump_of(window).c_str());
+    trace_call(__func__, {field("window", window)});
     wrapped.for_each_workspace_containing(window, callback);
 }
 MIRAL_TRACE_EXCEPTION
@@ -607,7 +379,7 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::for_each_window_in_workspace(
     std::shared_ptr<miral::Workspace> const& workspace, std::function<void(miral::Window const&)> const& callback)
 try {
-    mir::log_info("%s workspace =%p", __func__, workspace.get());
+    trace_call(__func__, {field("workspace ", workspace.get())});
     wrapped.for_each_window_in_workspace(workspace, callback);
 }
 MIRAL_TRACE_EXCEPTION
@@ -617,15 +389,17 @@ auto miral::WindowManagementTrace::place_new_window(
     WindowSpecification const& requested_specification) -> WindowSpecification
 try {
     auto const result = policy->place_new_window(app_info, requested_specification);
-    mir::log_info("%s app_info=%s, requested_specification=%s -> %s",
-              __func__, dump_of(app_info).c_str(), dump_of(requested_specification).c_str(), dump_of(result).c_str());
+    trace_call(__func__, {
+            field("app_info", app_info),
+            field("requested_specification", requested_specification),
+            field("->", result)});
     return result;
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::handle_window_ready(miral::WindowInfo& window_info)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    trace_call(__func__, {field("window_info", window_info)});
     policy->handle_window_ready(window_info);
 }
 MIRAL_TRACE_EXCEPTION
@@ -633,15 +407,14 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::handle_modify_window(
     miral::WindowInfo& window_info, miral::WindowSpecification const& modifications)
 try {
-    mir::log_info("%s window_info=%s, modifications=%s",
-                  __func__, dump_of(window_info).c_str(), dump_of(modifications).c_str());
+    trace_call(__func__, {field("window_info", window_info), field("modifications", modifications)});
     policy->handle_modify_window(window_info, modifications);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::handle_raise_window(miral::WindowInfo& window_info)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    trace_call(__func__, {field("window_info", window_info)});
     policy->handle_raise_window(window_info);
 }
 MIRAL_TRACE_EXCEPTION
@@ -650,7 +423,7 @@ bool miral::WindowManagementTrace::handle_keyboard_event(MirKeyboardEvent const*
 try {
     log_input = [event, this]
         {
-            mir::log_info("handle_keyboard_event event=%s", dump_of(event).c_str());
+            trace_call("handle_keyboard_event", {field("event", event)});
             log_input = []{};
         };
 
@@ -662,7 +435,7 @@ bool miral::WindowManagementTrace::handle_touch_event(MirTouchEvent const* event
 try {
     log_input = [event, this]
         {
-            mir::log_info("handle_touch_event event=%s", dump_of(event).c_str());
+            trace_call("handle_touch_event", {field("event", event)});
             log_input = []{};
         };
 
@@ -674,7 +447,7 @@ bool miral::WindowManagementTrace::handle_pointer_event(MirPointerEvent const* e
 try {
     log_input = [event, this]
         {
-            mir::log_info("handle_pointer_event event=%s", dump_of(event).c_str());
+            trace_call("handle_pointer_event", {field("event", event)});
             log_input = []{};
         };
 
@@ -685,9 +458,7 @@ MIRAL_TRACE_EXCEPTION
 auto miral::WindowManagementTrace::confirm_inherited_move(WindowInfo const& window_info, Displacement movement)
 -> Rectangle
 try {
-    std::stringstream out;
-    out << movement;
-    mir::log_info("%s window_info=%s, movement=%s", __func__, dump_of(window_info).c_str(), out.str().c_str());
+    trace_call(__func__, {field("window_info", window_info), field("movement", movement)});
 
     return policy->confirm_inherited_move(window_info, movement);
 }
@@ -704,77 +475,96 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::advise_end()
 try {
     if (trace_count.load() > 0)
-        mir::log_info("====");
+    {
+        trace_call("====", {});
+    }
     policy->advise_end();
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_new_app(miral::ApplicationInfo& application)
 try {
-    mir::log_info("%s application=%s", __func__, dump_of(application).c_str());
+    trace_call(__func__, {field("application", application)});
     policy->advise_new_app(application);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_delete_app(miral::ApplicationInfo const& application)
 try {
-    mir::log_info("%s application=%s", __func__, dump_of(application).c_str());
+    trace_call(__func__, {field("application", application)});
     policy->advise_delete_app(application);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_new_window(miral::WindowInfo const& window_info)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    trace_call(__func__, {field("window_info", window_info)});
     policy->advise_new_window(window_info);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_focus_lost(miral::WindowInfo const& window_info)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    trace_call(__func__, {field("window_info", window_info)});
     policy->advise_focus_lost(window_info);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_focus_gained(miral::WindowInfo const& window_info)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    trace_call(__func__, {field("window_info", window_info)});
     policy->advise_focus_gained(window_info);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_state_change(miral::WindowInfo const& window_info, MirWindowState state)
 try {
-    mir::log_info("%s window_info=%s, state=%s", __func__, dump_of(window_info).c_str(), dump_of(state).c_str());
+    trace_call(__func__, {field("window_info", window_info), field("state", state)});
     policy->advise_state_change(window_info, state);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_move_to(miral::WindowInfo const& window_info, mir::geometry::Point top_left)
 try {
-    mir::log_info("%s window_info=%s, top_left=%s", __func__, dump_of(window_info).c_str(), dump_of(top_left).c_str());
+    trace_call(__func__, {field("window_info", window_info), field("top_left", top_left)});
     policy->advise_move_to(window_info, top_left);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_resize(miral::WindowInfo const& window_info, mir::geometry::Size const& new_size)
 try {
-    mir::log_info("%s window_info=%s, new_size=%s", __func__, dump_of(window_info).c_str(), dump_of(new_size).c_str());
+    trace_call(__func__, {field("window_info", window_info), field("new_size", new_size)});
     policy->advise_resize(window_info, new_size);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_delete_window(miral::WindowInfo const& window_info)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    trace_call(__func__, {field("window_info", window_info)});
     policy->advise_delete_window(window_info);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_raise(std::vector<miral::Window> const& windows)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(windows).c_str());
+    trace_call(__func__, {field("window_info", windows)});
     policy->advise_raise(windows);
 }
 MIRAL_TRACE_EXCEPTION
+
+void miral::WindowManagementTrace::advise_geometry_batch(std::vector<GeometryChange> const& changes)
+try {
+    for (auto const& change : changes)
+    {
+        if (change.top_left.is_set() && change.size.is_set())
+            trace_call(__func__, {field("window", change.window),
+                field("top_left", change.top_left.value()), field("size", change.size.value())});
+        else if (change.top_left.is_set())
+            trace_call(__func__, {field("window", change.window), field("top_left", change.top_left.value())});
+        else if (change.size.is_set())
+            trace_call(__func__, {field("window", change.window), field("size", change.size.value())});
+    }
+
+    forward_geometry_batch(*policy, wrapped, changes);
+}
+MIRAL_TRACE_EXCEPTION
@@ -19,20 +19,31 @@
 #ifndef MIRAL_WINDOW_MANAGEMENT_TRACE_H
 #define MIRAL_WINDOW_MANAGEMENT_TRACE_H
 
+#include "trace_format.h"
 #include "window_manager_tools_implementation.h"
 
+#include "miral/geometry_batch_policy.h"
 #include "miral/window_manager_tools.h"
 #include "miral/window_management_options.h"
 #include "miral/window_management_policy.h"
 
 #include <atomic>
+#include <initializer_list>
 
 namespace miral
 {
-class WindowManagementTrace : public WindowManagementPolicy, WindowManagerToolsImplementation
+class TraceRingBuffer;
+
+/// Traces the calls between the window manager and the policy. By default
+/// these are logged as text, if a TraceRingBuffer is supplied they are
+/// recorded there instead (and miral-trace-decode produces the same text).
+class WindowManagementTrace : public WindowManagementPolicy, WindowManagerToolsImplementation, GeometryBatchPolicy
 {
 public:
-    WindowManagementTrace(WindowManagerTools const& wrapped, WindowManagementPolicyBuilder const& builder);
+    WindowManagementTrace(
+        WindowManagerTools const& wrapped,
+        WindowManagementPolicyBuilder const& builder,
+        std::shared_ptr<TraceRingBuffer> const& binary = {});
 
 private:
     virtual auto count_applications() const -> unsigned int override;
@@ -50,10 +61,16 @@ private:
 
     virtual void ask_client_to_close(Window const& window) override;
     virtual void force_close(Window const& window) override;
+    virtual void close_window(
+        Window const& window,
+        std::chrono::milliseconds timeout,
+        std::function<void(bool forced)> const& on_closed) override;
 
     virtual auto active_window() const -> Window override;
     virtual auto select_active_window(Window const& hint) -> Window override;
     virtual auto window_at(mir::geometry::Point cursor) const -> Window override;
+    virtual auto windows_at(mir::geometry::Point point) const -> std::vector<Window> override;
+    virtual auto windows_in(mir::geometry::Rectangle const& area) const -> std::vector<Window> override;
     virtual auto active_display() -> mir::geometry::Rectangle const override;
     virtual auto info_for_window_id(std::string const& id) const -> WindowInfo& override;
     virtual auto id_for_window(Window const& window) const -> std::string override;
@@ -73,6 +90,9 @@ private:
     virtual void modify_window(WindowInfo& window_info, WindowSpecification const& modifications) override;
 
     virtual void invoke_under_lock(std::function<void()> const& callback) override;
+    virtual void invoke_under_shared_lock(std::function<void()> const& callback) override;
+
+    virtual auto scene_snapshot() const -> std::shared_ptr<SceneSnapshot const> override;
 
     virtual auto place_new_window(
         ApplicationInfo const& app_info,
@@ -133,8 +153,13 @@ public:
 
     virtual void advise_raise(std::vector<Window> const& windows) override;
 
+    void advise_geometry_batch(std::vector<GeometryChange> const& changes) override;
+
 private:
+    void trace_call(char const* function, std::initializer_list<trace::Field> fields) const;
+
     WindowManagerTools wrapped;
+    std::shared_ptr<TraceRingBuffer> const binary;
     std::unique_ptr<miral::WindowManagementPolicy> const policy;
     std::atomic<unsigned> mutable trace_count;
     std::function<void()> log_input;
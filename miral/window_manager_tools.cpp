@@ -53,6 +53,10 @@ void miral::WindowManagerTools::ask_client_to_close(Window const& window)
 void miral::WindowManagerTools::force_close(Window const& window)
 { tools->force_close(window); }
 
+void miral::WindowManagerTools::close_window(
+    Window const& window, std::chrono::milliseconds timeout, std::function<void(bool forced)> const& on_closed)
+{ tools->close_window(window, timeout, on_closed); }
+
 auto miral::WindowManagerTools::active_window() const -> Window
 { return tools->active_window(); }
 
@@ -77,6 +81,12 @@ void miral::WindowManagerTools::focus_prev_within_application()
 auto miral::WindowManagerTools::window_at(mir::geometry::Point cursor) const -> Window
 { return tools->window_at(cursor); }
 
+auto miral::WindowManagerTools::windows_at(mir::geometry::Point point) const -> std::vector<Window>
+{ return tools->windows_at(point); }
+
+auto miral::WindowManagerTools::windows_in(mir::geometry::Rectangle const& area) const -> std::vector<Window>
+{ return tools->windows_in(area); }
+
 auto miral::WindowManagerTools::active_display() -> mir::geometry::Rectangle const
 { return tools->active_display(); }
 
@@ -98,6 +108,12 @@ auto miral::WindowManagerTools::id_for_window(Window const& window) const -> std
 void miral::WindowManagerTools::invoke_under_lock(std::function<void()> const& callback)
 { tools->invoke_under_lock(callback); }
 
+void miral::WindowManagerTools::invoke_under_shared_lock(std::function<void()> const& callback)
+{ tools->invoke_under_shared_lock(callback); }
+
+auto miral::WindowManagerTools::scene_snapshot() const -> std::shared_ptr<SceneSnapshot const>
+{ return tools->scene_snapshot(); }
+
 void miral::WindowManagerTools::place_and_size_for_state(
     WindowSpecification& modifications, WindowInfo const& window_info) const
 { tools->place_and_size_for_state(modifications, window_info); }
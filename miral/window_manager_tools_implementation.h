@@ -24,8 +24,10 @@
 #include <mir/geometry/displacement.h>
 #include <mir/geometry/rectangle.h>
 
+#include <chrono>
 #include <functional>
 #include <memory>
+#include <vector>
 
 namespace mir { namespace scene { class Surface; } }
 
@@ -36,6 +38,7 @@ struct WindowInfo;
 struct ApplicationInfo;
 class WindowSpecification;
 class Workspace;
+struct SceneSnapshot;
 
 // The interface through which the policy instructs the controller.
 class WindowManagerToolsImplementation
@@ -56,6 +59,10 @@ public:
 
     virtual void ask_client_to_close(Window const& window) = 0;
     virtual void force_close(Window const& window) = 0;
+    virtual void close_window(
+        Window const& window,
+        std::chrono::milliseconds timeout,
+        std::function<void(bool forced)> const& on_closed) = 0;
     virtual auto active_window() const -> Window = 0;
     virtual auto select_active_window(Window const& hint) -> Window = 0;
     virtual void drag_active_window(mir::geometry::Displacement movement) = 0;
@@ -64,6 +71,8 @@ public:
     virtual void focus_next_within_application() = 0;
     virtual void focus_prev_within_application() = 0;
     virtual auto window_at(mir::geometry::Point cursor) const -> Window = 0;
+    virtual auto windows_at(mir::geometry::Point point) const -> std::vector<Window> = 0;
+    virtual auto windows_in(mir::geometry::Rectangle const& area) const -> std::vector<Window> = 0;
     virtual auto active_display() -> mir::geometry::Rectangle const = 0;
     virtual void raise_tree(Window const& root) = 0;
     virtual void modify_window(WindowInfo& window_info, WindowSpecification const& modifications) = 0;
@@ -93,6 +102,12 @@ public:
  *  already holds the lock).
  *  @{ */
     virtual void invoke_under_lock(std::function<void()> const& callback) = 0;
+
+    /// Only for calling the const "Query Model" functions (readers may run concurrently)
+    virtual void invoke_under_shared_lock(std::function<void()> const& callback) = 0;
+
+    /// The most recently published snapshot of the model (no lock required)
+    virtual auto scene_snapshot() const -> std::shared_ptr<SceneSnapshot const> = 0;
 /** @} */
 
     virtual ~WindowManagerToolsImplementation() = default;
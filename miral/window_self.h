@@ -0,0 +1,74 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_WINDOW_SELF_H
+#define MIRAL_WINDOW_SELF_H
+
+#include "miral/window.h"
+
+#include <mir/optional_value.h>
+
+#include <atomic>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+namespace miral
+{
+class GeometryBatch;
+
+struct Window::Self
+{
+    Self(std::shared_ptr<mir::scene::Session> const& session, std::shared_ptr<mir::scene::Surface> const& surface);
+
+    std::weak_ptr<mir::scene::Session> const session;
+    std::weak_ptr<mir::scene::Surface> const surface;
+
+    // Geometry BasicWindowManager has given the window while a batch is open is held
+    // here (and reported by the Window) until the batch commits. The batch also hears
+    // of changes made directly through the Window.
+    // (Guarded by mutex as Window geometry may be read and changed from any thread.)
+    std::mutex mutable mutex;
+    std::weak_ptr<GeometryBatch> batch;
+    mir::optional_value<mir::geometry::Point> pending_top_left;
+    mir::optional_value<mir::geometry::Size> pending_size;
+    std::atomic<bool> has_pending{false};   // Either of the above is set
+    bool batched{false};                    // In the batch's pending windows
+    bool changed_directly{false};           // In the batch's directly changed windows (guarded by the batch)
+
+    // The surface attributes as last notified to SurfaceCache (used if cached is set)
+    // or changed through the Window. This saves readers locking the surface for a virtual call.
+    void cache_geometry_from(mir::scene::Surface const& surface);
+    void cache_attributes_from(mir::scene::Surface const& surface);
+    std::atomic<bool> cached{false};
+    std::atomic<mir::geometry::Point> cached_top_left;
+    std::atomic<mir::geometry::Size> cached_size;
+    std::atomic<MirWindowState> cached_state{mir_window_state_unknown};
+    std::atomic<bool> cached_visible{false};
+};
+
+inline auto window_self(Window const& window) -> std::shared_ptr<Window::Self> const&
+{
+    return window.self;
+}
+
+/// Window::Self (which is private to Window)
+using WindowSelf = std::remove_reference<decltype(window_self(std::declval<Window const&>()))>::type::element_type;
+}
+
+#endif //MIRAL_WINDOW_SELF_H
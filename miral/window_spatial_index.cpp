@@ -0,0 +1,230 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "window_spatial_index.h"
+
+#include <algorithm>
+
+using namespace mir::geometry;
+
+namespace
+{
+auto cell_of(int coordinate) -> int
+{
+    auto const size = miral::WindowSpatialIndex::cell_size;
+    return coordinate >= 0 ? coordinate/size : -((size - 1 - coordinate)/size);
+}
+
+void erase_from(std::vector<miral::Window>& windows, miral::Window const& window)
+{
+    auto const i = std::find(begin(windows), end(windows), window);
+
+    if (i != end(windows))
+    {
+        *i = windows.back();
+        windows.pop_back();
+    }
+}
+}
+
+auto miral::WindowSpatialIndex::Cells::count() const -> long
+{
+    return right < left || bottom < top ? 0 : long(right - left + 1)*(bottom - top + 1);
+}
+
+auto miral::WindowSpatialIndex::cells_for(Rectangle const& extent) -> Cells
+{
+    auto const width = extent.size.width.as_int();
+    auto const height = extent.size.height.as_int();
+    auto const left = extent.top_left.x.as_int();
+    auto const top = extent.top_left.y.as_int();
+
+    if (width <= 0 || height <= 0)
+        return {0, 0, -1, -1};
+
+    return {cell_of(left), cell_of(top), cell_of(left + width - 1), cell_of(top + height - 1)};
+}
+
+auto miral::WindowSpatialIndex::key(int x, int y) -> std::uint64_t
+{
+    return (std::uint64_t(std::uint32_t(x)) << 32) | std::uint32_t(y);
+}
+
+void miral::WindowSpatialIndex::insert_into_grid(Window const& window, Entry const& entry)
+{
+    if (entry.large)
+    {
+        large.push_back(window);
+        return;
+    }
+
+    for (auto y = entry.cells.top; y <= entry.cells.bottom; ++y)
+        for (auto x = entry.cells.left; x <= entry.cells.right; ++x)
+            grid[key(x, y)].push_back(window);
+}
+
+void miral::WindowSpatialIndex::remove_from_grid(Window const& window, Entry const& entry)
+{
+    if (entry.large)
+    {
+        erase_from(large, window);
+        return;
+    }
+
+    for (auto y = entry.cells.top; y <= entry.cells.bottom; ++y)
+        for (auto x = entry.cells.left; x <= entry.cells.right; ++x)
+        {
+            auto const cell = grid.find(key(x, y));
+
+            if (cell == grid.end())
+                continue;
+
+            erase_from(cell->second, window);
+
+            if (cell->second.empty())
+                grid.erase(cell);
+        }
+}
+
+void miral::WindowSpatialIndex::change_extent(Window const& window, Entry& entry, Rectangle const& extent)
+{
+    auto const cells = cells_for(extent);
+    Entry const updated{extent, cells, cells.count() > max_cells_per_window};
+
+    // A move within the same cells only changes the extent
+    if (entry.large != updated.large ||
+        entry.cells.left != cells.left || entry.cells.top != cells.top ||
+        entry.cells.right != cells.right || entry.cells.bottom != cells.bottom)
+    {
+        remove_from_grid(window, entry);
+        insert_into_grid(window, updated);
+    }
+
+    entry = updated;
+}
+
+void miral::WindowSpatialIndex::update(Window const& window, Rectangle const& extent)
+{
+    auto const existing = entries.find(window);
+
+    if (existing == entries.end())
+    {
+        auto const cells = cells_for(extent);
+        Entry const entry{extent, cells, cells.count() > max_cells_per_window};
+        insert_into_grid(window, entry);
+        entries.emplace(window, entry);
+        return;
+    }
+
+    change_extent(window, existing->second, extent);
+}
+
+void miral::WindowSpatialIndex::refresh(Window const& window, Rectangle const& extent)
+{
+    auto const existing = entries.find(window);
+
+    if (existing != entries.end())
+        change_extent(window, existing->second, extent);
+}
+
+void miral::WindowSpatialIndex::erase(Window const& window)
+{
+    auto const existing = entries.find(window);
+
+    if (existing == entries.end())
+        return;
+
+    remove_from_grid(window, existing->second);
+    entries.erase(existing);
+}
+
+auto miral::WindowSpatialIndex::windows_at(Point point) const -> std::vector<Window>
+{
+    std::vector<Window> result;
+
+    auto const cell = grid.find(key(cell_of(point.x.as_int()), cell_of(point.y.as_int())));
+
+    if (cell != grid.end())
+    {
+        for (auto const& window : cell->second)
+        {
+            if (entries.at(window).extent.contains(point))
+                result.push_back(window);
+        }
+    }
+
+    for (auto const& window : large)
+    {
+        if (entries.at(window).extent.contains(point))
+            result.push_back(window);
+    }
+
+    return result;
+}
+
+auto miral::WindowSpatialIndex::windows_in(Rectangle const& area) const -> std::vector<Window>
+{
+    std::vector<Window> result;
+
+    auto const cells = cells_for(area);
+
+    if (cells.count() == 0)
+        return result;
+
+    // For a big enough area it is quicker to check every window
+    if (cells.count() > long(entries.size()))
+    {
+        for (auto const& entry : entries)
+        {
+            if (entry.second.extent.overlaps(area))
+                result.push_back(entry.first);
+        }
+
+        return result;
+    }
+
+    for (auto y = cells.top; y <= cells.bottom; ++y)
+        for (auto x = cells.left; x <= cells.right; ++x)
+        {
+            auto const cell = grid.find(key(x, y));
+
+            if (cell == grid.end())
+                continue;
+
+            for (auto const& window : cell->second)
+            {
+                auto const& entry = entries.at(window);
+
+                // A window is reported from the first cell it shares with area, so only once
+                if (x == std::max(entry.cells.left, cells.left) &&
+                    y == std::max(entry.cells.top, cells.top) &&
+                    entry.extent.overlaps(area))
+                {
+                    result.push_back(window);
+                }
+            }
+        }
+
+    for (auto const& window : large)
+    {
+        if (entries.at(window).extent.overlaps(area))
+            result.push_back(window);
+    }
+
+    return result;
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_WINDOW_SPATIAL_INDEX_H
+#define MIRAL_WINDOW_SPATIAL_INDEX_H
+
+#include "miral/window.h"
+
+#include <mir/geometry/rectangle.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace miral
+{
+/// A uniform grid over window extents: point and rectangle queries visit only the
+/// windows in the cells concerned. (Windows covering very many cells are kept apart
+/// and checked individually.)
+class WindowSpatialIndex
+{
+public:
+    static int const cell_size = 256;
+    static int const max_cells_per_window = 64;
+
+    /// Add window, or update its extent
+    void update(Window const& window, mir::geometry::Rectangle const& extent);
+
+    /// Update the extent of window if it is in the index
+    void refresh(Window const& window, mir::geometry::Rectangle const& extent);
+    void erase(Window const& window);
+
+    /// The windows whose extent contains point (in no particular order)
+    auto windows_at(mir::geometry::Point point) const -> std::vector<Window>;
+
+    /// The windows whose extent overlaps area (in no particular order)
+    auto windows_in(mir::geometry::Rectangle const& area) const -> std::vector<Window>;
+
+private:
+    // Inclusive range of cell coordinates
+    struct Cells
+    {
+        int left;
+        int top;
+        int right;
+        int bottom;
+
+        auto count() const -> long;
+    };
+
+    struct Entry
+    {
+        mir::geometry::Rectangle extent;
+        Cells cells;
+        bool large;
+    };
+
+    static auto cells_for(mir::geometry::Rectangle const& extent) -> Cells;
+    static auto key(int x, int y) -> std::uint64_t;
+
+    void insert_into_grid(Window const& window, Entry const& entry);
+    void change_extent(Window const& window, Entry& entry, mir::geometry::Rectangle const& extent);
+    void remove_from_grid(Window const& window, Entry const& entry);
+
+    std::unordered_map<Window, Entry> entries;
+    std::unordered_map<std::uint64_t, std::vector<Window>> grid;
+    std::vector<Window> large;
+};
+}
+
+#endif //MIRAL_WINDOW_SPATIAL_INDEX_H
@@ -26,16 +26,17 @@ struct miral::WindowSpecification::Self
 {
     Self() = default;
     Self(Self const&) = default;
+    auto operator=(Self const&) -> Self& = default;
     Self(mir::shell::SurfaceSpecification const& spec);
     Self(mir::scene::SurfaceCreationParameters const& params);
 
     void update(mir::scene::SurfaceCreationParameters& params) const;
 
+    // Plain values: copying these involves no allocation
     mir::optional_value<Point> top_left;
     mir::optional_value<Size> size;
     mir::optional_value<MirPixelFormat> pixel_format;
     mir::optional_value<BufferUsage> buffer_usage;
-    mir::optional_value<std::string> name;
     mir::optional_value<int> output_id;
     mir::optional_value<MirWindowType> type;
     mir::optional_value<MirWindowState> state;
@@ -54,12 +55,16 @@ struct miral::WindowSpecification::Self
     mir::optional_value<DeltaY> height_inc;
     mir::optional_value<AspectRatio> min_aspect;
     mir::optional_value<AspectRatio> max_aspect;
-    mir::optional_value<std::vector<mir::shell::StreamSpecification>> streams;
-    mir::optional_value<std::weak_ptr<mir::scene::Surface>> parent;
-    mir::optional_value<std::vector<Rectangle>> input_shape;
     mir::optional_value<InputReceptionMode> input_mode;
     mir::optional_value<MirShellChrome> shell_chrome;
     mir::optional_value<MirPointerConfinementState> confine_pointer;
+
+    // Fields that own resources. Unset, these are empty and copy without allocating, and
+    // keeping them here means that reading one never allocates either.
+    mir::optional_value<std::string> name;
+    mir::optional_value<std::vector<mir::shell::StreamSpecification>> streams;
+    mir::optional_value<std::weak_ptr<mir::scene::Surface>> parent;
+    mir::optional_value<std::vector<Rectangle>> input_shape;
     mir::optional_value<std::shared_ptr<void>> userdata;
 };
 
@@ -68,7 +73,6 @@ miral::WindowSpecification::Self::Self(mir::shell::SurfaceSpecification const& s
     size(),
     pixel_format(spec.pixel_format),
     buffer_usage(),
-    name(spec.name),
     output_id(),
     type(spec.type),
     state(spec.state),
@@ -87,9 +91,6 @@ miral::WindowSpecification::Self::Self(mir::shell::SurfaceSpecification const& s
     height_inc(spec.height_inc),
     min_aspect(),
     max_aspect(),
-    streams(spec.streams),
-    parent(spec.parent),
-    input_shape(spec.input_shape),
     input_mode(),
     shell_chrome(spec.shell_chrome)
 #if MIRAL_MIR_DEFINES_POINTER_CONFINEMENT
@@ -135,6 +136,18 @@ miral::WindowSpecification::Self::Self(mir::shell::SurfaceSpecification const& s
         }
     }
 
+    if (spec.name.is_set())
+        name = spec.name;
+
+    if (spec.streams.is_set())
+        streams = spec.streams;
+
+    if (spec.parent.is_set())
+        parent = spec.parent;
+
+    if (spec.input_shape.is_set())
+        input_shape = spec.input_shape;
+
     if (spec.width.is_set() && spec.height.is_set())
         size = Size(spec.width.value(), spec.height.value());
 
@@ -223,7 +236,6 @@ miral::WindowSpecification::Self::Self(mir::scene::SurfaceCreationParameters con
     size(params.size),
     pixel_format(params.pixel_format),
     buffer_usage(static_cast<BufferUsage>(params.buffer_usage)),
-    name(params.name),
     output_id(params.output_id.as_value()),
     type(params.type),
     state(params.state),
@@ -242,13 +254,6 @@ miral::WindowSpecification::Self::Self(mir::scene::SurfaceCreationParameters con
     height_inc(params.height_inc),
     min_aspect(),
     max_aspect(),
-#if MIR_SERVER_VERSION >= MIR_VERSION_NUMBER(0, 22, 0)
-    streams(params.streams),
-#else
-    streams(),
-#endif
-    parent(params.parent),
-    input_shape(params.input_shape),
     input_mode(static_cast<InputReceptionMode>(params.input_mode)),
     shell_chrome(params.shell_chrome)
 #if MIRAL_MIR_DEFINES_POINTER_CONFINEMENT
@@ -294,6 +299,19 @@ miral::WindowSpecification::Self::Self(mir::scene::SurfaceCreationParameters con
         }
     }
 
+    name = params.name;
+
+#if MIR_SERVER_VERSION >= MIR_VERSION_NUMBER(0, 22, 0)
+    if (params.streams.is_set())
+        streams = params.streams;
+#endif
+
+    if (params.parent.is_set())
+        parent = params.parent;
+
+    if (params.input_shape.is_set())
+        input_shape = params.input_shape;
+
     if (params.content_id.is_set())
         content_id = BufferStreamId{params.content_id.value().as_value()};
 
@@ -372,7 +390,7 @@ miral::WindowSpecification::WindowSpecification(WindowSpecification const& that)
 
 auto miral::WindowSpecification::operator=(WindowSpecification const& that) -> WindowSpecification&
 {
-    self = std::make_unique<Self>(*that.self);
+    *self = *that.self;
     return *this;
 }
 
@@ -0,0 +1,214 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "workspace_index.h"
+
+#include <algorithm>
+
+void miral::WorkspaceSet::insert(Slot slot)
+{
+    if (slot < bits_per_word)
+    {
+        first |= uint64_t{1} << slot;
+        return;
+    }
+
+    auto const word = slot/bits_per_word - 1;
+
+    if (rest.size() <= word)
+        rest.resize(word + 1);
+
+    rest[word] |= uint64_t{1} << (slot % bits_per_word);
+}
+
+void miral::WorkspaceSet::erase(Slot slot)
+{
+    if (slot < bits_per_word)
+    {
+        first &= ~(uint64_t{1} << slot);
+        return;
+    }
+
+    auto const word = slot/bits_per_word - 1;
+
+    if (word < rest.size())
+        rest[word] &= ~(uint64_t{1} << (slot % bits_per_word));
+}
+
+auto miral::WorkspaceSet::contains(Slot slot) const -> bool
+{
+    if (slot < bits_per_word)
+        return (first & (uint64_t{1} << slot)) != 0;
+
+    auto const word = slot/bits_per_word - 1;
+
+    return word < rest.size() && (rest[word] & (uint64_t{1} << (slot % bits_per_word))) != 0;
+}
+
+auto miral::WorkspaceSet::empty() const -> bool
+{
+    return !first && std::all_of(begin(rest), end(rest), [](uint64_t word) { return !word; });
+}
+
+auto miral::WorkspaceSet::intersects(WorkspaceSet const& that) const -> bool
+{
+    if (first & that.first)
+        return true;
+
+    auto const words = std::min(rest.size(), that.rest.size());
+
+    for (auto i = 0u; i != words; ++i)
+        if (rest[i] & that.rest[i])
+            return true;
+
+    return false;
+}
+
+void miral::WorkspaceSet::for_each(std::function<void(Slot slot)> const& f) const
+{
+    for (auto bit = 0u; bit != bits_per_word; ++bit)
+        if (first & (uint64_t{1} << bit))
+            f(bit);
+
+    for (auto word = 0u; word != rest.size(); ++word)
+        for (auto bit = 0u; bit != bits_per_word; ++bit)
+            if (rest[word] & (uint64_t{1} << bit))
+                f((word + 1)*bits_per_word + bit);
+}
+
+auto miral::WorkspaceIndex::allocate_slot() -> Slot
+{
+    if (free_slots.empty())
+    {
+        slots.emplace_back();
+        return slots.size() - 1;
+    }
+
+    auto const slot = free_slots.back();
+    free_slots.pop_back();
+    return slot;
+}
+
+void miral::WorkspaceIndex::attach(Slot slot, std::weak_ptr<Workspace> const& workspace)
+{
+    slots[slot].workspace = workspace;
+}
+
+void miral::WorkspaceIndex::release_slot(Slot slot)
+{
+    clear(slot);
+    slots[slot].workspace.reset();
+    free_slots.push_back(slot);
+}
+
+auto miral::WorkspaceIndex::insert(Slot slot, Window const& window) -> bool
+{
+    auto& workspaces = memberships[window];
+
+    if (workspaces.contains(slot))
+        return false;
+
+    workspaces.insert(slot);
+    slots[slot].windows.push_back(window);
+    return true;
+}
+
+auto miral::WorkspaceIndex::erase(Slot slot, Window const& window) -> bool
+{
+    auto const i = memberships.find(window);
+
+    if (i == memberships.end() || !i->second.contains(slot))
+        return false;
+
+    i->second.erase(slot);
+
+    if (i->second.empty())
+        memberships.erase(i);
+
+    auto& windows = slots[slot].windows;
+    windows.erase(std::find(begin(windows), end(windows), window));
+    return true;
+}
+
+void miral::WorkspaceIndex::erase(Window const& window)
+{
+    auto const i = memberships.find(window);
+
+    if (i == memberships.end())
+        return;
+
+    i->second.for_each([&](Slot slot)
+        {
+            auto& windows = slots[slot].windows;
+            windows.erase(std::find(begin(windows), end(windows), window));
+        });
+
+    memberships.erase(i);
+}
+
+auto miral::WorkspaceIndex::clear(Slot slot) -> std::vector<Window>
+{
+    std::vector<Window> windows;
+    windows.swap(slots[slot].windows);
+
+    for (auto const& window : windows)
+    {
+        auto const i = memberships.find(window);
+
+        i->second.erase(slot);
+
+        if (i->second.empty())
+            memberships.erase(i);
+    }
+
+    return windows;
+}
+
+auto miral::WorkspaceIndex::workspaces_containing(Window const& window) const -> WorkspaceSet const&
+{
+    static WorkspaceSet const none;
+
+    auto const i = memberships.find(window);
+    return i != memberships.end() ? i->second : none;
+}
+
+auto miral::WorkspaceIndex::contains(Slot slot, Window const& window) const -> bool
+{
+    return workspaces_containing(window).contains(slot);
+}
+
+auto miral::WorkspaceIndex::shares_workspace(WorkspaceSet const& workspaces, Window const& window) const -> bool
+{
+    return workspaces.intersects(workspaces_containing(window));
+}
+
+auto miral::WorkspaceIndex::windows_in(Slot slot) const -> std::vector<Window> const&
+{
+    return slots[slot].windows;
+}
+
+void miral::WorkspaceIndex::for_each_workspace_in(
+    WorkspaceSet const& workspaces,
+    std::function<void(std::shared_ptr<Workspace> const& workspace)> const& f) const
+{
+    workspaces.for_each([&](Slot slot)
+        {
+            if (auto const workspace = slots[slot].workspace.lock())
+                f(workspace);
+        });
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_WORKSPACE_INDEX_H
+#define MIRAL_WORKSPACE_INDEX_H
+
+#include <miral/window.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace miral
+{
+class Workspace;
+
+/// A set of workspace slots. The first 64 slots need no allocation.
+class WorkspaceSet
+{
+public:
+    using Slot = unsigned;
+
+    void insert(Slot slot);
+    void erase(Slot slot);
+    auto contains(Slot slot) const -> bool;
+    auto empty() const -> bool;
+    auto intersects(WorkspaceSet const& that) const -> bool;
+
+    void for_each(std::function<void(Slot slot)> const& f) const;
+
+private:
+    static unsigned const bits_per_word = 64;
+    uint64_t first{0};
+    std::vector<uint64_t> rest;
+};
+
+/// Tracks which windows are in which workspaces.
+/// Each live workspace owns a slot; each window has a WorkspaceSet of the slots it belongs to.
+/// So "is window in workspace" and "do windows share a workspace" don't depend on the
+/// number of windows or workspaces.
+class WorkspaceIndex
+{
+public:
+    using Slot = WorkspaceSet::Slot;
+
+    auto allocate_slot() -> Slot;
+
+    /// Associate a workspace with its slot (for for_each_workspace_in())
+    void attach(Slot slot, std::weak_ptr<Workspace> const& workspace);
+
+    /// Forget a (dead) workspace and its membership
+    void release_slot(Slot slot);
+
+    /// \return true if window was not already in workspace
+    auto insert(Slot slot, Window const& window) -> bool;
+
+    /// \return true if window was in workspace
+    auto erase(Slot slot, Window const& window) -> bool;
+
+    /// Remove window from all workspaces
+    void erase(Window const& window);
+
+    /// Remove all windows from workspace
+    /// \return the windows removed (in the order they were added)
+    auto clear(Slot slot) -> std::vector<Window>;
+
+    auto workspaces_containing(Window const& window) const -> WorkspaceSet const&;
+
+    auto contains(Slot slot, Window const& window) const -> bool;
+
+    auto shares_workspace(WorkspaceSet const& workspaces, Window const& window) const -> bool;
+
+    /// Windows in a workspace, in the order they were added
+    auto windows_in(Slot slot) const -> std::vector<Window> const&;
+
+    void for_each_workspace_in(
+        WorkspaceSet const& workspaces,
+        std::function<void(std::shared_ptr<Workspace> const& workspace)> const& f) const;
+
+private:
+    struct Members
+    {
+        std::weak_ptr<Workspace> workspace;
+        std::vector<Window> windows;
+    };
+
+    std::vector<Members> slots;
+    std::vector<Slot> free_slots;
+    std::unordered_map<Window, WorkspaceSet> memberships;
+};
+}
+
+#endif //MIRAL_WORKSPACE_INDEX_H
@@ -0,0 +1,48 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_TEST_BENCHMARK_H
+#define MIRAL_TEST_BENCHMARK_H
+
+#include <chrono>
+#include <iostream>
+
+namespace benchmark
+{
+/// The mean time taken by operation(i) for i in [0, repetitions)
+template<typename Operation>
+auto time_per_operation(int repetitions, Operation&& operation) -> std::chrono::nanoseconds
+{
+    auto const start = std::chrono::steady_clock::now();
+
+    for (auto i = 0; i != repetitions; ++i)
+        operation(i);
+
+    auto const elapsed = std::chrono::steady_clock::now() - start;
+
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed/repetitions);
+}
+
+/// Somewhere to write a line of results that lines up with the gtest output
+inline auto report() -> std::ostream&
+{
+    return std::cout << "[          ] ";
+}
+}
+
+#endif //MIRAL_TEST_BENCHMARK_H
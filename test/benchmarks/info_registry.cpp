@@ -0,0 +1,91 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "benchmark.h"
+#include "../../miral/info_registry.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <map>
+#include <vector>
+
+using namespace testing;
+
+namespace
+{
+struct Object { int value; };
+
+struct Info
+{
+    explicit Info(int id) : id{id} {}
+    int id;
+};
+
+using Registry = miral::InfoRegistry<Object, Info>;
+using OwnerLessMap = std::map<std::weak_ptr<Object>, Info, std::owner_less<std::weak_ptr<Object>>>;
+
+struct InfoRegistryLookupCost : TestWithParam<int>
+{
+    std::vector<std::shared_ptr<Object>> objects;
+
+    void SetUp() override
+    {
+        for (auto i = 0; i != GetParam(); ++i)
+            objects.push_back(std::make_shared<Object>(Object{i}));
+    }
+
+    template<typename Lookup>
+    auto time_lookups(Lookup lookup) -> std::chrono::nanoseconds
+    {
+        auto checksum = 0;
+
+        auto const cost = benchmark::time_per_operation(1000000, [&](int i)
+            { checksum += lookup(objects[i % objects.size()]).id; });
+
+        // Keep the optimizer honest
+        EXPECT_THAT(checksum, Ne(-1));
+
+        return cost;
+    }
+};
+}
+
+TEST_P(InfoRegistryLookupCost, compared_to_owner_less_map)
+{
+    OwnerLessMap map;
+    Registry registry;
+
+    for (auto const& object : objects)
+    {
+        map.emplace(object, Info{object->value});
+        registry.emplace(object, object->value);
+    }
+
+    auto const map_cost = time_lookups(
+        [&](std::weak_ptr<Object> const& object) -> Info& { return map.at(object); });
+
+    auto const registry_cost = time_lookups(
+        [&](std::weak_ptr<Object> const& object) -> Info& { return registry.at(object); });
+
+    benchmark::report() << GetParam() << " objects: "
+        << "owner_less map " << map_cost.count() << "ns, "
+        << "registry " << registry_cost.count() << "ns per lookup" << std::endl;
+}
+
+INSTANTIATE_TEST_CASE_P(InfoRegistry, InfoRegistryLookupCost, Values(10, 100, 1000));
@@ -0,0 +1,106 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "benchmark.h"
+#include "../../miral/mru_window_list.h"
+
+#include <mir/test/doubles/stub_surface.h>
+#include <mir/test/doubles/stub_session.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+
+namespace
+{
+struct StubSurface : mir::test::doubles::StubSurface
+{
+    bool visible() const override { return visible_; }
+
+    bool visible_ = true;
+};
+
+struct StubSession : mir::test::doubles::StubSession
+{
+    StubSession(int number_of_surfaces)
+    {
+        for (auto i = 0; i != number_of_surfaces; ++i)
+            surfaces.push_back(std::make_shared<StubSurface>());
+    }
+
+    std::shared_ptr<mir::scene::Surface> surface(mir::frontend::SurfaceId surface) const override
+    {
+        return surfaces.at(surface.as_value());
+    }
+
+    std::vector<std::shared_ptr<StubSurface>> surfaces;
+};
+
+struct MRUWindowListScaling : TestWithParam<int>
+{
+    std::shared_ptr<StubSession> const stub_session{std::make_shared<StubSession>(GetParam())};
+    miral::Application app{stub_session};
+    std::vector<miral::Window> windows;
+    miral::MRUWindowList mru_list;
+
+    void SetUp() override
+    {
+        for (auto i = 0; i != GetParam(); ++i)
+        {
+            windows.emplace_back(app, stub_session->surface(mir::frontend::SurfaceId{i}));
+            mru_list.push(windows.back());
+        }
+    }
+
+    template<typename Operation>
+    auto time_per_operation(Operation operation) -> std::chrono::nanoseconds
+    {
+        return benchmark::time_per_operation(10000, [&](int i) { operation(windows[i % windows.size()]); });
+    }
+};
+}
+
+TEST_P(MRUWindowListScaling, cost_of_operations)
+{
+    // Pushing the least recently used window is the worst case for a sequential list
+    auto const push_cost = time_per_operation([this](miral::Window const&)
+        { mru_list.push(windows[0]); mru_list.push(windows[1]); });
+
+    auto const erase_cost = time_per_operation([this](miral::Window const& window)
+        { mru_list.erase(window); mru_list.push(window); });
+
+    // Hide the most recently used half of the windows, so top() has to look past them
+    for (auto const& window : windows)
+        mru_list.push(window);
+
+    for (auto i = GetParam()/2; i != GetParam(); ++i)
+        stub_session->surfaces[i]->visible_ = false;
+
+    miral::Window top;
+    auto const top_cost = time_per_operation([&](miral::Window const&) { top = mru_list.top(); });
+
+    EXPECT_TRUE(top);
+
+    benchmark::report() << GetParam() << " windows: "
+        << "push " << push_cost.count()/2 << "ns, "
+        << "erase+push " << erase_cost.count() << "ns, "
+        << "top " << top_cost.count() << "ns" << std::endl;
+}
+
+INSTANTIATE_TEST_CASE_P(MRUWindowList, MRUWindowListScaling, Values(10, 100, 1000));
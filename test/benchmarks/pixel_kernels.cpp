@@ -0,0 +1,45 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "benchmark.h"
+#include "../pixel_buffer.h"
+
+#include <gtest/gtest.h>
+
+TEST(PixelKernelCost, compared_to_titlebar_loops)
+{
+    PixelBuffer buffer{titlebar_width, titlebar_height};
+    auto const coverage = random_bytes(titlebar_width*titlebar_height);
+
+    auto const memset_fill_cost = benchmark::time_per_operation(1000, [&](int i) { memset_fill(buffer, i & 0xff); });
+    auto const kernel_fill_cost = benchmark::time_per_operation(1000, [&](int i)
+        { pixel::fill(buffer.pixels.data(), buffer.stride, buffer.width, buffer.height, 0x01010101u*(i & 0xff)); });
+
+    auto const memset_glyph_cost = benchmark::time_per_operation(1000, [&](int i)
+        { memset_glyph(buffer, coverage.data(), i & 0xff); });
+    auto const kernel_blend_cost = benchmark::time_per_operation(1000, [&](int /*i*/)
+        {
+            pixel::blend_coverage(
+                buffer.pixels.data(), buffer.stride, coverage.data(), buffer.width, buffer.width, buffer.height, 0);
+        });
+
+    benchmark::report() << titlebar_width << "x" << titlebar_height << " titlebar: "
+        << "fill: memset " << memset_fill_cost.count() << "ns, kernel " << kernel_fill_cost.count() << "ns; "
+        << "text: memset " << memset_glyph_cost.count() << "ns, kernel " << kernel_blend_cost.count() << "ns"
+        << std::endl;
+}
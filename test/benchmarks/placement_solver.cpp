@@ -0,0 +1,87 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "benchmark.h"
+#include "../../miral/placement_solver.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace miral;
+using namespace mir::geometry;
+using namespace testing;
+
+namespace
+{
+// Popups anchored to each edge of a parent, some of which have to slide, flip or resize to fit
+auto anchored_popup_requests() -> std::vector<PlacementSolver::Request>
+{
+    Rectangle const display{{0, 0}, {800, 600}};
+    Rectangle const parent{{100, 100}, {400, 300}};
+    Size const size{100, 50};
+    Size const rect_size{10, 10};
+
+    std::vector<PlacementSolver::Request> result;
+
+    for (auto const& anchor : {Point{395, 150}, Point{200, -5}, Point{-10, 300}, Point{200, 150}})
+    {
+        result.push_back({parent, {anchor, rect_size}, {},
+            mir_placement_gravity_northeast, mir_placement_gravity_northwest,
+            MirPlacementHints(mir_placement_hints_slide_y|mir_placement_hints_resize_x), size, display});
+
+        result.push_back({parent, {anchor, rect_size}, {},
+            mir_placement_gravity_south, mir_placement_gravity_north,
+            MirPlacementHints(mir_placement_hints_flip_any|mir_placement_hints_antipodes), size, display});
+    }
+
+    return result;
+}
+
+template<typename Place>
+auto time_placements(std::vector<PlacementSolver::Request> const& requests, Place place) -> std::chrono::nanoseconds
+{
+    auto checksum = 0;
+
+    auto const cost = benchmark::time_per_operation(100000, [&](int i)
+        {
+            auto const result = place(requests[i % requests.size()]);
+            if (result.is_set()) checksum += result.value().top_left.x.as_int();
+        });
+
+    // Keep the optimizer honest
+    EXPECT_THAT(checksum, Ne(-1));
+
+    return cost;
+}
+}
+
+TEST(PlacementSolverCost, anchored_popups_solved_compared_to_cached)
+{
+    auto const requests = anchored_popup_requests();
+    PlacementSolver solver;
+
+    auto const solve_cost = time_placements(requests,
+        [&](PlacementSolver::Request const& request) { return PlacementSolver::solve(request); });
+
+    auto const cached_cost = time_placements(requests,
+        [&](PlacementSolver::Request const& request) { return solver.place(request); });
+
+    benchmark::report() << requests.size() << " anchored popups: "
+        << "solved " << solve_cost.count() << "ns, "
+        << "cached " << cached_cost.count() << "ns per placement" << std::endl;
+}
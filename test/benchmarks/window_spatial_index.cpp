@@ -0,0 +1,88 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "benchmark.h"
+#include "../test_window_manager_tools.h"
+
+using namespace miral;
+using namespace testing;
+
+namespace
+{
+struct SpatialQueryCost : TestWindowManagerTools
+{
+    std::vector<Window> windows;
+
+    void SetUp() override
+    {
+        basic_window_manager.add_display({{0, 0}, {640, 480}});
+        basic_window_manager.add_session(session);
+
+        ON_CALL(*window_manager_policy, advise_new_window(_))
+            .WillByDefault(Invoke([this](WindowInfo const& window_info){ windows.push_back(window_info.window()); }));
+    }
+
+    void create_window(Point top_left)
+    {
+        mir::scene::SurfaceCreationParameters creation_parameters;
+        creation_parameters.size = Size{100, 100};
+        basic_window_manager.add_surface(session, creation_parameters, &create_surface);
+
+        window_manager_tools.invoke_under_lock([&]
+            {
+                WindowSpecification modifications;
+                modifications.top_left() = top_left;
+                window_manager_tools.modify_window(windows.back(), modifications);
+            });
+    }
+};
+}
+
+TEST_F(SpatialQueryCost, point_query_at_1000_windows_compared_to_a_linear_scan)
+{
+    auto const columns = 40;
+    auto const rows = 25;
+    auto const spacing = 120;
+
+    for (auto row = 0; row != rows; ++row)
+        for (auto column = 0; column != columns; ++column)
+            create_window({column*spacing, row*spacing});
+
+    ASSERT_THAT(windows.size(), Eq(1000u));
+
+    auto const point_for = [&](int i) { return Point{(i*37) % (columns*spacing), (i*53) % (rows*spacing)}; };
+
+    auto linear_found = 0u;
+    auto const linear_cost = benchmark::time_per_operation(100000, [&](int i)
+        {
+            auto const point = point_for(i);
+            for (auto const& window : windows)
+                if (Rectangle{window.top_left(), window.size()}.contains(point))
+                    ++linear_found;
+        });
+
+    auto indexed_found = 0u;
+    auto const indexed_cost = benchmark::time_per_operation(100000, [&](int i)
+        { indexed_found += basic_window_manager.windows_at(point_for(i)).size(); });
+
+    EXPECT_THAT(indexed_found, Eq(linear_found));
+
+    benchmark::report() << "1000 windows: "
+        << "linear scan " << linear_cost.count() << "ns, "
+        << "spatial index " << indexed_cost.count() << "ns per point query" << std::endl;
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "benchmark.h"
+#include "../test_window_manager_tools.h"
+
+using namespace miral;
+using namespace testing;
+
+namespace
+{
+struct WindowSpecificationCost : TestWindowManagerTools
+{
+    Window window;
+
+    void SetUp() override
+    {
+        basic_window_manager.add_display({{0, 0}, {640, 480}});
+        basic_window_manager.add_session(session);
+
+        EXPECT_CALL(*window_manager_policy, advise_new_window(_))
+            .WillOnce(Invoke([this](WindowInfo const& window_info){ window = window_info.window(); }));
+
+        mir::scene::SurfaceCreationParameters creation_parameters;
+        creation_parameters.size = Size{100, 100};
+        basic_window_manager.add_surface(session, creation_parameters, &create_surface);
+
+        Mock::VerifyAndClearExpectations(window_manager_policy);
+    }
+};
+}
+
+TEST_F(WindowSpecificationCost, modify_window_throughput)
+{
+    auto& info = basic_window_manager.info_for(window);
+
+    auto const copy_cost = benchmark::time_per_operation(100000, [&](int i)
+        {
+            WindowSpecification modifications;
+            modifications.top_left() = Point{i % 100, 0};
+            WindowSpecification const copy{modifications};
+            EXPECT_TRUE(copy.top_left().is_set());
+        });
+
+    auto const modify_cost = benchmark::time_per_operation(100000, [&](int i)
+        {
+            WindowSpecification modifications;
+            modifications.top_left() = Point{i % 100, 0};
+            modifications.size() = Size{100 + i % 100, 100};
+            basic_window_manager.modify_window(info, modifications);
+        });
+
+    benchmark::report() << "WindowSpecification: "
+        << "create and copy " << copy_cost.count() << "ns, "
+        << "modify_window " << modify_cost.count() << "ns per operation" << std::endl;
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "benchmark.h"
+#include "../../miral/surface_cache.h"
+#include "../window_manager_stubs.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace miral;
+using namespace testing;
+
+namespace
+{
+template<typename Read>
+auto time_reads(std::vector<Window> const& windows, Read read) -> std::chrono::nanoseconds
+{
+    auto checksum = 0;
+
+    auto const cost = benchmark::time_per_operation(1000000, [&](int i)
+        { checksum += read(windows[i % windows.size()]); });
+
+    // Keep the optimizer honest
+    EXPECT_THAT(checksum, Ne(-1));
+
+    return cost;
+}
+}
+
+TEST(WindowSurfaceCacheCost, reads_compared_to_locking_the_surface)
+{
+    auto const session = std::make_shared<StubStubSession>();
+    std::vector<std::shared_ptr<StubSurface>> surfaces;
+    std::vector<Window> uncached;
+    std::vector<Window> cached;
+
+    for (auto i = 0; i != 1000; ++i)
+    {
+        surfaces.push_back(std::make_shared<StubSurface>("", mir_window_type_normal, Point{10, 20}, Size{300, 200}));
+        uncached.emplace_back(session, surfaces.back());
+        cached.emplace_back(session, surfaces.back());
+        SurfaceCache::attach(cached.back());
+    }
+
+    auto const read = [](Window const& window)
+        { return window ? window.top_left().x.as_int() + window.size().width.as_int() : 0; };
+
+    auto const uncached_cost = time_reads(uncached, read);
+    auto const cached_cost = time_reads(cached, read);
+
+    benchmark::report() << "1000 windows: "
+        << "locking the surface " << uncached_cost.count() << "ns, "
+        << "cached " << cached_cost.count() << "ns per read" << std::endl;
+}
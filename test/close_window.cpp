@@ -0,0 +1,139 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "test_window_manager_tools.h"
+#include "../miral/close_deadlines.h"
+
+using namespace miral;
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+Rectangle const display_area{{0, 0}, {640, 480}};
+
+struct CloseWindow : TestWindowManagerTools
+{
+    std::vector<Window> windows;
+
+    void SetUp() override
+    {
+        basic_window_manager.add_display(display_area);
+        basic_window_manager.add_session(session);
+
+        ON_CALL(*window_manager_policy, advise_new_window(_))
+            .WillByDefault(Invoke([this](WindowInfo const& window_info){ windows.push_back(window_info.window()); }));
+
+        for (auto i = 0; i != 3; ++i)
+        {
+            mir::scene::SurfaceCreationParameters creation_parameters;
+            creation_parameters.size = Size{100, 100};
+            basic_window_manager.add_surface(session, creation_parameters, &create_surface);
+        }
+    }
+
+    MOCK_METHOD2(closed, void(Window const& window, bool forced));
+
+    void close(Window const& window, std::chrono::milliseconds timeout)
+    {
+        window_manager_tools.invoke_under_lock([&]
+            {
+                window_manager_tools.close_window(window, timeout,
+                    [this, window](bool forced) { closed(window, forced); });
+            });
+    }
+};
+}
+
+TEST_F(CloseWindow, a_window_the_client_closes_is_reported_closed_politely)
+{
+    auto const window = windows[0];
+    close(window, 1h);
+
+    EXPECT_CALL(*this, closed(window, false));
+
+    basic_window_manager.remove_surface(session, window);
+}
+
+TEST_F(CloseWindow, a_window_still_open_at_its_deadline_is_closed_by_force)
+{
+    auto const window = windows[0];
+    close(window, 0ms);
+
+    EXPECT_CALL(*window_manager_policy, advise_delete_window(Property(&WindowInfo::window, Eq(window))));
+    EXPECT_CALL(*this, closed(window, true));
+
+    basic_window_manager.expire_close_deadlines();
+}
+
+TEST_F(CloseWindow, a_window_before_its_deadline_is_left_alone)
+{
+    close(windows[0], 1h);
+
+    EXPECT_CALL(*window_manager_policy, advise_delete_window(_)).Times(0);
+    EXPECT_CALL(*this, closed(_, _)).Times(0);
+
+    basic_window_manager.expire_close_deadlines();
+}
+
+TEST_F(CloseWindow, only_windows_past_their_deadline_are_closed_by_force)
+{
+    close(windows[0], 0ms);
+    close(windows[1], 1h);
+    close(windows[2], 0ms);
+
+    EXPECT_CALL(*this, closed(windows[0], true));
+    EXPECT_CALL(*this, closed(windows[2], true));
+    EXPECT_CALL(*this, closed(windows[1], _)).Times(0);
+
+    basic_window_manager.expire_close_deadlines();
+}
+
+TEST_F(CloseWindow, deadlines_share_an_alarm_set_for_the_earliest)
+{
+    CloseDeadlines deadlines;
+    auto const now = CloseDeadlines::Clock::now();
+
+    deadlines.add(windows[0], now + 3s, {});
+    deadlines.add(windows[1], now + 1s, {});
+    deadlines.add(windows[2], now + 2s, {});
+
+    ASSERT_THAT(deadlines.next_deadline().is_set(), Eq(true));
+    EXPECT_THAT(deadlines.next_deadline().value(), Eq(now + 1s));
+
+    EXPECT_THAT(deadlines.expire(now + 2s), ElementsAre(windows[1], windows[2]));
+    EXPECT_THAT(deadlines.next_deadline().value(), Eq(now + 3s));
+
+    deadlines.closed(windows[0]);
+    EXPECT_THAT(deadlines.next_deadline().is_set(), Eq(false));
+}
+
+TEST_F(CloseWindow, a_second_request_keeps_the_earlier_deadline_and_both_callbacks)
+{
+    CloseDeadlines deadlines;
+    auto const now = CloseDeadlines::Clock::now();
+    auto callbacks = 0;
+
+    deadlines.add(windows[0], now + 1s, [&](bool) { ++callbacks; });
+    deadlines.add(windows[0], now + 5s, [&](bool) { ++callbacks; });
+
+    EXPECT_THAT(deadlines.next_deadline().value(), Eq(now + 1s));
+
+    deadlines.closed(windows[0]);
+    EXPECT_THAT(callbacks, Eq(2));
+}
@@ -19,6 +19,8 @@
 #include "test_window_manager_tools.h"
 #include <mir/event_printer.h>
 
+#include <map>
+
 using namespace miral;
 using namespace testing;
 namespace mt = mir::test;
@@ -67,6 +69,116 @@ struct DisplayConfiguration : TestWindowManagerTools
         Mock::VerifyAndClearExpectations(window_manager_policy);
     }
 };
+
+// A display layout that knows which output is where
+struct OutputDisplayLayout : mir::shell::DisplayLayout
+{
+    std::map<int, Rectangle> outputs;
+    int queries{0};
+
+    void clip_to_output(Rectangle& /*rect*/) override {}
+
+    void size_to_output(Rectangle& rect) override
+    {
+        ++queries;
+
+        for (auto const& output : outputs)
+        {
+            if (output.second.contains(rect.top_left))
+            {
+                rect = output.second;
+                return;
+            }
+        }
+
+        if (!outputs.empty())
+            rect = outputs.begin()->second;
+    }
+
+    bool place_in_output(mir::graphics::DisplayConfigurationOutputId id, Rectangle& rect) override
+    {
+        ++queries;
+
+        auto const output = outputs.find(id.as_value());
+
+        if (output == outputs.end())
+            return false;
+
+        rect = output->second;
+        return true;
+    }
+};
+
+Rectangle const left_output{{0, 0}, {640, 480}};
+Rectangle const right_output{{640, 0}, {640, 480}};
+
+struct OutputHotplug : TestWindowManagerTools
+{
+    OutputDisplayLayout output_layout;
+    MockWindowManagerPolicy* policy{nullptr};
+
+    BasicWindowManager window_manager{
+        &focus_controller,
+        mt::fake_shared(output_layout),
+        mt::fake_shared(persistent_surface_store),
+        [this](WindowManagerTools const& tools) -> std::unique_ptr<WindowManagementPolicy>
+            {
+                auto result = std::make_unique<NiceMock<MockWindowManagerPolicy>>(tools);
+                policy = result.get();
+                return std::move(result);
+            }
+    };
+
+    std::vector<Window> left_windows;
+    std::vector<Window> right_windows;
+
+    void SetUp() override
+    {
+        plug(1, left_output);
+        plug(2, right_output);
+        window_manager.add_session(session);
+
+        for (auto i = 0; i != 3; ++i)
+            left_windows.push_back(create_fullscreen_window_on(1));
+
+        for (auto i = 0; i != 2; ++i)
+            right_windows.push_back(create_fullscreen_window_on(2));
+
+        output_layout.queries = 0;
+    }
+
+    void plug(int id, Rectangle const& extent)
+    {
+        output_layout.outputs[id] = extent;
+        window_manager.add_display(extent);
+    }
+
+    void unplug(int id)
+    {
+        auto const extent = output_layout.outputs[id];
+        output_layout.outputs.erase(id);
+        window_manager.remove_display(extent);
+    }
+
+    auto create_fullscreen_window_on(int output_id) -> Window
+    {
+        Window result;
+
+        mir::scene::SurfaceCreationParameters creation_parameters;
+        creation_parameters.type = mir_window_type_normal;
+        creation_parameters.size = Size{600, 400};
+        creation_parameters.state = mir_window_state_fullscreen;
+        creation_parameters.output_id = mir::graphics::DisplayConfigurationOutputId{output_id};
+
+        EXPECT_CALL(*policy, advise_new_window(_))
+            .WillOnce(Invoke([&](WindowInfo const& window_info){ result = window_info.window(); }));
+
+        window_manager.add_surface(session, creation_parameters, &create_surface);
+        Mock::VerifyAndClearExpectations(policy);
+
+        return result;
+    }
+};
 }
 
 // This is the scenario behind lp:1640557
@@ -85,3 +197,36 @@ TEST_F(DisplayConfiguration, given_fullscreen_windows_reconfiguring_displays_doe
     basic_window_manager.add_display(new_display);
     basic_window_manager.remove_display(new_display);
 }
+
+TEST_F(OutputHotplug, adding_an_unrelated_output_leaves_fullscreen_windows_alone)
+{
+    EXPECT_CALL(*policy, advise_resize(_, _)).Times(0);
+    EXPECT_CALL(*policy, advise_move_to(_, _)).Times(0);
+
+    plug(3, Rectangle{{1280, 0}, {640, 480}});
+
+    EXPECT_THAT(output_layout.queries, Eq(0));
+}
+
+TEST_F(OutputHotplug, resizing_an_output_only_resizes_the_windows_on_it)
+{
+    Rectangle const bigger_right_output{{640, 0}, {1280, 1024}};
+
+    EXPECT_CALL(*policy, advise_resize(_, _)).Times(0);
+    unplug(2);
+    Mock::VerifyAndClearExpectations(policy);
+
+    for (auto const& window : right_windows)
+        EXPECT_CALL(*policy, advise_resize(Property(&WindowInfo::window, Eq(window)), bigger_right_output.size));
+
+    output_layout.queries = 0;
+    plug(2, bigger_right_output);
+
+    EXPECT_THAT(output_layout.queries, Eq(static_cast<int>(right_windows.size())));
+
+    for (auto const& window : right_windows)
+        EXPECT_THAT(window.size(), Eq(bigger_right_output.size));
+
+    for (auto const& window : left_windows)
+        EXPECT_THAT(window.size(), Eq(left_output.size));
+}
@@ -0,0 +1,262 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "test_window_manager_tools.h"
+
+#include <miral/geometry_batch_policy.h>
+
+using namespace miral;
+using namespace testing;
+
+namespace
+{
+Rectangle const display_area{{0, 0}, {640, 480}};
+
+struct BatchedGeometry : TestWindowManagerTools
+{
+    Window parent;
+    Window child;
+
+    void SetUp() override
+    {
+        basic_window_manager.add_display(display_area);
+        basic_window_manager.add_session(session);
+
+        EXPECT_CALL(*window_manager_policy, advise_new_window(_))
+            .WillOnce(Invoke([this](WindowInfo const& window_info){ parent = window_info.window(); }))
+            .WillOnce(Invoke([this](WindowInfo const& window_info){ child = window_info.window(); }));
+
+        mir::scene::SurfaceCreationParameters creation_parameters;
+        creation_parameters.size = Size{400, 300};
+        basic_window_manager.add_surface(session, creation_parameters, &create_surface);
+
+        creation_parameters.type = mir_window_type_menu;
+        creation_parameters.size = Size{100, 100};
+        creation_parameters.parent = parent;
+        basic_window_manager.add_surface(session, creation_parameters, &create_surface);
+
+        Mock::VerifyAndClearExpectations(window_manager_policy);
+    }
+
+    void move(Window const& window, Point top_left)
+    {
+        WindowSpecification modifications;
+        modifications.top_left() = top_left;
+        window_manager_tools.modify_window(window, modifications);
+    }
+
+    static auto surface_position(Window const& window) -> Point
+    {
+        return std::shared_ptr<mir::scene::Surface>(window)->top_left();
+    }
+};
+
+auto info_of(Window const& window) -> Matcher<WindowInfo const&>
+{
+    return Property(&WindowInfo::window, Eq(window));
+}
+
+struct MockBatchingPolicy : MockWindowManagerPolicy, GeometryBatchPolicy
+{
+    using MockWindowManagerPolicy::MockWindowManagerPolicy;
+
+    MOCK_METHOD1(advise_geometry_batch, void(std::vector<GeometryChange> const& changes));
+};
+
+struct BatchedGeometryAdvice : BatchedGeometry
+{
+    MockBatchingPolicy* batching_policy{nullptr};
+    WindowManagerTools batching_tools{nullptr};
+
+    BasicWindowManager batching_window_manager{
+        &focus_controller,
+        mir::test::fake_shared(display_layout),
+        mir::test::fake_shared(persistent_surface_store),
+        [this](WindowManagerTools const& tools) -> std::unique_ptr<WindowManagementPolicy>
+            {
+                auto policy = std::make_unique<NiceMock<MockBatchingPolicy>>(tools);
+                batching_policy = policy.get();
+                batching_tools = tools;
+                return std::move(policy);
+            }
+    };
+
+    void SetUp() override
+    {
+        batching_window_manager.add_display(display_area);
+        batching_window_manager.add_session(session);
+
+        EXPECT_CALL(*batching_policy, advise_new_window(_))
+            .WillOnce(Invoke([this](WindowInfo const& window_info){ parent = window_info.window(); }))
+            .WillOnce(Invoke([this](WindowInfo const& window_info){ child = window_info.window(); }));
+
+        mir::scene::SurfaceCreationParameters creation_parameters;
+        creation_parameters.size = Size{400, 300};
+        batching_window_manager.add_surface(session, creation_parameters, &create_surface);
+
+        creation_parameters.type = mir_window_type_menu;
+        creation_parameters.size = Size{100, 100};
+        creation_parameters.parent = parent;
+        batching_window_manager.add_surface(session, creation_parameters, &create_surface);
+
+        Mock::VerifyAndClearExpectations(batching_policy);
+    }
+};
+
+MATCHER_P2(MovesTo, window, top_left, "")
+{
+    return arg.window == window && arg.top_left.is_set() && arg.top_left.value() == top_left && !arg.size.is_set();
+}
+}
+
+TEST_F(BatchedGeometry, moves_under_one_lock_are_advised_once_per_window_with_the_final_position)
+{
+    auto const parent_position = parent.top_left();
+    auto const child_position = child.top_left();
+    Displacement const movement{20, 20};
+
+    EXPECT_CALL(*window_manager_policy, advise_move_to(info_of(parent), parent_position + movement)).Times(1);
+    EXPECT_CALL(*window_manager_policy, advise_move_to(info_of(child), child_position + movement)).Times(1);
+
+    window_manager_tools.invoke_under_lock([&]
+        {
+            move(parent, parent_position + Displacement{10, 10});
+            move(parent, parent_position + movement);
+        });
+}
+
+TEST_F(BatchedGeometry, windows_report_their_new_position_before_the_surfaces_are_moved)
+{
+    auto const initial_position = parent.top_left();
+    auto const new_position = initial_position + Displacement{10, 10};
+
+    window_manager_tools.invoke_under_lock([&]
+        {
+            move(parent, new_position);
+
+            EXPECT_THAT(parent.top_left(), Eq(new_position));
+            EXPECT_THAT(surface_position(parent), Eq(initial_position));
+        });
+
+    EXPECT_THAT(surface_position(parent), Eq(new_position));
+}
+
+TEST_F(BatchedGeometry, the_scene_has_the_pending_geometry_when_it_answers_window_at)
+{
+    auto const initial_position = parent.top_left();
+    auto const new_position = initial_position + Displacement{10, 10};
+
+    EXPECT_CALL(*window_manager_policy, advise_move_to(info_of(parent), new_position)).Times(1);
+
+    window_manager_tools.invoke_under_lock([&]
+        {
+            move(parent, new_position);
+            window_manager_tools.window_at(new_position);
+
+            EXPECT_THAT(surface_position(parent), Eq(new_position));
+        });
+
+    EXPECT_THAT(surface_position(parent), Eq(new_position));
+}
+
+TEST_F(BatchedGeometry, resizes_under_one_lock_are_advised_once_with_the_final_size)
+{
+    Size const final_size{200, 150};
+
+    EXPECT_CALL(*window_manager_policy, advise_resize(info_of(parent), final_size)).Times(1);
+
+    window_manager_tools.invoke_under_lock([&]
+        {
+            WindowSpecification modifications;
+            modifications.size() = Size{300, 200};
+            window_manager_tools.modify_window(parent, modifications);
+            modifications.size() = final_size;
+            window_manager_tools.modify_window(parent, modifications);
+        });
+
+    EXPECT_THAT(std::shared_ptr<mir::scene::Surface>(parent)->size(), Eq(final_size));
+}
+
+TEST_F(BatchedGeometry, the_policy_is_advised_while_the_window_has_its_old_geometry)
+{
+    auto const initial_size = parent.size();
+    Size const final_size{200, 150};
+
+    EXPECT_CALL(*window_manager_policy, advise_resize(info_of(parent), final_size))
+        .WillOnce(Invoke([&](WindowInfo const& window_info, Size const&)
+            { EXPECT_THAT(window_info.window().size(), Eq(initial_size)); }));
+
+    window_manager_tools.invoke_under_lock([&]
+        {
+            WindowSpecification modifications;
+            modifications.size() = final_size;
+            window_manager_tools.modify_window(parent, modifications);
+        });
+
+    EXPECT_THAT(parent.size(), Eq(final_size));
+}
+
+TEST_F(BatchedGeometry, moving_a_window_directly_moves_its_surface_immediately)
+{
+    auto const new_position = parent.top_left() + Displacement{10, 10};
+
+    window_manager_tools.invoke_under_lock([&]
+        {
+            parent.move_to(new_position);
+
+            EXPECT_THAT(surface_position(parent), Eq(new_position));
+            EXPECT_THAT(parent.top_left(), Eq(new_position));
+        });
+}
+
+TEST_F(BatchedGeometry, a_window_moved_directly_is_indexed_for_windows_at)
+{
+    Point const new_position{500, 400};
+
+    window_manager_tools.invoke_under_lock([&]
+        {
+            parent.move_to(new_position);
+
+            EXPECT_THAT(window_manager_tools.windows_at(new_position + Displacement{1, 1}), Contains(parent));
+        });
+}
+
+TEST_F(BatchedGeometryAdvice, changes_under_one_lock_are_advised_in_one_call)
+{
+    auto const parent_position = parent.top_left();
+    auto const child_position = child.top_left();
+    Displacement const movement{20, 20};
+
+    EXPECT_CALL(*batching_policy, advise_move_to(_, _)).Times(0);
+    EXPECT_CALL(*batching_policy, advise_geometry_batch(UnorderedElementsAre(
+        MovesTo(parent, parent_position + movement),
+        MovesTo(child, child_position + movement))))
+        .WillOnce(Invoke([&](std::vector<GeometryChange> const&)
+            { EXPECT_THAT(parent.top_left(), Eq(parent_position)); }));
+
+    batching_tools.invoke_under_lock([&]
+        {
+            WindowSpecification modifications;
+            modifications.top_left() = parent_position + Displacement{10, 10};
+            batching_tools.modify_window(parent, modifications);
+            modifications.top_left() = parent_position + movement;
+            batching_tools.modify_window(parent, modifications);
+        });
+
+    EXPECT_THAT(surface_position(child), Eq(child_position + movement));
+}
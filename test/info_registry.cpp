@@ -0,0 +1,131 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "../miral/info_registry.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <vector>
+
+using namespace testing;
+
+namespace
+{
+struct Object { int value; };
+
+struct Info
+{
+    explicit Info(int id) : id{id} {}
+    int id;
+};
+
+using Registry = miral::InfoRegistry<Object, Info>;
+
+auto make_objects(int count) -> std::vector<std::shared_ptr<Object>>
+{
+    std::vector<std::shared_ptr<Object>> result;
+
+    for (auto i = 0; i != count; ++i)
+        result.push_back(std::make_shared<Object>(Object{i}));
+
+    return result;
+}
+}
+
+TEST(InfoRegistry, emplaced_info_is_found_by_object)
+{
+    auto const objects = make_objects(3);
+    Registry registry;
+
+    for (auto const& object : objects)
+        registry.emplace(object, object->value);
+
+    for (auto const& object : objects)
+        EXPECT_THAT(registry.at(object).id, Eq(object->value));
+}
+
+TEST(InfoRegistry, references_to_info_survive_further_insertions)
+{
+    auto const objects = make_objects(1000);
+    Registry registry;
+
+    auto& first = registry.emplace(objects[0], 0);
+
+    for (auto i = 1u; i != objects.size(); ++i)
+        registry.emplace(objects[i], i);
+
+    EXPECT_THAT(&registry.at(objects[0]), Eq(&first));
+}
+
+TEST(InfoRegistry, erased_info_is_not_found)
+{
+    auto const objects = make_objects(2);
+    Registry registry;
+
+    registry.emplace(objects[0], 0);
+    registry.emplace(objects[1], 1);
+
+    registry.erase(objects[0]);
+
+    EXPECT_THAT(registry.size(), Eq(1u));
+    EXPECT_THROW(registry.at(objects[0]), std::out_of_range);
+    EXPECT_THAT(registry.at(objects[1]).id, Eq(1));
+}
+
+TEST(InfoRegistry, expired_object_is_still_found)
+{
+    Registry registry;
+    std::weak_ptr<Object> expired;
+
+    {
+        auto const object = std::make_shared<Object>(Object{0});
+        expired = object;
+        registry.emplace(object, 42);
+    }
+
+    EXPECT_THAT(registry.at(expired).id, Eq(42));
+}
+
+TEST(InfoRegistry, expired_object_can_be_erased)
+{
+    Registry registry;
+    std::weak_ptr<Object> expired;
+
+    {
+        auto const object = std::make_shared<Object>(Object{0});
+        expired = object;
+        registry.emplace(object, 0);
+    }
+
+    registry.erase(expired);
+
+    EXPECT_THAT(registry.size(), Eq(0u));
+    EXPECT_THROW(registry.at(expired), std::out_of_range);
+}
+
+TEST(InfoRegistry, object_never_registered_is_not_found)
+{
+    Registry registry;
+    auto const object = std::make_shared<Object>(Object{0});
+
+    registry.emplace(std::make_shared<Object>(Object{1}), 1);
+
+    EXPECT_THROW(registry.at(object), std::out_of_range);
+    EXPECT_THROW(registry.at(std::weak_ptr<Object>{}), std::out_of_range);
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "test_window_manager_tools.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <thread>
+
+using namespace miral;
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+struct InvokeUnderSharedLock : TestWindowManagerTools
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    int readers{0};
+    bool release_writer{false};
+
+    // Returns true if "readers" reaches expected before the timeout
+    auto wait_for_readers(int expected) -> bool
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        return cv.wait_for(lock, 5s, [&]{ return readers >= expected; });
+    }
+
+    void add_reader()
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        ++readers;
+        cv.notify_all();
+    }
+};
+}
+
+TEST_F(InvokeUnderSharedLock, callback_can_query_the_model)
+{
+    basic_window_manager.add_session(session);
+
+    unsigned int count{0};
+
+    window_manager_tools.invoke_under_shared_lock([&]{ count = window_manager_tools.count_applications(); });
+
+    EXPECT_THAT(count, Eq(1u));
+}
+
+TEST_F(InvokeUnderSharedLock, does_not_advise_policy)
+{
+    EXPECT_CALL(*window_manager_policy, advise_begin()).Times(0);
+    EXPECT_CALL(*window_manager_policy, advise_end()).Times(0);
+
+    window_manager_tools.invoke_under_shared_lock([]{});
+}
+
+TEST_F(InvokeUnderSharedLock, readers_proceed_concurrently)
+{
+    auto reader = [this]
+        {
+            bool other_reader_seen{false};
+            window_manager_tools.invoke_under_shared_lock([&]
+                {
+                    add_reader();
+                    other_reader_seen = wait_for_readers(2);
+                });
+            return other_reader_seen;
+        };
+
+    auto first = std::async(std::launch::async, reader);
+    auto second = std::async(std::launch::async, reader);
+
+    EXPECT_TRUE(first.get());
+    EXPECT_TRUE(second.get());
+}
+
+TEST_F(InvokeUnderSharedLock, readers_wait_for_writer)
+{
+    std::promise<void> writer_has_lock;
+
+    auto writer = std::async(std::launch::async, [&]
+        {
+            window_manager_tools.invoke_under_lock([&]
+                {
+                    writer_has_lock.set_value();
+                    std::unique_lock<std::mutex> lock{mutex};
+                    cv.wait_for(lock, 5s, [&]{ return release_writer; });
+                });
+        });
+
+    writer_has_lock.get_future().wait();
+
+    auto reader = std::async(std::launch::async, [&]
+        { window_manager_tools.invoke_under_shared_lock([&]{ add_reader(); }); });
+
+    EXPECT_THAT(reader.wait_for(50ms), Eq(std::future_status::timeout));
+
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        release_writer = true;
+        cv.notify_all();
+    }
+
+    EXPECT_TRUE(wait_for_readers(1));
+    writer.get();
+    reader.get();
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "../miral/latency_histogram.h"
+#include "test_window_manager_tools.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <thread>
+
+using namespace testing;
+using namespace std::chrono;
+using miral::LatencyHistogram;
+using miral::LatencyHistograms;
+
+TEST(LatencyHistogram, buckets_cover_every_value_in_order)
+{
+    for (auto bucket = 1U; bucket != LatencyHistogram::bucket_count; ++bucket)
+    {
+        auto const lower_bound = LatencyHistogram::lower_bound_of(bucket);
+
+        EXPECT_THAT(LatencyHistogram::bucket_for(lower_bound), Eq(bucket));
+        EXPECT_THAT(LatencyHistogram::bucket_for(lower_bound - 1), Eq(bucket - 1));
+    }
+}
+
+TEST(LatencyHistogram, buckets_are_within_an_eighth_of_their_values)
+{
+    for (std::uint64_t value : {9ULL, 100ULL, 1234ULL, 56789ULL, 1000000007ULL})
+    {
+        auto const lower_bound = LatencyHistogram::lower_bound_of(LatencyHistogram::bucket_for(value));
+
+        EXPECT_THAT(lower_bound, Le(value));
+        EXPECT_THAT(value - lower_bound, Le(value/8));
+    }
+}
+
+TEST(LatencyHistogram, an_empty_histogram_reports_zero)
+{
+    LatencyHistogram histogram;
+
+    EXPECT_THAT(histogram.count(), Eq(0u));
+    EXPECT_THAT(histogram.percentile(0.99), Eq(nanoseconds{0}));
+    EXPECT_THAT(histogram.max(), Eq(nanoseconds{0}));
+}
+
+TEST(LatencyHistogram, percentiles_bound_the_recorded_values)
+{
+    LatencyHistogram histogram;
+
+    for (auto i = 1; i <= 100; ++i)
+        histogram.record(microseconds{i});
+
+    EXPECT_THAT(histogram.count(), Eq(100u));
+    EXPECT_THAT(histogram.max(), Eq(microseconds{100}));
+    EXPECT_THAT(histogram.total(), Eq(microseconds{5050}));
+
+    EXPECT_THAT(histogram.percentile(0.5), AllOf(Ge(microseconds{50}), Le(microseconds{50}*9/8)));
+    EXPECT_THAT(histogram.percentile(0.9), AllOf(Ge(microseconds{90}), Le(microseconds{100})));
+    EXPECT_THAT(histogram.percentile(1.0), Eq(microseconds{100}));
+}
+
+TEST(LatencyHistogram, concurrent_records_are_all_counted)
+{
+    LatencyHistogram histogram;
+    std::vector<std::thread> threads;
+
+    for (auto t = 0; t != 4; ++t)
+        threads.emplace_back([&] { for (auto i = 0; i != 10000; ++i) histogram.record(nanoseconds{i}); });
+
+    for (auto& thread : threads)
+        thread.join();
+
+    EXPECT_THAT(histogram.count(), Eq(40000u));
+}
+
+TEST(LatencyHistograms, histograms_are_found_by_name)
+{
+    LatencyHistograms histograms;
+    char const other_copy[] = "place_new_window";
+
+    auto& histogram = histograms["place_new_window"];
+
+    EXPECT_THAT(&histograms[other_copy], Eq(&histogram));
+    EXPECT_THAT(&histograms["advise_end"], Ne(&histogram));
+}
+
+TEST(LatencyHistograms, summary_lists_the_most_costly_first)
+{
+    LatencyHistograms histograms;
+
+    histograms["cheap"].record(nanoseconds{10});
+    histograms["costly"].record(milliseconds{10});
+    histograms["unused"];
+
+    auto const summary = histograms.summary();
+
+    ASSERT_THAT(summary.size(), Eq(2u));
+    EXPECT_THAT(summary[0].name, Eq("costly"));
+    EXPECT_THAT(summary[1].name, Eq("cheap"));
+    EXPECT_THAT(summary[1].count, Eq(1u));
+}
+
+TEST(LatencyHistograms, more_names_than_capacity_are_tolerated)
+{
+    LatencyHistograms histograms;
+    std::vector<std::string> names;
+
+    for (auto i = 0U; i != LatencyHistograms::capacity + 10; ++i)
+        names.push_back("name" + std::to_string(i));
+
+    for (auto const& name : names)
+        histograms[name.c_str()].record(nanoseconds{1});
+
+    EXPECT_THAT(histograms.summary().size(), Eq(LatencyHistograms::capacity));
+}
+
+struct LockWaits : TestWindowManagerTools
+{
+    std::shared_ptr<LatencyHistograms> const histograms{std::make_shared<LatencyHistograms>()};
+};
+
+TEST_F(LockWaits, each_lock_of_the_window_manager_is_recorded)
+{
+    basic_window_manager.record_lock_waits(histograms);
+
+    basic_window_manager.add_session(session);
+    basic_window_manager.add_display(mir::geometry::Rectangle{{0, 0}, {640, 480}});
+
+    EXPECT_THAT((*histograms)["Locker"].count(), Eq(2u));
+}
+
+TEST_F(LockWaits, are_not_recorded_unless_requested)
+{
+    basic_window_manager.add_session(session);
+
+    EXPECT_THAT((*histograms)["Locker"].count(), Eq(0u));
+}
@@ -191,3 +191,33 @@ TEST_F(MRUWindowList, hiding_then_showing_windows_retains_order)
     EXPECT_THAT(as_enumerated, ElementsAre(window_c, window_b, window_a));
 }
 
+TEST_F(MRUWindowList, when_top_window_is_hidden_the_next_visible_window_is_top)
+{
+    mru_list.push(window_a);
+    mru_list.push(window_b);
+    mru_list.push(window_c);
+
+    hide_window(2);
+    EXPECT_THAT(mru_list.top(), Eq(window_b));
+
+    show_window(2);
+    EXPECT_THAT(mru_list.top(), Eq(window_c));
+}
+
+TEST_F(MRUWindowList, a_window_pushed_while_hidden_is_enumerated_in_mru_order_when_shown)
+{
+    mru_list.push(window_a);
+    mru_list.push(window_b);
+    hide_window(window_a_id);
+    mru_list.push(window_a);
+    mru_list.push(window_c);
+
+    show_window(window_a_id);
+
+    std::vector<miral::Window> as_enumerated;
+
+    mru_list.enumerate([&](miral::Window& window)
+       { as_enumerated.push_back(window); return true; });
+
+    EXPECT_THAT(as_enumerated, ElementsAre(window_c, window_a, window_b));
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_TEST_PIXEL_BUFFER_H
+#define MIRAL_TEST_PIXEL_BUFFER_H
+
+#include "../miral-shell/pixel_kernels.h"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+struct PixelBuffer
+{
+    PixelBuffer(int width, int height) :
+        width{width}, height{height}, stride{4*width + 16}, pixels(stride*height) {}
+
+    int const width;
+    int const height;
+    int const stride;
+    std::vector<char> pixels;
+
+    auto pixel(int x, int y) const -> pixel::Colour
+    {
+        pixel::Colour result;
+        memcpy(&result, pixels.data() + y*stride + 4*x, sizeof result);
+        return result;
+    }
+};
+
+inline auto random_bytes(std::size_t size) -> std::vector<unsigned char>
+{
+    std::mt19937 generator;
+    std::uniform_int_distribution<int> distribution{0, 255};
+
+    std::vector<unsigned char> result(size);
+    for (auto& byte : result)
+        byte = distribution(generator);
+    return result;
+}
+
+// The loops the titlebar painting used before the pixel kernels
+inline void memset_fill(PixelBuffer& buffer, int intensity)
+{
+    char* row = buffer.pixels.data();
+
+    for (int j = 0; j != buffer.height; ++j)
+    {
+        memset(row, intensity, 4*buffer.width);
+        row += buffer.stride;
+    }
+}
+
+inline void memset_glyph(PixelBuffer& buffer, unsigned char const* src, int intensity)
+{
+    char* dest = buffer.pixels.data();
+
+    for (auto row = 0; row != buffer.height; ++row)
+    {
+        for (auto col = 0; col != buffer.width; ++col)
+            memset(dest+ 4*col, (intensity*(0xff^src[col]))/0xff, 4);
+
+        src += buffer.width;
+        dest += buffer.stride;
+    }
+}
+
+int const titlebar_width = 641;     // Not a multiple of the vector width
+int const titlebar_height = 12;
+
+#endif //MIRAL_TEST_PIXEL_BUFFER_H
@@ -0,0 +1,86 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "pixel_buffer.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+
+TEST(PixelKernels, fill_sets_every_pixel_of_every_row)
+{
+    PixelBuffer buffer{titlebar_width, titlebar_height};
+
+    pixel::fill(buffer.pixels.data(), buffer.stride, buffer.width, buffer.height, 0x00c0ffee);
+
+    for (auto y = 0; y != buffer.height; ++y)
+        for (auto x = 0; x != buffer.width; ++x)
+            ASSERT_THAT(buffer.pixel(x, y), Eq(0x00c0ffeeu)) << "x=" << x << ", y=" << y;
+}
+
+TEST(PixelKernels, fill_leaves_padding_untouched)
+{
+    PixelBuffer buffer{titlebar_width, titlebar_height};
+
+    pixel::fill(buffer.pixels.data(), buffer.stride, buffer.width, buffer.height, 0xffffffff);
+
+    for (auto y = 0; y != buffer.height; ++y)
+        for (auto i = 4*buffer.width; i != buffer.stride; ++i)
+            ASSERT_THAT(buffer.pixels[y*buffer.stride + i], Eq(0));
+}
+
+TEST(PixelKernels, blending_black_text_matches_titlebar_loop)
+{
+    PixelBuffer expected{titlebar_width, titlebar_height};
+    PixelBuffer actual{titlebar_width, titlebar_height};
+    auto const coverage = random_bytes(titlebar_width*titlebar_height);
+
+    for (auto intensity : {0x00, 0x80, 0xcc, 0xff})
+    {
+        memset_fill(expected, intensity);
+        memset_glyph(expected, coverage.data(), intensity);
+
+        pixel::fill(actual.pixels.data(), actual.stride, actual.width, actual.height, 0x01010101u*intensity);
+        pixel::blend_coverage(
+            actual.pixels.data(), actual.stride,
+            coverage.data(), actual.width,
+            actual.width, actual.height,
+            0x00000000);
+
+        EXPECT_THAT(actual.pixels, Eq(expected.pixels)) << "intensity=" << intensity;
+    }
+}
+
+TEST(PixelKernels, vectorized_blend_matches_scalar)
+{
+    PixelBuffer expected{titlebar_width, titlebar_height};
+    PixelBuffer actual{titlebar_width, titlebar_height};
+    auto const background = random_bytes(expected.pixels.size());
+    auto const coverage = random_bytes(titlebar_width*titlebar_height);
+
+    memcpy(expected.pixels.data(), background.data(), background.size());
+    memcpy(actual.pixels.data(), background.data(), background.size());
+
+    pixel::scalar::blend_coverage(
+        expected.pixels.data(), expected.stride, coverage.data(), expected.width, expected.width, expected.height, 0x00336699);
+    pixel::blend_coverage(
+        actual.pixels.data(), actual.stride, coverage.data(), actual.width, actual.width, actual.height, 0x00336699);
+
+    EXPECT_THAT(actual.pixels, Eq(expected.pixels));
+}
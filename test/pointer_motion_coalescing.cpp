@@ -0,0 +1,257 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "test_window_manager_tools.h"
+
+#include <mir/events/event_builders.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <future>
+#include <vector>
+
+using namespace testing;
+namespace mev = mir::events;
+
+namespace
+{
+std::vector<uint8_t> const no_cookie;
+
+auto make_pointer_event(MirPointerAction action, float x, float y, float dx = 0, float dy = 0, float vscroll = 0)
+-> mir::EventUPtr
+{
+    MirPointerButtons const buttons = action == mir_pointer_action_button_down ? mir_pointer_button_primary : 0;
+
+    return mev::make_event(
+        MirInputDeviceId{0}, std::chrono::nanoseconds{1}, no_cookie, mir_input_event_modifier_none,
+        action, buttons, x, y, 0.0f, vscroll, dx, dy);
+}
+
+// Motion with the primary button held (as in a drag)
+auto make_drag_event(float x, float y) -> mir::EventUPtr
+{
+    return mev::make_event(
+        MirInputDeviceId{0}, std::chrono::nanoseconds{1}, no_cookie, mir_input_event_modifier_none,
+        mir_pointer_action_motion, mir_pointer_button_primary, x, y, 0.0f, 0.0f, 0.0f, 0.0f);
+}
+
+auto pointer_event(mir::EventUPtr const& event) -> MirPointerEvent const*
+{
+    return mir_input_event_get_pointer_event(mir_event_get_input_event(event.get()));
+}
+
+MATCHER_P3(PointerEventIs, action, x, y, "")
+{
+    return mir_pointer_event_action(arg) == action
+        && mir_pointer_event_axis_value(arg, mir_pointer_axis_x) == x
+        && mir_pointer_event_axis_value(arg, mir_pointer_axis_y) == y;
+}
+
+MATCHER_P2(RelativeMotionIs, dx, dy, "")
+{
+    return mir_pointer_event_axis_value(arg, mir_pointer_axis_relative_x) == dx
+        && mir_pointer_event_axis_value(arg, mir_pointer_axis_relative_y) == dy;
+}
+
+struct Delivered
+{
+    float x;
+    float dx;
+    float vscroll;
+};
+
+struct PointerMotionCoalescing : TestWindowManagerTools
+{
+    void SetUp() override
+    {
+        basic_window_manager.coalesce_pointer_motion(true);
+    }
+
+    // While another thread holds the lock handle_pointer_event() can't take it
+    void while_busy(std::function<void()> const& action)
+    {
+        basic_window_manager.invoke_under_shared_lock(action);
+    }
+
+    // Motion stashed while busy is delivered by another thread
+    auto signal_when_called(std::promise<void>& called) -> std::function<bool()>
+    {
+        return [&called] { called.set_value(); return false; };
+    }
+
+    // Record the motion delivered, signalling when it reaches last_x
+    auto record_motion(std::vector<Delivered>& delivered, float last_x, std::promise<void>& done)
+    -> std::function<bool(MirPointerEvent const*)>
+    {
+        return [&delivered, last_x, &done](MirPointerEvent const* event)
+            {
+                delivered.push_back(Delivered{
+                    mir_pointer_event_axis_value(event, mir_pointer_axis_x),
+                    mir_pointer_event_axis_value(event, mir_pointer_axis_relative_x),
+                    mir_pointer_event_axis_value(event, mir_pointer_axis_vscroll)});
+
+                if (delivered.back().x == last_x)
+                    done.set_value();
+
+                return false;
+            };
+    }
+};
+
+auto const delivery_timeout = std::chrono::seconds{5};
+}
+
+TEST_F(PointerMotionCoalescing, motion_reaches_the_policy_when_the_window_manager_is_idle)
+{
+    auto const motion = make_pointer_event(mir_pointer_action_motion, 10, 10);
+
+    EXPECT_CALL(*window_manager_policy, handle_pointer_event(PointerEventIs(mir_pointer_action_motion, 10, 10)));
+
+    basic_window_manager.handle_pointer_event(pointer_event(motion));
+
+    EXPECT_THAT(basic_window_manager.coalesced_pointer_motion(), Eq(0u));
+}
+
+TEST_F(PointerMotionCoalescing, motion_while_busy_is_merged_and_delivered_before_the_next_button_event)
+{
+    auto const motion1 = make_pointer_event(mir_pointer_action_motion, 10, 10, 1, 2);
+    auto const motion2 = make_pointer_event(mir_pointer_action_motion, 20, 20, 3, 4);
+    auto const motion3 = make_pointer_event(mir_pointer_action_motion, 30, 30, 5, 6);
+    auto const button = make_pointer_event(mir_pointer_action_button_down, 30, 30);
+
+    InSequence seq;
+    EXPECT_CALL(*window_manager_policy, handle_pointer_event(
+        AllOf(PointerEventIs(mir_pointer_action_motion, 30, 30), RelativeMotionIs(9, 12))));
+    EXPECT_CALL(*window_manager_policy, handle_pointer_event(PointerEventIs(mir_pointer_action_button_down, 30, 30)));
+
+    while_busy([&]
+        {
+            basic_window_manager.handle_pointer_event(pointer_event(motion1));
+            basic_window_manager.handle_pointer_event(pointer_event(motion2));
+            basic_window_manager.handle_pointer_event(pointer_event(motion3));
+        });
+
+    basic_window_manager.handle_pointer_event(pointer_event(button));
+
+    EXPECT_THAT(basic_window_manager.coalesced_pointer_motion(), Eq(2u));
+}
+
+TEST_F(PointerMotionCoalescing, motion_while_busy_is_delivered_when_the_lock_is_released)
+{
+    auto const motion = make_pointer_event(mir_pointer_action_motion, 10, 10);
+    std::promise<void> delivered;
+
+    EXPECT_CALL(*window_manager_policy, handle_pointer_event(PointerEventIs(mir_pointer_action_motion, 10, 10)))
+        .WillOnce(InvokeWithoutArgs(signal_when_called(delivered)));
+
+    basic_window_manager.invoke_under_lock([&]
+        { basic_window_manager.handle_pointer_event(pointer_event(motion)); });
+
+    EXPECT_THAT(delivered.get_future().wait_for(delivery_timeout), Eq(std::future_status::ready));
+}
+
+TEST_F(PointerMotionCoalescing, motion_while_busy_under_a_shared_lock_is_delivered_when_the_lock_is_released)
+{
+    auto const motion = make_pointer_event(mir_pointer_action_motion, 10, 10);
+    std::promise<void> delivered;
+
+    EXPECT_CALL(*window_manager_policy, handle_pointer_event(PointerEventIs(mir_pointer_action_motion, 10, 10)))
+        .WillOnce(InvokeWithoutArgs(signal_when_called(delivered)));
+
+    while_busy([&] { basic_window_manager.handle_pointer_event(pointer_event(motion)); });
+
+    EXPECT_THAT(delivered.get_future().wait_for(delivery_timeout), Eq(std::future_status::ready));
+}
+
+TEST_F(PointerMotionCoalescing, motion_while_busy_loses_no_relative_motion_or_scroll_to_later_motion)
+{
+    auto const motion1 = make_pointer_event(mir_pointer_action_motion, 10, 10, 1, 0, 1);
+    auto const motion2 = make_pointer_event(mir_pointer_action_motion, 20, 20, 2, 0, 2);
+    std::vector<Delivered> delivered;
+    std::promise<void> done;
+
+    EXPECT_CALL(*window_manager_policy, handle_pointer_event(_))
+        .WillRepeatedly(Invoke(record_motion(delivered, 20, done)));
+
+    while_busy([&] { basic_window_manager.handle_pointer_event(pointer_event(motion1)); });
+
+    // Whether motion1 is delivered first or merged into motion2, nothing is lost
+    basic_window_manager.handle_pointer_event(pointer_event(motion2));
+
+    ASSERT_THAT(done.get_future().wait_for(delivery_timeout), Eq(std::future_status::ready));
+
+    auto total_dx = 0.0f;
+    auto total_vscroll = 0.0f;
+
+    for (auto const& motion : delivered)
+    {
+        total_dx += motion.dx;
+        total_vscroll += motion.vscroll;
+    }
+
+    EXPECT_THAT(delivered.back().x, Eq(20));
+    EXPECT_THAT(total_dx, Eq(3));
+    EXPECT_THAT(total_vscroll, Eq(3));
+}
+
+TEST_F(PointerMotionCoalescing, motion_while_busy_is_not_reported_as_consumed)
+{
+    auto const motion = make_pointer_event(mir_pointer_action_motion, 10, 10);
+
+    EXPECT_CALL(*window_manager_policy, handle_pointer_event(_)).WillRepeatedly(Return(true));
+
+    // The policy hasn't seen the motion yet
+    while_busy([&]
+        { EXPECT_FALSE(basic_window_manager.handle_pointer_event(pointer_event(motion))); });
+}
+
+TEST_F(PointerMotionCoalescing, drag_motion_while_busy_waits_for_the_policy_to_decide)
+{
+    auto const drag = make_drag_event(10, 10);
+    std::future<bool> consumed;
+
+    EXPECT_CALL(*window_manager_policy, handle_pointer_event(PointerEventIs(mir_pointer_action_motion, 10, 10)))
+        .WillOnce(Return(true));
+
+    while_busy([&]
+        {
+            consumed = std::async(std::launch::async,
+                [&] { return basic_window_manager.handle_pointer_event(pointer_event(drag)); });
+
+            // Not stashed and reported unconsumed: the client mustn't get a drag the policy takes
+            EXPECT_THAT(consumed.wait_for(std::chrono::milliseconds{100}), Eq(std::future_status::timeout));
+        });
+
+    EXPECT_TRUE(consumed.get());
+    EXPECT_THAT(basic_window_manager.coalesced_pointer_motion(), Eq(0u));
+}
+
+TEST_F(PointerMotionCoalescing, button_events_are_never_merged)
+{
+    auto const down = make_pointer_event(mir_pointer_action_button_down, 10, 10);
+    auto const up = make_pointer_event(mir_pointer_action_button_up, 10, 10);
+
+    EXPECT_CALL(*window_manager_policy, handle_pointer_event(PointerEventIs(mir_pointer_action_button_down, 10, 10)));
+    EXPECT_CALL(*window_manager_policy, handle_pointer_event(PointerEventIs(mir_pointer_action_button_up, 10, 10)));
+
+    basic_window_manager.handle_pointer_event(pointer_event(down));
+    basic_window_manager.handle_pointer_event(pointer_event(up));
+
+    EXPECT_THAT(basic_window_manager.coalesced_pointer_motion(), Eq(0u));
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "../miral-shell/printer.h"
+#include "../miral-shell/titlebar_config.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace testing;
+
+namespace
+{
+// The shell's default font isn't always installed, so fall back to a common one
+auto available_font() -> std::string
+{
+    for (auto const& font : {titlebar::font_file(), std::string{"/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf"}})
+    {
+        if (std::ifstream{font})
+            return font;
+    }
+
+    return titlebar::font_file();
+}
+
+struct Titlebar
+{
+    static int const width = 200;
+    static int const height = 12;
+
+    // Titles are printed in black, so start with white
+    std::vector<char> pixels = std::vector<char>(4*width*height, char(0xff));
+
+    auto region() -> MirGraphicsRegion
+    {
+        return MirGraphicsRegion{width, height, 4*width, mir_pixel_format_argb_8888, pixels.data()};
+    }
+};
+
+struct PrinterTest : Test
+{
+    PrinterTest() { titlebar::font_file(available_font()); }
+    ~PrinterTest() { titlebar::font_file(default_font); }
+
+    std::string const default_font{titlebar::font_file()};
+    Titlebar titlebar;
+};
+}
+
+TEST_F(PrinterTest, a_repeated_title_is_printed_from_the_caches)
+{
+    Printer printer;
+    if (!printer.has_font()) return;    // Without a font nothing is rendered (or cached)
+
+    printer.print(titlebar.region(), "Terminal");
+
+    EXPECT_THAT(printer.cached_titles(), Eq(1u));
+    EXPECT_THAT(printer.cached_glyphs(), Eq(8u));
+
+    auto const atlas_bytes = printer.atlas_bytes();
+
+    printer.print(titlebar.region(), "Terminal");
+
+    EXPECT_THAT(printer.cached_titles(), Eq(1u));
+    EXPECT_THAT(printer.cached_glyphs(), Eq(8u));
+    EXPECT_THAT(printer.atlas_bytes(), Eq(atlas_bytes));
+}
+
+TEST_F(PrinterTest, titles_share_cached_glyphs)
+{
+    Printer printer;
+    if (!printer.has_font()) return;
+
+    printer.print(titlebar.region(), "aaa");
+    printer.print(titlebar.region(), "ab");
+
+    EXPECT_THAT(printer.cached_titles(), Eq(2u));
+    EXPECT_THAT(printer.cached_glyphs(), Eq(2u));
+}
+
+TEST_F(PrinterTest, a_title_printed_from_the_caches_looks_the_same)
+{
+    Printer printer;
+    if (!printer.has_font()) return;
+
+    Titlebar first;
+    Titlebar second;
+
+    printer.print(first.region(), "Terminal");
+    printer.print(second.region(), "Terminal");
+
+    EXPECT_THAT(second.pixels, ContainerEq(first.pixels));
+    EXPECT_THAT(first.pixels, Contains(Ne(char(0xff))));
+}
+
+TEST_F(PrinterTest, shaped_titles_are_dropped_when_there_are_too_many)
+{
+    std::size_t const max_titles = 4;
+    Printer printer{1024*1024, max_titles};
+    if (!printer.has_font()) return;
+
+    for (auto i = 0u; i != max_titles + 1; ++i)
+        printer.print(titlebar.region(), "Title " + std::to_string(i));
+
+    EXPECT_THAT(printer.cached_titles(), Eq(max_titles + 1));
+    auto const glyphs = printer.cached_glyphs();
+
+    printer.print(titlebar.region(), "Title 0");
+
+    EXPECT_THAT(printer.cached_titles(), Eq(1u));
+    EXPECT_THAT(printer.cached_glyphs(), Eq(glyphs));
+}
+
+TEST_F(PrinterTest, all_caches_are_dropped_when_the_glyphs_fill_the_atlas)
+{
+    std::size_t const max_atlas_bytes = 100;
+    Printer printer{max_atlas_bytes, 256};
+    if (!printer.has_font()) return;
+
+    printer.print(titlebar.region(), "abcdefghijklmnop");
+    ASSERT_THAT(printer.atlas_bytes(), Gt(max_atlas_bytes));
+
+    printer.print(titlebar.region(), "x");
+
+    EXPECT_THAT(printer.cached_titles(), Eq(1u));
+    EXPECT_THAT(printer.cached_glyphs(), Eq(1u));
+    EXPECT_THAT(printer.atlas_bytes(), Le(max_atlas_bytes));
+}
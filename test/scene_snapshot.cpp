@@ -0,0 +1,177 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "test_window_manager_tools.h"
+
+#include <miral/scene_snapshot.h>
+
+using namespace miral;
+using namespace testing;
+
+namespace
+{
+X const display_left{0};
+Y const display_top{0};
+Width  const display_width{640};
+Height const display_height{480};
+
+Rectangle const display_area{{display_left, display_top}, {display_width, display_height}};
+
+struct SceneSnapshot : TestWindowManagerTools
+{
+    Window first;
+    Window second;
+
+    void SetUp() override
+    {
+        basic_window_manager.add_display(display_area);
+        basic_window_manager.add_session(session);
+
+        EXPECT_CALL(*window_manager_policy, advise_new_window(_))
+            .WillOnce(Invoke([this](WindowInfo const& window_info){ first = window_info.window(); }))
+            .WillOnce(Invoke([this](WindowInfo const& window_info){ second = window_info.window(); }));
+
+        mir::scene::SurfaceCreationParameters creation_parameters;
+        creation_parameters.size = Size{100, 100};
+        basic_window_manager.add_surface(session, creation_parameters, &create_surface);
+        basic_window_manager.add_surface(session, creation_parameters, &create_surface);
+
+        Mock::VerifyAndClearExpectations(window_manager_policy);
+    }
+
+    auto record_for(std::shared_ptr<miral::SceneSnapshot const> const& snapshot, Window const& window)
+    -> std::shared_ptr<WindowSnapshot const>
+    {
+        for (auto const& record : snapshot->windows)
+            if (record->window == window)
+                return record;
+
+        return {};
+    }
+
+    void move(Window const& window, Point top_left)
+    {
+        window_manager_tools.invoke_under_lock([&]
+            {
+                WindowSpecification modifications;
+                modifications.top_left() = top_left;
+                window_manager_tools.modify_window(window, modifications);
+            });
+    }
+};
+}
+
+TEST_F(SceneSnapshot, contains_windows_and_applications)
+{
+    auto const snapshot = window_manager_tools.scene_snapshot();
+
+    EXPECT_THAT(snapshot->windows.size(), Eq(2u));
+    EXPECT_THAT(record_for(snapshot, first), NotNull());
+    EXPECT_THAT(record_for(snapshot, second), NotNull());
+    ASSERT_THAT(snapshot->applications->size(), Eq(1u));
+    EXPECT_THAT(snapshot->applications->front().application.lock(), Eq(session));
+}
+
+TEST_F(SceneSnapshot, reflects_window_geometry)
+{
+    Point const new_top_left{42, 24};
+
+    move(first, new_top_left);
+
+    auto const record = record_for(window_manager_tools.scene_snapshot(), first);
+
+    ASSERT_THAT(record, NotNull());
+    EXPECT_THAT(record->top_left, Eq(new_top_left));
+    EXPECT_THAT(record->size, Eq(Size{100, 100}));
+}
+
+TEST_F(SceneSnapshot, held_snapshot_is_not_changed_by_updates)
+{
+    auto const before = window_manager_tools.scene_snapshot();
+    auto const top_left_before = record_for(before, first)->top_left;
+
+    move(first, top_left_before + Displacement{10, 10});
+
+    EXPECT_THAT(record_for(before, first)->top_left, Eq(top_left_before));
+    EXPECT_THAT(window_manager_tools.scene_snapshot()->version, Gt(before->version));
+}
+
+TEST_F(SceneSnapshot, records_of_unchanged_windows_are_shared)
+{
+    auto const before = window_manager_tools.scene_snapshot();
+
+    move(first, record_for(before, first)->top_left + Displacement{10, 10});
+
+    auto const after = window_manager_tools.scene_snapshot();
+
+    EXPECT_THAT(record_for(after, first), Ne(record_for(before, first)));
+    EXPECT_THAT(record_for(after, second), Eq(record_for(before, second)));
+    EXPECT_THAT(after->applications, Eq(before->applications));
+}
+
+TEST_F(SceneSnapshot, transaction_without_changes_does_not_publish)
+{
+    auto const before = window_manager_tools.scene_snapshot();
+
+    window_manager_tools.invoke_under_lock([]{});
+
+    EXPECT_THAT(window_manager_tools.scene_snapshot(), Eq(before));
+}
+
+TEST_F(SceneSnapshot, removed_window_is_not_in_snapshot)
+{
+    basic_window_manager.remove_surface(session, first);
+
+    auto const snapshot = window_manager_tools.scene_snapshot();
+
+    EXPECT_THAT(snapshot->windows.size(), Eq(1u));
+    EXPECT_THAT(record_for(snapshot, first), IsNull());
+    EXPECT_THAT(record_for(snapshot, second), NotNull());
+}
+
+TEST_F(SceneSnapshot, removing_a_window_from_a_large_scene_keeps_the_others)
+{
+    std::vector<Window> windows{first, second};
+
+    EXPECT_CALL(*window_manager_policy, advise_new_window(_))
+        .WillRepeatedly(Invoke([&](WindowInfo const& window_info){ windows.push_back(window_info.window()); }));
+
+    mir::scene::SurfaceCreationParameters creation_parameters;
+    creation_parameters.size = Size{100, 100};
+
+    for (auto i = 0; i != 200; ++i)
+        basic_window_manager.add_surface(session, creation_parameters, &create_surface);
+
+    auto const before = window_manager_tools.scene_snapshot();
+
+    basic_window_manager.remove_surface(session, first);
+
+    auto const after = window_manager_tools.scene_snapshot();
+
+    EXPECT_THAT(before->windows.size(), Eq(windows.size()));
+    EXPECT_THAT(after->windows.size(), Eq(windows.size() - 1));
+    EXPECT_THAT(record_for(after, first), IsNull());
+
+    for (auto const& window : windows)
+    {
+        EXPECT_THAT(record_for(before, window), NotNull());
+
+        if (window != first)
+            EXPECT_THAT(record_for(after, window), Eq(record_for(before, window)));
+    }
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "../miral-shell/titlebar_repaints.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+
+namespace
+{
+struct TitlebarRepaintsTest : Test
+{
+    TitlebarRepaints repaints;
+
+    // As DecorationProvider starts a titlebar
+    TitlebarAppearance painted{{}, -1, 0, 0};
+    TitlebarAppearance const shown{"Terminal", 0xff, 200, 12};
+
+    auto request(TitlebarAppearance const& wanted) -> bool
+    {
+        repaints.requested();
+        return repaints.needed(painted, wanted);
+    }
+};
+}
+
+TEST_F(TitlebarRepaintsTest, a_new_titlebar_is_painted)
+{
+    EXPECT_TRUE(request(shown));
+    EXPECT_THAT(painted, Eq(shown));
+}
+
+TEST_F(TitlebarRepaintsTest, a_repaint_that_changes_nothing_is_skipped)
+{
+    request(shown);
+
+    EXPECT_FALSE(request(shown));
+    EXPECT_FALSE(request(shown));
+
+    EXPECT_THAT(repaints.requested_count(), Eq(3u));
+    EXPECT_THAT(repaints.performed_count(), Eq(1u));
+}
+
+TEST_F(TitlebarRepaintsTest, a_change_of_title_intensity_or_size_is_repainted)
+{
+    request(shown);
+
+    auto retitled = shown;
+    retitled.title = "Editor";
+    EXPECT_TRUE(request(retitled));
+
+    auto dimmed = retitled;
+    dimmed.intensity = 0x3f;
+    EXPECT_TRUE(request(dimmed));
+
+    auto wider = dimmed;
+    wider.width = 300;
+    EXPECT_TRUE(request(wider));
+
+    auto taller = wider;
+    taller.height = 20;
+    EXPECT_TRUE(request(taller));
+
+    EXPECT_THAT(painted, Eq(taller));
+    EXPECT_THAT(repaints.requested_count(), Eq(5u));
+    EXPECT_THAT(repaints.performed_count(), Eq(5u));
+}
+
+TEST_F(TitlebarRepaintsTest, returning_to_the_painted_appearance_is_skipped)
+{
+    request(shown);
+
+    // A request to dim the titlebar is superseded before it is painted
+    repaints.requested();
+
+    EXPECT_FALSE(request(shown));
+    EXPECT_THAT(repaints.requested_count(), Eq(3u));
+    EXPECT_THAT(repaints.performed_count(), Eq(1u));
+}
@@ -0,0 +1,210 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "../miral/trace_ring_buffer.h"
+
+#include <miral/window_specification.h>
+
+#include <mir/event_printer.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <thread>
+
+#include <unistd.h>
+
+using namespace testing;
+using namespace mir::geometry;
+using mir::operator<<;
+using miral::TraceRingBuffer;
+namespace trace = miral::trace;
+
+namespace
+{
+struct TraceRingBufferTest : Test
+{
+    std::string const path{temporary_path()};
+
+    ~TraceRingBufferTest()
+    {
+        std::remove(path.c_str());
+    }
+
+    static auto temporary_path() -> std::string
+    {
+        char name[] = "/tmp/miral-trace-XXXXXX";
+        close(mkstemp(name));
+        return name;
+    }
+
+    auto decoded() const -> std::vector<std::string>
+    {
+        std::vector<std::string> result;
+
+        for (auto const& entry : trace::read_entries(path))
+            result.push_back(trace::format(entry));
+
+        return result;
+    }
+};
+}
+
+TEST_F(TraceRingBufferTest, an_empty_trace_decodes_to_nothing)
+{
+    TraceRingBuffer buffer{path, 8};
+
+    EXPECT_THAT(decoded(), IsEmpty());
+}
+
+TEST_F(TraceRingBufferTest, records_decode_in_the_layout_of_the_text_trace)
+{
+    TraceRingBuffer buffer{path, 8};
+    std::string const foo{"foo"};
+    std::string const bar{"bar"};
+
+    buffer.record("focus_next_application", {});
+    buffer.record("select_active_window", {{"hint", foo}, {"->", bar}});
+    buffer.record("advise_move_to", {{"window_info", foo}, {"top_left", Point{3, 4}}});
+    buffer.record("count_applications", {{"->", 42u}});
+    buffer.record("====", {});
+
+    EXPECT_THAT(decoded(), ElementsAre(
+        "focus_next_application",
+        "select_active_window hint=foo -> bar",
+        "advise_move_to window_info=foo, top_left=(3, 4)",
+        "count_applications -> 42",
+        "===="));
+}
+
+TEST_F(TraceRingBufferTest, records_are_readable_before_the_buffer_is_destroyed)
+{
+    TraceRingBuffer buffer{path, 8};
+
+    buffer.record("advise_resize", {{"new_size", Size{640, 480}}});
+
+    EXPECT_THAT(decoded(), ElementsAre("advise_resize new_size=(640, 480)"));
+}
+
+TEST_F(TraceRingBufferTest, long_text_is_kept_whole)
+{
+    TraceRingBuffer buffer{path, 8};
+    std::string const name(1000, 'x');
+
+    buffer.record("active_window", {{"->", name}});
+
+    EXPECT_THAT(decoded(), ElementsAre("active_window -> " + name));
+}
+
+TEST_F(TraceRingBufferTest, enums_decode_as_the_text_trace_prints_them)
+{
+    TraceRingBuffer buffer{path, 8};
+
+    buffer.record("advise_state_change", {{"state", mir_window_state_maximized}});
+
+    std::ostringstream expected;
+    expected << "advise_state_change state=" << mir_window_state_maximized;
+
+    EXPECT_THAT(decoded(), ElementsAre(expected.str()));
+}
+
+TEST_F(TraceRingBufferTest, specifications_decode_in_full)
+{
+    TraceRingBuffer buffer{path, 8};
+    std::string const name(100, 'n');
+
+    miral::WindowSpecification specification;
+    specification.name() = name;
+    specification.type() = mir_window_type_dialog;
+    specification.size() = Size{640, 480};
+
+    buffer.record("place_new_window", {{"->", specification}});
+
+    std::ostringstream expected;
+    expected << "place_new_window -> {name=" << name << ", type=" << mir_window_type_dialog << ", size=(640, 480)}";
+
+    EXPECT_THAT(decoded(), ElementsAre(expected.str()));
+}
+
+TEST_F(TraceRingBufferTest, when_the_ring_wraps_the_latest_records_are_kept_in_order)
+{
+    TraceRingBuffer buffer{path, 4};
+
+    for (auto i = 0u; i != 10; ++i)
+        buffer.record("count_applications", {{"->", i}});
+
+    EXPECT_THAT(decoded(), ElementsAre(
+        "count_applications -> 6",
+        "count_applications -> 7",
+        "count_applications -> 8",
+        "count_applications -> 9"));
+}
+
+TEST_F(TraceRingBufferTest, an_entry_that_has_been_partly_overwritten_is_skipped)
+{
+    TraceRingBuffer buffer{path, 4};
+    std::string const name(2*trace::record_payload, 'x');
+
+    buffer.record("active_window", {{"->", name}});
+    buffer.record("count_applications", {{"->", 1u}});
+    buffer.record("count_applications", {{"->", 2u}});
+
+    EXPECT_THAT(decoded(), ElementsAre(
+        "count_applications -> 1",
+        "count_applications -> 2"));
+}
+
+TEST_F(TraceRingBufferTest, an_entry_larger_than_the_ring_is_dropped)
+{
+    TraceRingBuffer buffer{path, 2};
+    std::string const name(4*trace::record_payload, 'x');
+
+    buffer.record("active_window", {{"->", name}});
+
+    EXPECT_THAT(decoded(), IsEmpty());
+}
+
+TEST_F(TraceRingBufferTest, concurrent_writers_lose_no_records)
+{
+    auto const threads = 4;
+    auto const records_per_thread = 1000;
+
+    TraceRingBuffer buffer{path, threads*records_per_thread};
+
+    std::vector<std::thread> writers;
+
+    for (auto t = 0; t != threads; ++t)
+        writers.emplace_back([&]
+            {
+                for (auto i = 0; i != records_per_thread; ++i)
+                    buffer.record("focus_next_application", {});
+            });
+
+    for (auto& writer : writers)
+        writer.join();
+
+    EXPECT_THAT(trace::read_entries(path).size(), Eq(threads*records_per_thread));
+}
+
+TEST_F(TraceRingBufferTest, a_file_that_is_not_a_trace_is_rejected)
+{
+    EXPECT_THROW(trace::read_entries(path), std::runtime_error);
+}
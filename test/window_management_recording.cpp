@@ -0,0 +1,232 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "test_window_manager_tools.h"
+#include "window_management_replay.h"
+
+#include "../miral/window_management_recorder.h"
+
+#include <mir/events/event_builders.h>
+#include <mir/shell/surface_specification.h>
+
+#include <chrono>
+#include <sstream>
+#include <thread>
+#include <tuple>
+
+using namespace miral;
+using namespace testing;
+namespace mt = mir::test;
+namespace mev = mir::events;
+
+namespace
+{
+Rectangle const display_area{{0, 0}, {640, 480}};
+
+using Layout = std::vector<std::tuple<std::string, MirWindowType, MirWindowState, Point, Size>>;
+
+auto layout_of(WindowManagerTools& tools) -> Layout
+{
+    Layout result;
+
+    tools.for_each_application([&](ApplicationInfo& info)
+        {
+            for (auto const& window : info.windows())
+            {
+                auto const& window_info = tools.info_for(window);
+                result.emplace_back(
+                    window_info.name(), window_info.type(), window_info.state(), window.top_left(), window.size());
+            }
+        });
+
+    return result;
+}
+
+auto calls_in(std::string const& recording) -> std::vector<std::string>
+{
+    std::vector<std::string> result;
+    std::istringstream in{recording};
+
+    for (std::string line; std::getline(in, line);)
+    {
+        std::istringstream fields{line};
+        long long timestamp;
+        std::string call;
+        fields >> timestamp >> call;
+        result.push_back(call);
+    }
+
+    return result;
+}
+
+struct WindowManagementRecording : TestWindowManagerTools
+{
+    std::shared_ptr<std::stringstream> const recording{std::make_shared<std::stringstream>()};
+    RecordingWindowManager recorder{mt::fake_shared(basic_window_manager), recording};
+
+    WindowManagerTools replay_tools{nullptr};
+
+    WindowManagementReplay replayer{
+        [this](WindowManagerTools const& tools) -> std::unique_ptr<WindowManagementPolicy>
+            {
+                replay_tools = tools;
+                return std::make_unique<NiceMock<MockWindowManagerPolicy>>(tools);
+            }
+    };
+
+    void record_a_session()
+    {
+        recorder.add_display(display_area);
+        recorder.add_session(session);
+
+        mir::scene::SurfaceCreationParameters params;
+        params.name = "parent window";
+        params.size = Size{600, 400};
+        auto const parent = session->surface(recorder.add_surface(session, params, &create_surface));
+
+        params.name = "child";
+        params.type = mir_window_type_menu;
+        params.parent = parent;
+        params.size = Size{200, 100};
+        params.aux_rect = Rectangle{{10, 10}, {20, 20}};
+        recorder.add_surface(session, params, &create_surface);
+
+        auto const event = mev::make_event(
+            MirInputDeviceId{0}, std::chrono::nanoseconds{0}, std::vector<uint8_t>{}, mir_input_event_modifier_none,
+            mir_pointer_action_motion, MirPointerButtons{}, 25.5f, 33.25f, 0.0f, 0.0f, 1.5f, -2.0f);
+        recorder.handle_pointer_event(mir_input_event_get_pointer_event(mir_event_get_input_event(event.get())));
+
+        mir::shell::SurfaceSpecification modifications;
+        modifications.width = Width{300};
+        modifications.height = Height{200};
+        recorder.modify_surface(session, parent, modifications);
+        recorder.flush();
+    }
+};
+}
+
+TEST_F(WindowManagementRecording, records_each_call_in_order)
+{
+    record_a_session();
+
+    EXPECT_THAT(calls_in(recording->str()), ElementsAre(
+        "add_display", "add_session", "add_surface", "add_surface", "handle_pointer_event", "modify_surface"));
+}
+
+TEST_F(WindowManagementRecording, calls_from_several_threads_are_all_recorded)
+{
+    auto const threads = 4;
+    auto const calls_per_thread = 1000;
+
+    auto const event = mev::make_event(
+        MirInputDeviceId{0}, std::chrono::nanoseconds{0}, std::vector<uint8_t>{}, mir_input_event_modifier_none,
+        mir_pointer_action_motion, MirPointerButtons{}, 25.5f, 33.25f, 0.0f, 0.0f, 1.5f, -2.0f);
+    auto const pointer_event = mir_input_event_get_pointer_event(mir_event_get_input_event(event.get()));
+
+    recorder.add_display(display_area);
+
+    std::vector<std::thread> workers;
+    for (auto i = 0; i != threads; ++i)
+        workers.emplace_back([&]{ for (auto j = 0; j != calls_per_thread; ++j) recorder.handle_pointer_event(pointer_event); });
+
+    for (auto& worker : workers)
+        worker.join();
+
+    recorder.flush();
+
+    auto const calls = calls_in(recording->str());
+    EXPECT_THAT(calls.size(), Eq(1u + threads*calls_per_thread));
+    EXPECT_THAT(calls.front(), Eq("add_display"));
+}
+
+TEST_F(WindowManagementRecording, recorders_alternating_on_a_thread_each_record_their_calls)
+{
+    auto const other_recording = std::make_shared<std::stringstream>();
+    RecordingWindowManager other_recorder{mt::fake_shared(basic_window_manager), other_recording};
+    auto const calls = 100;
+
+    auto const event = mev::make_event(
+        MirInputDeviceId{0}, std::chrono::nanoseconds{0}, std::vector<uint8_t>{}, mir_input_event_modifier_none,
+        mir_pointer_action_motion, MirPointerButtons{}, 25.5f, 33.25f, 0.0f, 0.0f, 1.5f, -2.0f);
+    auto const pointer_event = mir_input_event_get_pointer_event(mir_event_get_input_event(event.get()));
+
+    for (auto i = 0; i != calls; ++i)
+    {
+        recorder.handle_pointer_event(pointer_event);
+        other_recorder.handle_pointer_event(pointer_event);
+    }
+
+    recorder.flush();
+    other_recorder.flush();
+
+    EXPECT_THAT(calls_in(recording->str()).size(), Eq(std::size_t(calls)));
+    EXPECT_THAT(calls_in(other_recording->str()).size(), Eq(std::size_t(calls)));
+}
+
+TEST_F(WindowManagementRecording, replaying_a_recording_reproduces_the_layout)
+{
+    record_a_session();
+
+    auto const calls = replayer.replay(*recording);
+
+    EXPECT_THAT(calls, Eq(6u));
+    EXPECT_THAT(layout_of(replay_tools), Eq(layout_of(window_manager_tools)));
+}
+
+TEST_F(WindowManagementRecording, removed_windows_are_removed_on_replay)
+{
+    record_a_session();
+
+    auto const& windows = window_manager_tools.info_for(session).windows();
+    recorder.remove_surface(session, std::shared_ptr<mir::scene::Surface>(windows.back()));
+    recorder.flush();
+
+    replayer.replay(*recording);
+
+    EXPECT_THAT(layout_of(replay_tools), Eq(layout_of(window_manager_tools)));
+    EXPECT_THAT(layout_of(replay_tools).size(), Eq(1u));
+}
+
+TEST_F(WindowManagementRecording, specification_survives_a_round_trip)
+{
+    WindowSpecification specification;
+    specification.name() = "a \"quoted\" name";
+    specification.type() = mir_window_type_dialog;
+    specification.top_left() = Point{13, 17};
+    specification.size() = Size{640, 480};
+    specification.aux_rect() = Rectangle{{1, 2}, {3, 4}};
+    specification.aux_rect_placement_offset() = Displacement{-5, 6};
+    specification.min_width() = Width{42};
+    specification.max_aspect() = WindowSpecification::AspectRatio{16, 9};
+
+    std::stringstream buffer;
+    recording::write(buffer, specification, [](std::shared_ptr<mir::scene::Surface> const&) { return 0; });
+    auto const result = recording::read_specification(buffer, [](int) { return nullptr; });
+
+    EXPECT_THAT(result.name().value(), Eq(specification.name().value()));
+    EXPECT_THAT(result.type().value(), Eq(specification.type().value()));
+    EXPECT_THAT(result.top_left().value(), Eq(specification.top_left().value()));
+    EXPECT_THAT(result.size().value(), Eq(specification.size().value()));
+    EXPECT_THAT(result.aux_rect().value(), Eq(specification.aux_rect().value()));
+    EXPECT_THAT(result.aux_rect_placement_offset().value(), Eq(specification.aux_rect_placement_offset().value()));
+    EXPECT_THAT(result.min_width().value(), Eq(specification.min_width().value()));
+    EXPECT_THAT(result.max_aspect().value().width, Eq(16u));
+    EXPECT_THAT(result.max_aspect().value().height, Eq(9u));
+    EXPECT_FALSE(result.state().is_set());
+    EXPECT_FALSE(result.parent().is_set());
+}
@@ -0,0 +1,311 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "window_management_replay.h"
+
+#include "../miral/window_management_recorder.h"
+
+#include <mir/events/event_builders.h>
+#include <mir/shell/surface_specification.h>
+#include <mir/client/detail/mir_forward_compatibility.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace mev = mir::events;
+
+namespace
+{
+template<typename Dest, typename Source>
+void copy_if_set(mir::optional_value<Dest>& dest, mir::optional_value<Source> const& source)
+{
+    if (source.is_set()) dest = source.value();
+}
+
+auto shell_specification(miral::WindowSpecification const& spec) -> mir::shell::SurfaceSpecification
+{
+    mir::shell::SurfaceSpecification result;
+
+    if (spec.size().is_set())
+    {
+        result.width = spec.size().value().width;
+        result.height = spec.size().value().height;
+    }
+
+    if (spec.output_id().is_set())
+        result.output_id = mir::graphics::DisplayConfigurationOutputId{spec.output_id().value()};
+
+    if (spec.min_aspect().is_set())
+        result.min_aspect = mir::shell::SurfaceAspectRatio{spec.min_aspect().value().width, spec.min_aspect().value().height};
+
+    if (spec.max_aspect().is_set())
+        result.max_aspect = mir::shell::SurfaceAspectRatio{spec.max_aspect().value().width, spec.max_aspect().value().height};
+
+    copy_if_set(result.name, spec.name());
+    copy_if_set(result.type, spec.type());
+    copy_if_set(result.state, spec.state());
+    copy_if_set(result.preferred_orientation, spec.preferred_orientation());
+    copy_if_set(result.aux_rect, spec.aux_rect());
+    copy_if_set(result.min_width, spec.min_width());
+    copy_if_set(result.min_height, spec.min_height());
+    copy_if_set(result.max_width, spec.max_width());
+    copy_if_set(result.max_height, spec.max_height());
+    copy_if_set(result.width_inc, spec.width_inc());
+    copy_if_set(result.height_inc, spec.height_inc());
+    copy_if_set(result.parent, spec.parent());
+    copy_if_set(result.shell_chrome, spec.shell_chrome());
+#if MIRAL_MIR_DEFINES_POINTER_CONFINEMENT
+    copy_if_set(result.confine_pointer, spec.confine_pointer());
+#endif
+
+#if MIR_SERVER_VERSION >= MIR_VERSION_NUMBER(0, 25, 0)
+    copy_if_set(result.placement_hints, spec.placement_hints());
+    copy_if_set(result.surface_placement_gravity, spec.window_placement_gravity());
+    copy_if_set(result.aux_rect_placement_gravity, spec.aux_rect_placement_gravity());
+
+    if (spec.aux_rect_placement_offset().is_set())
+    {
+        result.aux_rect_placement_offset_x = spec.aux_rect_placement_offset().value().dx.as_int();
+        result.aux_rect_placement_offset_y = spec.aux_rect_placement_offset().value().dy.as_int();
+    }
+#endif
+
+    return result;
+}
+
+auto read_rectangle(std::istream& in) -> mir::geometry::Rectangle
+{
+    int x, y, width, height;
+    char comma;
+    in >> x >> comma >> y >> comma >> width >> comma >> height;
+    return {{x, y}, {width, height}};
+}
+
+auto create_surface(
+    std::shared_ptr<mir::scene::Session> const& session,
+    mir::scene::SurfaceCreationParameters const& params) -> mir::frontend::SurfaceId
+{
+    std::shared_ptr<mir::frontend::EventSink> const sink;
+    return session->create_surface(params, sink);
+}
+
+std::vector<uint8_t> const no_cookie;
+}
+
+WindowManagementReplay::WindowManagementReplay(miral::WindowManagementPolicyBuilder const& build_policy) :
+    display_layout{std::make_shared<StubDisplayLayout>()},
+    persistent_surface_store{std::make_shared<StubPersistentSurfaceStore>()},
+    window_manager{&focus_controller, display_layout, persistent_surface_store, build_policy}
+{
+}
+
+auto WindowManagementReplay::surface(int id) const -> std::shared_ptr<mir::scene::Surface>
+{
+    return surfaces.at(id);
+}
+
+auto WindowManagementReplay::replay(std::istream& recording) -> unsigned int
+{
+    auto calls = 0U;
+
+    for (std::string line; std::getline(recording, line);)
+    {
+        std::istringstream in{line};
+        long long timestamp;
+        std::string call;
+
+        if (in >> timestamp >> call)
+        {
+            replay_call(call, std::chrono::nanoseconds{timestamp}, in);
+            ++calls;
+        }
+    }
+
+    return calls;
+}
+
+void WindowManagementReplay::replay_call(
+    std::string const& call, std::chrono::nanoseconds timestamp, std::istream& arguments)
+{
+    auto const surface_for = [this](int id) { return surface(id); };
+
+    int session_id = 0;
+    int surface_id = 0;
+
+    if (call == "add_session")
+    {
+        pid_t pid;
+        std::string name;
+        arguments >> session_id >> pid >> std::quoted(name);
+        auto const session = std::make_shared<ReplaySession>(name, pid);
+        sessions[session_id] = session;
+        window_manager.add_session(session);
+    }
+    else if (call == "remove_session")
+    {
+        arguments >> session_id;
+        auto const session = sessions.at(session_id);
+        sessions.erase(session_id);
+        window_manager.remove_session(session);
+    }
+    else if (call == "add_surface")
+    {
+        arguments >> session_id >> surface_id;
+        auto const session = sessions.at(session_id);
+        mir::scene::SurfaceCreationParameters params;
+        miral::recording::read_specification(arguments, surface_for).update(params);
+        auto const id = window_manager.add_surface(session, params, &create_surface);
+        surfaces[surface_id] = session->surface(id);
+    }
+    else if (call == "modify_surface")
+    {
+        arguments >> session_id >> surface_id;
+        auto const modifications = shell_specification(miral::recording::read_specification(arguments, surface_for));
+        window_manager.modify_surface(sessions.at(session_id), surface(surface_id), modifications);
+    }
+    else if (call == "remove_surface")
+    {
+        arguments >> session_id >> surface_id;
+        auto const removed = surface(surface_id);
+        surfaces.erase(surface_id);
+        window_manager.remove_surface(sessions.at(session_id), removed);
+    }
+    else if (call == "add_display")
+    {
+        window_manager.add_display(read_rectangle(arguments));
+    }
+    else if (call == "remove_display")
+    {
+        window_manager.remove_display(read_rectangle(arguments));
+    }
+    else if (call == "handle_keyboard_event")
+    {
+        MirInputDeviceId device;
+        MirInputEventModifiers modifiers;
+        int action, key_code, scan_code;
+        arguments >> device >> modifiers >> action >> key_code >> scan_code;
+
+        auto const event = mev::make_event(
+            device, timestamp, no_cookie, MirKeyboardAction(action), key_code, scan_code, modifiers);
+
+        window_manager.handle_keyboard_event(
+            mir_input_event_get_keyboard_event(mir_event_get_input_event(event.get())));
+    }
+    else if (call == "handle_touch_event")
+    {
+        MirInputDeviceId device;
+        MirInputEventModifiers modifiers;
+        unsigned int count;
+        arguments >> device >> modifiers >> count;
+
+        auto const event = mev::make_event(device, timestamp, no_cookie, modifiers);
+
+        for (auto i = 0U; i != count; ++i)
+        {
+            MirTouchId id;
+            int action, tool;
+            float x, y, pressure, major, minor, size;
+            arguments >> id >> action >> tool >> x >> y >> pressure >> major >> minor >> size;
+            mev::add_touch(*event, id, MirTouchAction(action), MirTouchTooltype(tool), x, y, pressure, major, minor, size);
+        }
+
+        window_manager.handle_touch_event(
+            mir_input_event_get_touch_event(mir_event_get_input_event(event.get())));
+    }
+    else if (call == "handle_pointer_event")
+    {
+        MirInputDeviceId device;
+        MirInputEventModifiers modifiers;
+        int action;
+        unsigned int buttons;
+        float x, y, hscroll, vscroll, dx, dy;
+        arguments >> device >> modifiers >> action >> buttons >> x >> y >> hscroll >> vscroll >> dx >> dy;
+
+        auto const event = mev::make_event(
+            device, timestamp, no_cookie, modifiers, MirPointerAction(action), MirPointerButtons(buttons),
+            x, y, hscroll, vscroll, dx, dy);
+
+        window_manager.handle_pointer_event(
+            mir_input_event_get_pointer_event(mir_event_get_input_event(event.get())));
+    }
+    else if (call == "handle_raise_surface")
+    {
+        uint64_t event_timestamp;
+        arguments >> session_id >> surface_id >> event_timestamp;
+        window_manager.handle_raise_surface(sessions.at(session_id), surface(surface_id), event_timestamp);
+    }
+#if MIR_SERVER_VERSION >= MIR_VERSION_NUMBER(0, 27, 0)
+    else if (call == "handle_request_drag_and_drop")
+    {
+        uint64_t event_timestamp;
+        arguments >> session_id >> surface_id >> event_timestamp;
+        window_manager.handle_request_drag_and_drop(sessions.at(session_id), surface(surface_id), event_timestamp);
+    }
+#endif
+    else if (call == "set_surface_attribute")
+    {
+        int attrib, value;
+        arguments >> session_id >> surface_id >> attrib >> value;
+        window_manager.set_surface_attribute(sessions.at(session_id), surface(surface_id), MirWindowAttrib(attrib), value);
+    }
+    else
+    {
+        throw std::runtime_error("Unknown call in window management recording: " + call);
+    }
+}
+
+auto replay_main(int argc, char const* argv[], miral::WindowManagementPolicyBuilder const& build_policy) -> int
+try
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <recording>..." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    for (auto arg = argv + 1; arg != argv + argc; ++arg)
+    {
+        std::ifstream recording{*arg};
+
+        if (!recording)
+        {
+            std::cerr << "Cannot open " << *arg << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        WindowManagementReplay replay{build_policy};
+
+        auto const start = std::chrono::steady_clock::now();
+        auto const calls = replay.replay(recording);
+        auto const elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << *arg << ": replayed " << calls << " calls in "
+                  << std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() << "us" << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
+catch (std::exception const& error)
+{
+    std::cerr << argv[0] << ": " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
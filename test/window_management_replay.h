@@ -0,0 +1,72 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_TEST_WINDOW_MANAGEMENT_REPLAY_H
+#define MIRAL_TEST_WINDOW_MANAGEMENT_REPLAY_H
+
+#include "window_manager_stubs.h"
+#include "../miral/basic_window_manager.h"
+
+#include <chrono>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <string>
+
+struct ReplaySession : StubStubSession
+{
+    ReplaySession(std::string const& name, pid_t pid) : name_{name}, pid{pid} {}
+
+    std::string name() const override { return name_; }
+    pid_t process_id() const override { return pid; }
+
+    std::string const name_;
+    pid_t const pid;
+};
+
+/// Replays a recording made by miral::RecordingWindowManager against a
+/// BasicWindowManager running the supplied policy, using stub sessions and
+/// surfaces in place of the clients that made the recording.
+class WindowManagementReplay
+{
+public:
+    explicit WindowManagementReplay(miral::WindowManagementPolicyBuilder const& build_policy);
+
+    /// \return the number of calls replayed
+    auto replay(std::istream& recording) -> unsigned int;
+
+    auto surface(int id) const -> std::shared_ptr<mir::scene::Surface>;
+
+private:
+    void replay_call(std::string const& call, std::chrono::nanoseconds timestamp, std::istream& arguments);
+
+    StubFocusController focus_controller;
+    std::shared_ptr<StubDisplayLayout> const display_layout;
+    std::shared_ptr<StubPersistentSurfaceStore> const persistent_surface_store;
+    miral::BasicWindowManager window_manager;
+    std::map<int, std::shared_ptr<ReplaySession>> sessions;
+    std::map<int, std::shared_ptr<mir::scene::Surface>> surfaces;
+};
+
+/// The body of a replay tool: "<program> <recording>..." replays each recording
+/// against a new window manager running the policy build_policy creates and
+/// reports the time taken. To measure a policy, link window-management-replay
+/// and call this from main() - miral-replay does so for CanonicalWindowManagerPolicy.
+auto replay_main(int argc, char const* argv[], miral::WindowManagementPolicyBuilder const& build_policy) -> int;
+
+#endif //MIRAL_TEST_WINDOW_MANAGEMENT_REPLAY_H
@@ -17,6 +17,7 @@
  */
 
 #include "test_window_manager_tools.h"
+#include "../miral/placement_solver.h"
 
 using namespace miral;
 using namespace testing;
@@ -206,3 +207,72 @@ TEST_F(WindowPlacementAnchorsToParent, given_rect_and_offset_below_left_parent_c
     ASSERT_THAT(child.top_left(), Eq(expected_position));
     ASSERT_THAT(child.size(), Eq(initial_child_size));
 }
+
+namespace
+{
+// The anchored popup cases above, as requests to the placement solver
+auto anchored_popup_requests() -> std::vector<PlacementSolver::Request>
+{
+    Rectangle const parent{{100, 100}, {parent_width, parent_height}};
+    Size const size{100, 50};
+    auto const rect_size = 10;
+
+    auto request = [&](
+        Rectangle const& aux_rect, Displacement offset,
+        MirPlacementGravity rect_gravity, MirPlacementGravity window_gravity, MirPlacementHints hints)
+        {
+            return PlacementSolver::Request{parent, aux_rect, offset, rect_gravity, window_gravity, hints, size, display_area};
+        };
+
+    return {
+        request({{parent_width-rect_size/2, parent_height/2}, {rect_size, rect_size}}, {},
+            mir_placement_gravity_northeast, mir_placement_gravity_northwest,
+            MirPlacementHints(mir_placement_hints_slide_y|mir_placement_hints_resize_x)),
+        request({{parent_width/2, -rect_size/2}, {rect_size, rect_size}}, {},
+            mir_placement_gravity_northeast, mir_placement_gravity_southeast, mir_placement_hints_slide_x),
+        request({{parent_width-rect_size, parent_height/2}, {rect_size, rect_size}}, {rect_size, 0},
+            mir_placement_gravity_northeast, mir_placement_gravity_northwest,
+            MirPlacementHints(mir_placement_hints_slide_y|mir_placement_hints_resize_x)),
+        request({{parent_width/2, 0}, {rect_size, rect_size}}, {0, -rect_size},
+            mir_placement_gravity_northeast, mir_placement_gravity_southeast, mir_placement_hints_slide_x),
+        request({{-rect_size, parent_height}, {rect_size, rect_size}}, {-rect_size, rect_size},
+            mir_placement_gravity_southwest, mir_placement_gravity_northeast, mir_placement_hints_resize_any),
+        request({{parent_width/2, parent_height/2}, {rect_size, rect_size}}, {},
+            mir_placement_gravity_south, mir_placement_gravity_north,
+            MirPlacementHints(mir_placement_hints_flip_any|mir_placement_hints_antipodes)),
+    };
+}
+}
+
+TEST(PlacementSolver, remembered_placements_match_solved_placements)
+{
+    PlacementSolver solver;
+
+    for (auto pass = 0; pass != 2; ++pass)
+    {
+        for (auto const& request : anchored_popup_requests())
+        {
+            auto const expected = PlacementSolver::solve(request);
+            auto const actual = solver.place(request);
+
+            ASSERT_THAT(actual.is_set(), Eq(expected.is_set()));
+            if (expected.is_set())
+                EXPECT_THAT(actual.value(), Eq(expected.value()));
+        }
+    }
+}
+
+TEST(PlacementSolver, a_changed_display_is_not_served_from_the_cache)
+{
+    PlacementSolver solver;
+    auto request = anchored_popup_requests()[0];
+
+    auto const before = solver.place(request);
+    request.display = Rectangle{{0, 0}, {520, 600}};
+    auto const after = solver.place(request);
+
+    ASSERT_THAT(before.is_set(), Eq(true));
+    ASSERT_THAT(after.is_set(), Eq(true));
+    EXPECT_THAT(after.value(), Eq(PlacementSolver::solve(request).value()));
+    EXPECT_THAT(after.value(), Ne(before.value()));
+}
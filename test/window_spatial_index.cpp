@@ -0,0 +1,166 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "test_window_manager_tools.h"
+
+using namespace miral;
+using namespace testing;
+
+namespace
+{
+Rectangle const display_area{{0, 0}, {640, 480}};
+Size const window_size{100, 100};
+
+struct SpatialQueries : TestWindowManagerTools
+{
+    std::vector<Window> windows;
+
+    void SetUp() override
+    {
+        basic_window_manager.add_display(display_area);
+        basic_window_manager.add_session(session);
+
+        ON_CALL(*window_manager_policy, advise_new_window(_))
+            .WillByDefault(Invoke([this](WindowInfo const& window_info){ windows.push_back(window_info.window()); }));
+    }
+
+    auto create_window(Point top_left) -> Window
+    {
+        mir::scene::SurfaceCreationParameters creation_parameters;
+        creation_parameters.size = window_size;
+        basic_window_manager.add_surface(session, creation_parameters, &create_surface);
+
+        auto const window = windows.back();
+        move(window, top_left);
+        return window;
+    }
+
+    void move(Window const& window, Point top_left)
+    {
+        window_manager_tools.invoke_under_lock([&]
+            {
+                WindowSpecification modifications;
+                modifications.top_left() = top_left;
+                window_manager_tools.modify_window(window, modifications);
+            });
+    }
+
+    auto windows_at(Point point) -> std::vector<Window>
+    {
+        std::vector<Window> result;
+        window_manager_tools.invoke_under_shared_lock([&] { result = window_manager_tools.windows_at(point); });
+        return result;
+    }
+
+    auto windows_in(Rectangle const& area) -> std::vector<Window>
+    {
+        std::vector<Window> result;
+        window_manager_tools.invoke_under_shared_lock([&] { result = window_manager_tools.windows_in(area); });
+        return result;
+    }
+};
+}
+
+TEST_F(SpatialQueries, finds_windows_containing_a_point)
+{
+    auto const left = create_window({0, 0});
+    auto const right = create_window({50, 0});
+
+    EXPECT_THAT(windows_at({10, 10}), ElementsAre(left));
+    EXPECT_THAT(windows_at({60, 10}), UnorderedElementsAre(left, right));
+    EXPECT_THAT(windows_at({140, 10}), ElementsAre(right));
+    EXPECT_THAT(windows_at({10, 110}), IsEmpty());
+}
+
+TEST_F(SpatialQueries, follows_a_moved_window)
+{
+    auto const window = create_window({0, 0});
+
+    move(window, {1000, 1000});
+
+    EXPECT_THAT(windows_at({10, 10}), IsEmpty());
+    EXPECT_THAT(windows_at({1010, 1010}), ElementsAre(window));
+}
+
+TEST_F(SpatialQueries, follows_a_window_the_policy_moves_itself)
+{
+    auto window = create_window({0, 0});
+
+    window_manager_tools.invoke_under_lock([&]
+        {
+            window.move_to({1000, 1000});
+
+            EXPECT_THAT(window_manager_tools.windows_at({1010, 1010}), ElementsAre(window));
+        });
+
+    EXPECT_THAT(windows_at({10, 10}), IsEmpty());
+    EXPECT_THAT(windows_at({1010, 1010}), ElementsAre(window));
+}
+
+TEST_F(SpatialQueries, follows_a_window_the_policy_resizes_itself)
+{
+    auto window = create_window({0, 0});
+
+    window_manager_tools.invoke_under_lock([&] { window.resize({1000, 1000}); });
+
+    EXPECT_THAT(windows_at({900, 900}), ElementsAre(window));
+    EXPECT_THAT(windows_in({{500, 500}, {10, 10}}), ElementsAre(window));
+}
+
+TEST_F(SpatialQueries, handles_negative_coordinates)
+{
+    auto const window = create_window({-300, -300});
+
+    EXPECT_THAT(windows_at({-299, -299}), ElementsAre(window));
+    EXPECT_THAT(windows_at({-201, -201}), ElementsAre(window));
+    EXPECT_THAT(windows_at({-200, -200}), IsEmpty());
+}
+
+TEST_F(SpatialQueries, forgets_a_removed_window)
+{
+    auto const window = create_window({0, 0});
+
+    basic_window_manager.remove_surface(session, window);
+
+    EXPECT_THAT(windows_at({10, 10}), IsEmpty());
+}
+
+TEST_F(SpatialQueries, reports_each_window_in_an_area_once)
+{
+    // These windows straddle cells of the index
+    auto const first = create_window({200, 200});
+    auto const second = create_window({500, 200});
+    auto const outside = create_window({2000, 2000});
+
+    EXPECT_THAT(windows_in({{0, 0}, {1000, 1000}}), UnorderedElementsAre(first, second));
+    EXPECT_THAT(windows_in({{250, 250}, {300, 10}}), UnorderedElementsAre(first, second));
+    EXPECT_THAT(windows_in({{0, 0}, {5000, 5000}}), UnorderedElementsAre(first, second, outside));
+    EXPECT_THAT(windows_in({{0, 0}, {100, 100}}), IsEmpty());
+}
+
+TEST_F(SpatialQueries, finds_a_window_larger_than_many_cells)
+{
+    auto const window = create_window({0, 0});
+
+    WindowSpecification modifications;
+    modifications.size() = Size{10000, 10000};
+    window_manager_tools.invoke_under_lock([&] { window_manager_tools.modify_window(window, modifications); });
+
+    EXPECT_THAT(windows_at({9000, 9000}), ElementsAre(window));
+    EXPECT_THAT(windows_in({{5000, 5000}, {10, 10}}), ElementsAre(window));
+}
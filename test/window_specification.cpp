@@ -0,0 +1,108 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "test_window_manager_tools.h"
+
+using namespace miral;
+using namespace testing;
+
+namespace
+{
+Rectangle const display_area{{0, 0}, {640, 480}};
+
+struct WindowSpecificationStorage : TestWindowManagerTools
+{
+    Window window;
+
+    void SetUp() override
+    {
+        basic_window_manager.add_display(display_area);
+        basic_window_manager.add_session(session);
+
+        EXPECT_CALL(*window_manager_policy, advise_new_window(_))
+            .WillOnce(Invoke([this](WindowInfo const& window_info){ window = window_info.window(); }));
+
+        mir::scene::SurfaceCreationParameters creation_parameters;
+        creation_parameters.size = Size{100, 100};
+        basic_window_manager.add_surface(session, creation_parameters, &create_surface);
+
+        Mock::VerifyAndClearExpectations(window_manager_policy);
+    }
+};
+}
+
+TEST_F(WindowSpecificationStorage, unset_fields_read_as_unset)
+{
+    WindowSpecification const specification;
+
+    EXPECT_FALSE(specification.top_left().is_set());
+    EXPECT_FALSE(specification.name().is_set());
+    EXPECT_FALSE(specification.parent().is_set());
+    EXPECT_FALSE(specification.input_shape().is_set());
+    EXPECT_FALSE(specification.userdata().is_set());
+}
+
+TEST_F(WindowSpecificationStorage, copies_do_not_share_fields)
+{
+    WindowSpecification original;
+    original.name() = "original";
+    original.top_left() = Point{10, 10};
+
+    WindowSpecification copy{original};
+    copy.name() = "copy";
+    copy.top_left() = Point{20, 20};
+
+    EXPECT_THAT(original.name().value(), Eq("original"));
+    EXPECT_THAT(original.top_left().value(), Eq(Point{10, 10}));
+    EXPECT_THAT(copy.name().value(), Eq("copy"));
+    EXPECT_THAT(copy.top_left().value(), Eq(Point{20, 20}));
+}
+
+TEST_F(WindowSpecificationStorage, assignment_replaces_all_fields)
+{
+    WindowSpecification target;
+    target.name() = "target";
+    target.input_shape() = std::vector<Rectangle>{display_area};
+
+    WindowSpecification source;
+    source.size() = Size{42, 42};
+
+    target = source;
+
+    EXPECT_FALSE(target.name().is_set());
+    EXPECT_FALSE(target.input_shape().is_set());
+    EXPECT_THAT(target.size().value(), Eq(Size{42, 42}));
+
+    source.name() = "source";
+    target = source;
+
+    EXPECT_THAT(target.name().value(), Eq("source"));
+}
+
+TEST_F(WindowSpecificationStorage, a_field_read_before_it_is_set_sees_later_writes)
+{
+    WindowSpecification specification;
+    auto const& name = static_cast<WindowSpecification const&>(specification).name();
+    auto const& parent = static_cast<WindowSpecification const&>(specification).parent();
+
+    specification.name() = "named later";
+    specification.parent() = std::weak_ptr<mir::scene::Surface>{};
+
+    EXPECT_THAT(name.value(), Eq("named later"));
+    EXPECT_TRUE(parent.is_set());
+}
@@ -0,0 +1,209 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "../miral/surface_cache.h"
+
+#include "test_window_manager_tools.h"
+
+#include <mir/scene/surface_observer.h>
+
+using namespace miral;
+using namespace testing;
+
+namespace
+{
+// Like the real scene surface this notifies observers of changes, and isn't
+// visible until it is shown and has a frame posted
+struct ObservableSurface : StubSurface
+{
+    using StubSurface::StubSurface;
+
+    void add_observer(std::shared_ptr<mir::scene::SurfaceObserver> const& observer) override
+    {
+        observers.push_back(observer);
+    }
+
+    void move_to(Point const& top_left) override
+    {
+        StubSurface::move_to(top_left);
+        for (auto const& observer : observers)
+            observer->moved_to(top_left);
+    }
+
+    void resize(Size const& size) override
+    {
+        StubSurface::resize(size);
+        for (auto const& observer : observers)
+            observer->resized_to(size);
+    }
+
+    auto configure(MirWindowAttrib attrib, int value) -> int override
+    {
+        auto const result = StubSurface::configure(attrib, value);
+        for (auto const& observer : observers)
+            observer->attrib_changed(attrib, result);
+        return result;
+    }
+
+    void hide() override { set_hidden(true); }
+    void show() override { set_hidden(false); }
+
+    bool visible() const override { return !hidden && frame_posted; }
+
+    void post_frame()
+    {
+        frame_posted = true;
+        for (auto const& observer : observers)
+            observer->frame_posted(1, size());
+    }
+
+    void set_hidden(bool hide)
+    {
+        hidden = hide;
+        for (auto const& observer : observers)
+            observer->hidden_set_to(hide);
+    }
+
+    bool hidden = false;
+    bool frame_posted = false;
+    std::vector<std::shared_ptr<mir::scene::SurfaceObserver>> observers;
+};
+
+Point const initial_top_left{10, 20};
+Size const initial_size{300, 200};
+
+struct WindowSurfaceCache : Test
+{
+    std::shared_ptr<StubStubSession> const session{std::make_shared<StubStubSession>()};
+
+    auto make_surface() const -> std::shared_ptr<ObservableSurface>
+    {
+        return std::make_shared<ObservableSurface>("", mir_window_type_normal, initial_top_left, initial_size);
+    }
+};
+
+auto matches_surface(std::shared_ptr<ObservableSurface> const& surface) -> Matcher<Window const&>
+{
+    return AllOf(
+        Property(&Window::top_left, Eq(surface->top_left())),
+        Property(&Window::size, Eq(surface->size())),
+        ResultOf([](Window const& window) { return SurfaceCache::state(window); }, Eq(surface->state())),
+        ResultOf([](Window const& window) { return SurfaceCache::visible(window); }, Eq(surface->visible())));
+}
+}
+
+TEST_F(WindowSurfaceCache, attached_window_reports_surface_geometry)
+{
+    Window const window{session, make_surface()};
+
+    SurfaceCache::attach(window);
+
+    EXPECT_THAT(window.top_left(), Eq(initial_top_left));
+    EXPECT_THAT(window.size(), Eq(initial_size));
+}
+
+TEST_F(WindowSurfaceCache, changes_notified_by_the_surface_are_seen)
+{
+    auto const surface = make_surface();
+    Window const window{session, surface};
+    SurfaceCache::attach(window);
+
+    surface->move_to({42, 24});
+    surface->resize({123, 321});
+
+    EXPECT_THAT(window.top_left(), Eq(Point{42, 24}));
+    EXPECT_THAT(window.size(), Eq(Size{123, 321}));
+}
+
+TEST_F(WindowSurfaceCache, cache_matches_surface_after_each_change)
+{
+    auto const surface = make_surface();
+    Window const window{session, surface};
+    SurfaceCache::attach(window);
+
+    EXPECT_THAT(window, matches_surface(surface));
+
+    surface->post_frame();
+    EXPECT_THAT(window, matches_surface(surface));
+    EXPECT_TRUE(SurfaceCache::visible(window));
+
+    surface->configure(mir_window_attrib_state, mir_window_state_maximized);
+    EXPECT_THAT(window, matches_surface(surface));
+    EXPECT_THAT(SurfaceCache::state(window), Eq(mir_window_state_maximized));
+
+    surface->move_to({42, 24});
+    EXPECT_THAT(window, matches_surface(surface));
+
+    surface->resize({123, 321});
+    EXPECT_THAT(window, matches_surface(surface));
+
+    surface->hide();
+    EXPECT_THAT(window, matches_surface(surface));
+    EXPECT_FALSE(SurfaceCache::visible(window));
+
+    surface->configure(mir_window_attrib_state, mir_window_state_minimized);
+    EXPECT_THAT(window, matches_surface(surface));
+
+    surface->configure(mir_window_attrib_state, mir_window_state_restored);
+    surface->show();
+    EXPECT_THAT(window, matches_surface(surface));
+    EXPECT_TRUE(SurfaceCache::visible(window));
+}
+
+TEST_F(WindowSurfaceCache, refresh_picks_up_unnotified_changes)
+{
+    // A surface that doesn't notify its observers
+    auto const surface = std::make_shared<StubSurface>("", mir_window_type_normal, initial_top_left, initial_size);
+    Window const window{session, surface};
+    SurfaceCache::attach(window);
+
+    surface->configure(mir_window_attrib_state, mir_window_state_hidden);
+    SurfaceCache::refresh(window);
+
+    EXPECT_THAT(SurfaceCache::state(window), Eq(mir_window_state_hidden));
+    EXPECT_FALSE(SurfaceCache::visible(window));
+}
+
+TEST_F(WindowSurfaceCache, changes_made_through_the_window_are_seen)
+{
+    // A surface that doesn't notify its observers
+    auto const surface = std::make_shared<StubSurface>("", mir_window_type_normal, initial_top_left, initial_size);
+    Window window{session, surface};
+    SurfaceCache::attach(window);
+
+    window.move_to({42, 24});
+    window.resize({123, 321});
+
+    EXPECT_THAT(window.top_left(), Eq(Point{42, 24}));
+    EXPECT_THAT(window.size(), Eq(Size{123, 321}));
+}
+
+TEST_F(WindowSurfaceCache, window_is_empty_once_surface_is_gone)
+{
+    auto surface = make_surface();
+    Window const window{session, surface};
+    SurfaceCache::attach(window);
+
+    surface.reset();
+
+    EXPECT_FALSE(window);
+    EXPECT_THAT(window.top_left(), Eq(Point{}));
+    EXPECT_THAT(window.size(), Eq(Size{}));
+    EXPECT_THAT(SurfaceCache::state(window), Eq(mir_window_state_unknown));
+    EXPECT_FALSE(SurfaceCache::visible(window));
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "test_window_manager_tools.h"
+
+using namespace miral;
+using namespace testing;
+
+namespace
+{
+Rectangle const display_area{{0, 0}, {640, 480}};
+
+// parent
+//   ├── child
+//   │     └── grandchild
+//   └── second_child
+struct WindowTree : TestWindowManagerTools
+{
+    Window parent;
+    Window child;
+    Window grandchild;
+    Window second_child;
+
+    void SetUp() override
+    {
+        basic_window_manager.add_display(display_area);
+        basic_window_manager.add_session(session);
+
+        EXPECT_CALL(*window_manager_policy, advise_new_window(_))
+            .WillOnce(Invoke([this](WindowInfo const& window_info){ parent = window_info.window(); }))
+            .WillOnce(Invoke([this](WindowInfo const& window_info){ child = window_info.window(); }))
+            .WillOnce(Invoke([this](WindowInfo const& window_info){ grandchild = window_info.window(); }))
+            .WillOnce(Invoke([this](WindowInfo const& window_info){ second_child = window_info.window(); }));
+
+        mir::scene::SurfaceCreationParameters creation_parameters;
+        creation_parameters.size = Size{400, 300};
+        basic_window_manager.add_surface(session, creation_parameters, &create_surface);
+
+        creation_parameters.type = mir_window_type_menu;
+        creation_parameters.size = Size{100, 100};
+        creation_parameters.parent = parent;
+        basic_window_manager.add_surface(session, creation_parameters, &create_surface);
+
+        creation_parameters.parent = child;
+        basic_window_manager.add_surface(session, creation_parameters, &create_surface);
+
+        creation_parameters.parent = parent;
+        basic_window_manager.add_surface(session, creation_parameters, &create_surface);
+
+        Mock::VerifyAndClearExpectations(window_manager_policy);
+    }
+};
+}
+
+TEST_F(WindowTree, raising_a_tree_lists_parents_before_their_children)
+{
+    EXPECT_CALL(*window_manager_policy, advise_raise(ElementsAre(parent, child, grandchild, second_child)));
+
+    basic_window_manager.raise_tree(parent);
+}
+
+TEST_F(WindowTree, moving_the_root_moves_every_descendant)
+{
+    Displacement const movement{13, 17};
+
+    std::vector<Point> const initial{
+        parent.top_left(), child.top_left(), grandchild.top_left(), second_child.top_left()};
+
+    WindowSpecification modifications;
+    modifications.top_left() = parent.top_left() + movement;
+
+    basic_window_manager.invoke_under_lock([&]
+        { window_manager_tools.modify_window(parent, modifications); });
+
+    EXPECT_THAT(parent.top_left(), Eq(initial[0] + movement));
+    EXPECT_THAT(child.top_left(), Eq(initial[1] + movement));
+    EXPECT_THAT(grandchild.top_left(), Eq(initial[2] + movement));
+    EXPECT_THAT(second_child.top_left(), Eq(initial[3] + movement));
+}
@@ -0,0 +1,221 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "../miral-shell/worker.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace testing;
+
+namespace
+{
+struct WorkerTest : Test
+{
+    Worker worker;
+    std::thread thread;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool released = false;
+
+    void start()
+    {
+        thread = std::thread{[this] { worker.start_work(); }};
+    }
+
+    void finish()
+    {
+        worker.stop_work();
+        thread.join();
+    }
+
+    // Work that holds up key until release() is called
+    void block(Worker::Key key)
+    {
+        worker.enqueue_work(key, [this]
+            {
+                std::unique_lock<std::mutex> lock{mutex};
+                cv.wait(lock, [this] { return released; });
+            });
+    }
+
+    void release()
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        released = true;
+        cv.notify_all();
+    }
+
+    ~WorkerTest()
+    {
+        if (thread.joinable())
+        {
+            release();
+            finish();
+        }
+    }
+};
+
+int const keys[] = { 1, 2, 3, 4 };
+}
+
+TEST_F(WorkerTest, work_with_the_same_key_runs_in_the_order_it_was_enqueued)
+{
+    auto const items_per_key = 100;
+
+    std::mutex done_mutex;
+    std::map<Worker::Key, std::vector<int>> done;
+
+    start();
+
+    for (auto i = 0; i != items_per_key; ++i)
+    {
+        for (auto const& key : keys)
+        {
+            worker.enqueue_work(&key, [&, i, key = &key]
+                {
+                    std::lock_guard<std::mutex> lock{done_mutex};
+                    done[key].push_back(i);
+                });
+        }
+    }
+
+    finish();
+
+    std::vector<int> in_order;
+    for (auto i = 0; i != items_per_key; ++i)
+        in_order.push_back(i);
+
+    for (auto const& key : keys)
+        EXPECT_THAT(done[&key], ContainerEq(in_order));
+}
+
+TEST_F(WorkerTest, work_with_different_keys_runs_in_parallel)
+{
+    std::atomic<bool> other_key_ran{false};
+
+    start();
+
+    block(&keys[0]);
+    worker.enqueue_work(&keys[1], [&] { other_key_ran = true; release(); });
+
+    finish();
+
+    EXPECT_TRUE(other_key_ran);
+}
+
+TEST_F(WorkerTest, unkeyed_work_waits_for_earlier_work_and_later_work_waits_for_it)
+{
+    auto const items_per_key = 10;
+
+    std::atomic<int> keyed_done{0};
+    std::atomic<bool> unkeyed_done{false};
+    int keyed_done_before_unkeyed = -1;
+    std::atomic<int> later_work_before_unkeyed{0};
+
+    start();
+
+    for (auto i = 0; i != items_per_key; ++i)
+    {
+        for (auto const& key : keys)
+        {
+            worker.enqueue_work(&key, [&]
+                {
+                    std::this_thread::sleep_for(std::chrono::microseconds{100});
+                    ++keyed_done;
+                });
+        }
+    }
+
+    worker.enqueue_work([&]
+        {
+            keyed_done_before_unkeyed = keyed_done;
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+            unkeyed_done = true;
+        });
+
+    for (auto const& key : keys)
+        worker.enqueue_work(&key, [&] { if (!unkeyed_done) ++later_work_before_unkeyed; });
+
+    finish();
+
+    EXPECT_THAT(keyed_done_before_unkeyed, Eq(items_per_key*int(sizeof keys/sizeof *keys)));
+    EXPECT_THAT(later_work_before_unkeyed, Eq(0));
+}
+
+TEST_F(WorkerTest, superseding_work_that_has_not_started_is_replaced)
+{
+    std::vector<int> done;
+
+    start();
+
+    block(&keys[0]);
+    worker.enqueue_superseding_work(&keys[0], [&] { done.push_back(1); });
+    worker.enqueue_superseding_work(&keys[0], [&] { done.push_back(2); });
+    worker.enqueue_superseding_work(&keys[0], [&] { done.push_back(3); });
+    release();
+
+    finish();
+
+    EXPECT_THAT(done, ElementsAre(3));
+}
+
+TEST_F(WorkerTest, superseding_work_does_not_replace_ordinary_work)
+{
+    std::vector<int> done;
+
+    start();
+
+    block(&keys[0]);
+    worker.enqueue_superseding_work(&keys[0], [&] { done.push_back(1); });
+    worker.enqueue_work(&keys[0], [&] { done.push_back(2); });
+    worker.enqueue_superseding_work(&keys[0], [&] { done.push_back(3); });
+    worker.enqueue_work(&keys[0], [&] { done.push_back(4); });
+    release();
+
+    finish();
+
+    EXPECT_THAT(done, ElementsAre(1, 2, 3, 4));
+}
+
+TEST_F(WorkerTest, superseding_work_only_replaces_work_with_the_same_key)
+{
+    std::mutex done_mutex;
+    std::vector<int> done;
+
+    start();
+
+    block(&keys[0]);
+    block(&keys[1]);
+    worker.enqueue_superseding_work(&keys[0], [&] { std::lock_guard<std::mutex> lock{done_mutex}; done.push_back(1); });
+    worker.enqueue_superseding_work(&keys[1], [&] { std::lock_guard<std::mutex> lock{done_mutex}; done.push_back(2); });
+    release();
+
+    finish();
+
+    EXPECT_THAT(done, UnorderedElementsAre(1, 2));
+}
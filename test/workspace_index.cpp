@@ -0,0 +1,123 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "../miral/workspace_index.h"
+
+#include <mir/test/doubles/stub_surface.h>
+#include <mir/test/doubles/stub_session.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+
+namespace
+{
+struct WorkspaceIndex : Test
+{
+    std::shared_ptr<mir::scene::Session> const session{std::make_shared<mir::test::doubles::StubSession>()};
+
+    miral::WorkspaceIndex index;
+
+    auto make_window() -> miral::Window
+    {
+        auto const surface = std::make_shared<mir::test::doubles::StubSurface>();
+        surfaces.push_back(surface);
+        return {session, surface};
+    }
+
+    std::vector<std::shared_ptr<mir::scene::Surface>> surfaces;
+};
+}
+
+TEST_F(WorkspaceIndex, a_window_is_added_to_a_workspace_once)
+{
+    auto const slot = index.allocate_slot();
+    auto const window = make_window();
+
+    EXPECT_TRUE(index.insert(slot, window));
+    EXPECT_FALSE(index.insert(slot, window));
+    EXPECT_THAT(index.windows_in(slot), ElementsAre(window));
+}
+
+TEST_F(WorkspaceIndex, windows_are_listed_in_the_order_added)
+{
+    auto const slot = index.allocate_slot();
+    auto const first = make_window();
+    auto const second = make_window();
+    auto const third = make_window();
+
+    index.insert(slot, second);
+    index.insert(slot, first);
+    index.insert(slot, third);
+    index.erase(slot, first);
+
+    EXPECT_THAT(index.windows_in(slot), ElementsAre(second, third));
+}
+
+TEST_F(WorkspaceIndex, windows_share_a_workspace_beyond_the_first_64)
+{
+    std::vector<miral::WorkspaceIndex::Slot> slots;
+
+    for (auto i = 0; i != 200; ++i)
+        slots.push_back(index.allocate_slot());
+
+    auto const window = make_window();
+    auto const same_workspace = make_window();
+    auto const other_workspace = make_window();
+
+    index.insert(slots[150], window);
+    index.insert(slots[150], same_workspace);
+    index.insert(slots[199], other_workspace);
+
+    auto const workspaces = index.workspaces_containing(window);
+
+    EXPECT_TRUE(index.shares_workspace(workspaces, same_workspace));
+    EXPECT_FALSE(index.shares_workspace(workspaces, other_workspace));
+}
+
+TEST_F(WorkspaceIndex, erasing_a_window_removes_it_from_all_workspaces)
+{
+    auto const slot1 = index.allocate_slot();
+    auto const slot2 = index.allocate_slot();
+    auto const window = make_window();
+    auto const other = make_window();
+
+    index.insert(slot1, window);
+    index.insert(slot2, window);
+    index.insert(slot2, other);
+
+    index.erase(window);
+
+    EXPECT_TRUE(index.workspaces_containing(window).empty());
+    EXPECT_THAT(index.windows_in(slot1), IsEmpty());
+    EXPECT_THAT(index.windows_in(slot2), ElementsAre(other));
+}
+
+TEST_F(WorkspaceIndex, a_released_slot_is_reused_empty)
+{
+    auto const slot = index.allocate_slot();
+    auto const window = make_window();
+
+    index.insert(slot, window);
+    index.release_slot(slot);
+
+    EXPECT_TRUE(index.workspaces_containing(window).empty());
+    EXPECT_THAT(index.allocate_slot(), Eq(slot));
+    EXPECT_THAT(index.windows_in(slot), IsEmpty());
+}
@@ -0,0 +1,141 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "test_window_manager_tools.h"
+#include "../miral/latency_histogram.h"
+#include "../miral/window_management_latency.h"
+#include "../miral/window_management_trace.h"
+
+#include <miral/geometry_batch_policy.h>
+
+using namespace miral;
+using namespace testing;
+
+namespace
+{
+Rectangle const display_area{{0, 0}, {640, 480}};
+
+// Like the titlebar policy, this follows window geometry through advise_geometry_batch()
+struct MockBatchingPolicy : MockWindowManagerPolicy, GeometryBatchPolicy
+{
+    using MockWindowManagerPolicy::MockWindowManagerPolicy;
+
+    MOCK_METHOD1(advise_geometry_batch, void(std::vector<GeometryChange> const& changes));
+};
+
+using Wrap = std::function<std::unique_ptr<WindowManagementPolicy>(
+    WindowManagerTools const& tools, WindowManagementPolicyBuilder const& builder)>;
+
+struct Wrapper
+{
+    char const* name;
+    Wrap wrap;
+};
+
+auto operator<<(std::ostream& out, Wrapper const& wrapper) -> std::ostream&
+{
+    return out << wrapper.name;
+}
+
+Wrapper const trace{"trace", [](WindowManagerTools const& tools, WindowManagementPolicyBuilder const& builder)
+    { return std::make_unique<WindowManagementTrace>(tools, builder); }};
+
+Wrapper const latency{"latency", [](WindowManagerTools const& tools, WindowManagementPolicyBuilder const& builder)
+    { return std::make_unique<WindowManagementLatency>(tools, builder, std::make_shared<LatencyHistograms>()); }};
+
+MATCHER_P(ResizesTo, size, "")
+{
+    return arg.size.is_set() && arg.size.value() == size;
+}
+
+template<typename Policy>
+struct WrappedPolicy : TestWithParam<Wrapper>
+{
+    StubFocusController focus_controller;
+    StubDisplayLayout display_layout;
+    StubPersistentSurfaceStore persistent_surface_store;
+    std::shared_ptr<StubStubSession> session{std::make_shared<StubStubSession>()};
+
+    Policy* policy{nullptr};
+    WindowManagerTools tools{nullptr};
+    Window window;
+
+    BasicWindowManager basic_window_manager{
+        &focus_controller,
+        mir::test::fake_shared(display_layout),
+        mir::test::fake_shared(persistent_surface_store),
+        [this](WindowManagerTools const& tools) -> std::unique_ptr<WindowManagementPolicy>
+            {
+                this->tools = tools;
+                return GetParam().wrap(tools, [this](WindowManagerTools const& tools)
+                    {
+                        auto policy = std::make_unique<NiceMock<Policy>>(tools);
+                        this->policy = policy.get();
+                        return std::move(policy);
+                    });
+            }
+    };
+
+    void SetUp() override
+    {
+        basic_window_manager.add_display(display_area);
+        basic_window_manager.add_session(session);
+
+        EXPECT_CALL(*policy, advise_new_window(_))
+            .WillOnce(Invoke([this](WindowInfo const& window_info){ window = window_info.window(); }));
+
+        mir::scene::SurfaceCreationParameters creation_parameters;
+        creation_parameters.size = Size{400, 300};
+        basic_window_manager.add_surface(session, creation_parameters, &TestWindowManagerTools::create_surface);
+
+        Mock::VerifyAndClearExpectations(policy);
+    }
+
+    void resize(Size size)
+    {
+        WindowSpecification modifications;
+        modifications.size() = size;
+        tools.modify_window(window, modifications);
+    }
+};
+
+using WrappedBatchingPolicy = WrappedPolicy<MockBatchingPolicy>;
+using WrappedPlainPolicy = WrappedPolicy<MockWindowManagerPolicy>;
+}
+
+TEST_P(WrappedBatchingPolicy, a_resize_is_advised_as_a_geometry_batch)
+{
+    Size const new_size{200, 150};
+
+    EXPECT_CALL(*policy, advise_geometry_batch(ElementsAre(ResizesTo(new_size))));
+    EXPECT_CALL(*policy, advise_resize(_, _)).Times(0);
+
+    tools.invoke_under_lock([&] { resize(new_size); });
+}
+
+TEST_P(WrappedPlainPolicy, a_resize_is_advised_through_advise_resize)
+{
+    Size const new_size{200, 150};
+
+    EXPECT_CALL(*policy, advise_resize(Property(&WindowInfo::window, Eq(window)), new_size));
+
+    tools.invoke_under_lock([&] { resize(new_size); });
+}
+
+INSTANTIATE_TEST_CASE_P(GeometryBatch, WrappedBatchingPolicy, Values(trace, latency));
+INSTANTIATE_TEST_CASE_P(GeometryBatch, WrappedPlainPolicy, Values(trace, latency));